@@ -67,5 +67,8 @@ void loop()
     Serial.printf("  CalibrationDone = %d\n", CalibrationDone);
   }
 
+  // print the recorded errors of the bus to the debug UART
+  LinBus.drainLog();
+
   delay(5000);
 }
\ No newline at end of file
@@ -36,11 +36,14 @@ void setup()
   LinBus.baud = 19200;
 
   LIN_ScanIDs();
+  // print the recorded errors of the scan to the debug UART
+  LinBus.drainLog();
 
   Serial.print("May you want to try other Baud rates?\n");
 }
 
 void loop()
 {
+  LinBus.drainLog();
   delay(5000);
 }
\ No newline at end of file
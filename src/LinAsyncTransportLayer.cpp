@@ -0,0 +1,291 @@
+// LinAsyncTransportLayer.cpp
+//
+// Optional coroutine API (C++20) of frame transfer and Diagnostic Transport Layer (DTL)
+//
+// LIN Specification 2.2A
+// Source https://www.lin-cia.org/fileadmin/microsites/lin-cia.org/resources/documents/LIN_2.2A.pdf
+
+#include "LinAsyncTransportLayer.hpp"
+
+#if defined(__cpp_impl_coroutine)
+
+#ifdef UNIT_TEST
+    #include "../test/mock_millis.h"
+#else
+    #include <Arduino.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "LinPDU.hpp"
+
+constexpr auto timeout_AsyncFrame = 50; // ms - same as blocking readFrame
+
+// ------------------------------------
+
+/// @brief Request a frame of a node (header only, the node responds)
+/// @param frameID FrameID (will be converted to ProtectedID)
+/// @param expectedDataLength Length of data bytes [0..8] (default=8), only success if matched
+/// @return awaitable, resumed with the received data or std::nullopt
+LinAsyncTransportLayer::FrameAwaiter LinAsyncTransportLayer::readFrame(const uint8_t frameID, const uint8_t expectedDataLength)
+{
+    Operation operation {};
+    operation.protectedID = getProtectedID(frameID);
+    operation.isWrite = false;
+    operation.dataLength = expectedDataLength;
+    return FrameAwaiter(*this, std::move(operation));
+}
+
+/// @brief Write a frame, verified by its readback
+/// @param frameID FrameID (will be converted to ProtectedID)
+/// @param data data of frame
+/// @return awaitable, resumed with an empty vector on success or std::nullopt
+LinAsyncTransportLayer::FrameAwaiter LinAsyncTransportLayer::writeFrame(const uint8_t frameID, const std::vector<uint8_t>& data)
+{
+    Operation operation {};
+    operation.protectedID = getProtectedID(frameID);
+    operation.isWrite = true;
+    operation.dataLength = static_cast<uint8_t>(data.size());
+    operation.data = data;
+    return FrameAwaiter(*this, std::move(operation));
+}
+
+/// @brief Write a PDU and read the response, exclusive on the bus
+/// @param NAD Node Address, on wildcard the response of any node is accepted
+/// @param payload request (SID + data)
+/// @return response payload, std::nullopt on timeout or protocol error
+LinTask<std::optional<std::vector<uint8_t>>> LinAsyncTransportLayer::request(const uint8_t NAD, std::vector<uint8_t> payload)
+{
+    co_await lockTransaction();
+    auto response = co_await transact(NAD, payload);
+    unlockTransaction();
+    co_return response;
+}
+
+/// @brief Advance the frame engine, never blocks
+/// @details resumes the flow of a completed frame (within this call)
+/// @return frames are pending
+bool LinAsyncTransportLayer::poll()
+{
+    if (!active && queueHead)
+    {
+        active = queueHead;
+        queueHead = queueHead->next;
+        if (!queueHead) {
+            queueTail = nullptr;
+        }
+        beginFrame(*active);
+    }
+
+    int available = 0;
+    while (active && ((available = driver.available()) > 0))
+    {
+        // bytes of the active frame only (bulk)
+        const size_t received = active->isWrite ? echoMatched : rxData.size();
+        const size_t missing = (3 - headMatched) + (active->dataLength ? active->dataLength - received + 1 : 0);
+        std::array<uint8_t, 3 + FRAME_DATA_LENGTH_MAX + 1> rxBytes;
+        const size_t count = driver.readBytes(rxBytes.data(), std::min({static_cast<size_t>(available), missing, rxBytes.size()}));
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (receiveByte(*active, rxBytes[i])) {
+                // frame is complete or failed, flow was resumed
+                return !isIdle();
+            }
+        }
+    }
+
+    if (active && (millis() >= timeout_stop)) {
+        // rx of valid frame failed!
+        finishFrame(false);
+    }
+
+    return !isIdle();
+}
+
+bool LinAsyncTransportLayer::isIdle() const
+{
+    return !active && !queueHead;
+}
+
+void LinAsyncTransportLayer::enqueue(Operation &operation)
+{
+    operation.next = nullptr;
+    if (queueTail) {
+        queueTail->next = &operation;
+    } else {
+        queueHead = &operation;
+    }
+    queueTail = &operation;
+}
+
+void LinAsyncTransportLayer::enqueue(Waiter &waiter)
+{
+    waiter.next = nullptr;
+    if (waiterTail) {
+        waiterTail->next = &waiter;
+    } else {
+        waiterHead = &waiter;
+    }
+    waiterTail = &waiter;
+}
+
+void LinAsyncTransportLayer::beginFrame(Operation &operation)
+{
+    headMatched = 0;
+    echoMatched = 0;
+    rxData.clear();
+
+    // TX Frame Head (+ Data + Checksum)
+    if (operation.isWrite) {
+        writeFrameBytes(operation.protectedID, operation.data);
+    } else {
+        writeFrameHead(operation.protectedID);
+    }
+
+    // ensure request is avaliable for receiver
+    driver.flush();
+
+    timeout_stop = millis() + timeout_AsyncFrame;
+}
+
+/// @brief Process a byte of the active frame (readback of the head, response or readback of the data)
+/// @return frame is finished (success or failure)
+bool LinAsyncTransportLayer::receiveByte(Operation &operation, const uint8_t byte)
+{
+    if (headMatched < 3)
+    {
+        const uint8_t head[3] = {BREAK_FIELD, SYNC_FIELD, operation.protectedID};
+        if (byte == head[headMatched]) {
+            headMatched++;
+        } else {
+            // discard all data until break, sync, PID
+            headMatched = (BREAK_FIELD == byte) ? 1 : 0;
+        }
+        if ((3 == headMatched) && (0 == operation.dataLength)) {
+            finishFrame(true);
+            return true;
+        }
+        if ((3 == headMatched) && !operation.isWrite) {
+            // header is complete: an empty response slot is recognized within TResponse_Maximum
+            timeout_stop = millis() + std::max<unsigned long>(1, getResponseTimeMax(operation.dataLength));
+        }
+        return false;
+    }
+
+    if (operation.isWrite) {
+        // readback: compared with the TX bytes as received, the first mismatch fails the frame
+        const bool isChecksum = (echoMatched == operation.dataLength);
+        const uint8_t expected = isChecksum ? getChecksumLin2x(operation.protectedID, operation.data) : operation.data[echoMatched];
+        if (byte != expected) {
+            finishFrame(false);
+            return true;
+        }
+        echoMatched++;
+        if (isChecksum) {
+            finishFrame(true);
+            return true;
+        }
+        return false;
+    }
+
+    if (rxData.size() < operation.dataLength) {
+        rxData.push_back(byte);
+        return false;
+    }
+
+    // checksum
+    bool success = (byte == getChecksumLin2x(operation.protectedID, rxData));
+    if (!success) {
+        // response was not empty, but invalid
+        frameErrors++;
+    }
+    finishFrame(success);
+    return true;
+}
+
+void LinAsyncTransportLayer::finishFrame(const bool success)
+{
+    Operation &operation = *active;
+    active = nullptr;
+
+    if (!success) {
+        operation.result = std::nullopt;
+    } else if (operation.isWrite) {
+        operation.result.emplace();
+    } else {
+        operation.result = std::move(rxData);
+        rxData = {};
+    }
+
+    // operation is part of the resumed flow, it must not be accessed afterwards
+    operation.waiter.resume();
+}
+
+LinAsyncTransportLayer::TransactionAwaiter LinAsyncTransportLayer::lockTransaction()
+{
+    return TransactionAwaiter(*this);
+}
+
+bool LinAsyncTransportLayer::tryLockTransaction()
+{
+    if (transactionLocked) {
+        return false;
+    }
+    transactionLocked = true;
+    return true;
+}
+
+void LinAsyncTransportLayer::unlockTransaction()
+{
+    if (!waiterHead) {
+        transactionLocked = false;
+        return;
+    }
+
+    // hand over to the next waiting request, still locked
+    Waiter* waiter = waiterHead;
+    waiterHead = waiterHead->next;
+    if (!waiterHead) {
+        waiterTail = nullptr;
+    }
+    waiter->handle.resume();
+}
+
+/// @brief MasterRequest and SlaveResponse of a request, the transaction is locked by the caller
+/// @details payload is owned by the frame of request()
+LinTask<std::optional<std::vector<uint8_t>>> LinAsyncTransportLayer::transact(const uint8_t NAD, const std::vector<uint8_t> &payload)
+{
+    // write full frameset
+    for (const PDU& frame : framesetFromPayload(NAD, payload))
+    {
+        if (!co_await writeFrame(FRAME_ID::MASTER_REQUEST, frame.asVector())) {
+            co_return std::nullopt;
+        }
+    }
+
+    // read response, same rules as the blocking readPduResponse()
+    PduReassembly reassembly(timingProfile, NAD);
+
+    while (millis() < reassembly.getTimeout())
+    {
+        auto rxFrame = co_await readFrame(FRAME_ID::SLAVE_REQUEST, 8);
+        if (!rxFrame || (rxFrame.value().size() != 8)) {
+            continue;
+        }
+
+        PDU& frame = *reinterpret_cast<PDU*>(rxFrame.value().data());
+        const auto step = reassembly.process(frame);
+        if ((PduReassembly::Step::Complete == step) || (PduReassembly::Step::Abort == step)) {
+            break;
+        }
+    }
+
+    uint8_t respondingNAD = NAD;
+    co_return reassembly.finish(respondingNAD);
+}
+
+#endif // __cpp_impl_coroutine
@@ -0,0 +1,133 @@
+// LinAsyncTransportLayer.hpp
+//
+// Optional coroutine API (C++20) of frame transfer and Diagnostic Transport Layer (DTL)
+// - co_await readFrame(id) / writeFrame(id, data) suspends the calling flow until its frame is completed
+// - co_await request(NAD, payload) writes a PDU and collects the response of the node
+// - poll() drives a non-blocking frame engine: one frame on the bus at a time, frames are served in order of request
+// - many flows (e.g. diagnostic sessions, signal frames) share one bus without threads
+// - MasterRequest and SlaveResponse of a request are never interleaved with another request,
+//   frames of other flows may be placed in between
+//
+// Available with compiler support of coroutines only (e.g. -std=gnu++20)
+//
+// LIN Specification 2.2A
+// Source https://www.lin-cia.org/fileadmin/microsites/lin-cia.org/resources/documents/LIN_2.2A.pdf
+
+#pragma once
+
+#include "LinTransportLayer.hpp"
+
+#if defined(__cpp_impl_coroutine)
+
+#include <coroutine>
+#include <optional>
+#include <vector>
+
+#include "LinTask.hpp"
+
+class LinAsyncTransportLayer : protected LinTransportLayer {
+public:
+    using LinTransportLayer::LinTransportLayer;
+    using LinTransportLayer::timingProfile;
+    using LinTransportLayer::frameStats;
+    using LinTransportLayer::logger;
+    using LinTransportLayer::trace;
+    using LinTransportLayer::drainLog;
+    using LinTransportLayer::frameErrors;
+
+protected:
+    struct Operation {
+        uint8_t protectedID;
+        bool isWrite;
+        uint8_t dataLength;
+        std::vector<uint8_t> data;                      // TX data (write), expected readback
+        std::optional<std::vector<uint8_t>> result;
+        std::coroutine_handle<> waiter;
+        Operation* next = nullptr;                      // queue of the bus
+    };
+
+    struct Waiter {
+        std::coroutine_handle<> handle;
+        Waiter* next = nullptr;
+    };
+
+public:
+    class FrameAwaiter {
+    public:
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> caller)
+        {
+            operation.waiter = caller;
+            bus.enqueue(operation);
+        }
+        // received data (readFrame), empty vector for a verified writeFrame, std::nullopt on failure
+        std::optional<std::vector<uint8_t>> await_resume() { return std::move(operation.result); }
+
+    private:
+        friend class LinAsyncTransportLayer;
+        FrameAwaiter(LinAsyncTransportLayer &bus, Operation &&operation) :
+            bus(bus),
+            operation(std::move(operation))
+        {}
+
+        LinAsyncTransportLayer &bus;
+        Operation operation;
+    };
+
+    class TransactionAwaiter {
+    public:
+        bool await_ready() noexcept { return bus.tryLockTransaction(); }
+        void await_suspend(std::coroutine_handle<> caller)
+        {
+            waiter.handle = caller;
+            bus.enqueue(waiter);
+        }
+        void await_resume() noexcept {}
+
+    private:
+        friend class LinAsyncTransportLayer;
+        explicit TransactionAwaiter(LinAsyncTransportLayer &bus) :
+            bus(bus)
+        {}
+
+        LinAsyncTransportLayer &bus;
+        Waiter waiter;
+    };
+
+    FrameAwaiter readFrame(const uint8_t frameID, const uint8_t expectedDataLength = 8);
+    FrameAwaiter writeFrame(const uint8_t frameID, const std::vector<uint8_t>& data);
+
+    LinTask<std::optional<std::vector<uint8_t>>> request(const uint8_t NAD, std::vector<uint8_t> payload);
+
+    bool poll();
+    bool isIdle() const;
+
+protected:
+    // frame engine
+    Operation* active = nullptr;
+    Operation* queueHead = nullptr;
+    Operation* queueTail = nullptr;
+    uint8_t headMatched = 0;                // bytes of break, sync and PID received
+    uint8_t echoMatched = 0;                // data and checksum bytes of the readback matched (write)
+    std::vector<uint8_t> rxData;
+    unsigned long timeout_stop = 0;
+
+    // exclusive DTL transaction (MasterRequest ... SlaveResponse)
+    bool transactionLocked = false;
+    Waiter* waiterHead = nullptr;
+    Waiter* waiterTail = nullptr;
+
+    void enqueue(Operation &operation);
+    void enqueue(Waiter &waiter);
+    void beginFrame(Operation &operation);
+    bool receiveByte(Operation &operation, const uint8_t byte);
+    void finishFrame(const bool success);
+
+    TransactionAwaiter lockTransaction();
+    bool tryLockTransaction();
+    void unlockTransaction();
+
+    LinTask<std::optional<std::vector<uint8_t>>> transact(const uint8_t NAD, const std::vector<uint8_t> &payload);
+};
+
+#endif // __cpp_impl_coroutine
@@ -0,0 +1,330 @@
+// LinAutoAddressing.cpp
+//
+// Automatic assignment of unique NADs to identical nodes (e.g. all delivered with the same NAD)
+// - serial number search: the group sharing a NAD is split by CONDITIONAL_CHANGE on single bits of
+//   the serial number, several nodes answering at once are recognized by the corrupted response
+// - node position detection (SNPD): the physical selection of the next node (bus shunt, daisy chain)
+//   is provided by a LinSnpdMethod, the NAD is assigned by the reserved SID 0xB5
+//
+// LIN Specification 2.2A
+// Source https://www.lin-cia.org/fileadmin/microsites/lin-cia.org/resources/documents/LIN_2.2A.pdf
+
+#include "LinAutoAddressing.hpp"
+
+#ifdef UNIT_TEST
+    #include "../test/mock_Arduino.h"
+#else
+    #include <Arduino.h>
+#endif
+
+#include <optional>
+#include <vector>
+
+#include "LinPDU.hpp"
+
+/// @brief Give every node which answers at the shared NAD a unique NAD of the range
+/// @details the group at a NAD is asked for its serial number: a valid response is a single node,
+/// a corrupted response (wired-AND of several nodes) is a group, which is split by CONDITIONAL_CHANGE
+/// on the next bit of the serial number (nodes with the bit cleared move to a free NAD of the range).
+/// A split without any response does not cost a count. The nodes end on the NAD they were moved to,
+/// only the last node of the shared NAD needs an ASSIGN_NAD.
+/// Requires nodes supporting READ_BY_ID serial number and CONDITIONAL_CHANGE, the range must not be
+/// used by any other node of the cluster. Not recognized as a group: identical serial numbers, and a
+/// response which covers the others completely (all its recessive bits are recessive for the others too).
+/// @param sharedNAD NAD of the identical nodes (e.g. factory default)
+/// @param first first NAD to be assigned
+/// @param last last NAD to be assigned (included)
+/// @return assigned NADs and count of transactions
+LinAutoAddressing::Report LinAutoAddressing::assignBySerialNumber(const uint8_t sharedNAD, const uint8_t first, const uint8_t last)
+{
+    Search search {};
+    search.sharedNAD = sharedNAD;
+    search.first = first;
+    search.last = last;
+    search.occupied.set(sharedNAD);
+
+    // an empty NAD is given up after the response window
+    const auto timeout_NoResponse_restore = timeout_NoResponse;
+    const auto timeout_default_restore = timingProfile.timeout_default;
+    const auto pollInterval_default_restore = timingProfile.pollInterval_default;
+    timeout_NoResponse = getResponseTimeMax(sizeof(PDU));
+    timingProfile.timeout_default = responseWindow;
+    timingProfile.pollInterval_default = getWindowPollInterval();
+
+    search.report.complete = assign(search, sharedNAD, 0);
+
+    timeout_NoResponse = timeout_NoResponse_restore;
+    timingProfile.timeout_default = timeout_default_restore;
+    timingProfile.pollInterval_default = pollInterval_default_restore;
+
+    return search.report;
+}
+
+/// @brief Assign NADs in the order of the node positions
+/// @details INITIALIZE --> n * (select node, ASSIGN_NAD, verify by READ_BY_ID) --> STORE_NAD --> FINISH
+/// the requests of SID 0xB5 are broadcast and not answered, every assignment is verified by reading
+/// the product identification of the new NAD. The sequence ends, when no node takes the next NAD.
+/// @param method hardware selection of the next unaddressed node
+/// @param first NAD of the first node
+/// @param count maximum count of nodes
+/// @return assigned NADs and count of transactions
+LinAutoAddressing::Report LinAutoAddressing::assignBySnpd(LinSnpdMethod &method, const uint8_t first, const uint8_t count)
+{
+    Report report {};
+
+    const auto timeout_NoResponse_restore = timeout_NoResponse;
+    const auto timeout_default_restore = timingProfile.timeout_default;
+    const auto pollInterval_default_restore = timingProfile.pollInterval_default;
+    timeout_NoResponse = getResponseTimeMax(sizeof(PDU));
+    timingProfile.timeout_default = responseWindow;
+    timingProfile.pollInterval_default = getWindowPollInterval();
+
+    requestSnpd(SnpdSubfunction::INITIALIZE);
+    report.transactions++;
+
+    for (uint16_t NAD = first; (NAD <= NAD_last) && (report.assignments.size() < count); ++NAD)
+    {
+        method.beginAssignment(static_cast<uint8_t>(NAD));
+        requestSnpd(SnpdSubfunction::ASSIGN_NAD, static_cast<uint8_t>(NAD));
+        method.endAssignment(static_cast<uint8_t>(NAD));
+        report.transactions++;
+
+        // identity of the NAD has changed
+        invalidateCache(static_cast<uint8_t>(NAD));
+        timingProfile.reset(static_cast<uint8_t>(NAD));
+
+        uint8_t nad = static_cast<uint8_t>(NAD);
+        uint16_t supplierId = 0x7FFF; // wildcard
+        uint16_t functionId = 0x3FFF; // wildcard
+        uint8_t variantId = 0;
+        report.transactions++;
+        if (!readProductId(nad, supplierId, functionId, variantId)) {
+            // no unaddressed node left
+            report.complete = true;
+            break;
+        }
+        report.assignments.push_back({static_cast<uint8_t>(NAD), {}});
+    }
+    if (report.assignments.size() >= count) {
+        report.complete = true;
+    }
+
+    requestSnpd(SnpdSubfunction::STORE_NAD);
+    requestSnpd(SnpdSubfunction::FINISH);
+    report.transactions += 2;
+
+    timeout_NoResponse = timeout_NoResponse_restore;
+    timingProfile.timeout_default = timeout_default_restore;
+    timingProfile.pollInterval_default = pollInterval_default_restore;
+
+    return report;
+}
+
+/// @brief Give every node answering at a NAD its own NAD
+/// @param search state of the search
+/// @param NAD NAD of the group
+/// @param bit first bit of the serial number to split by
+/// @return success, false on missing resources (NADs, distinct serial numbers) or unsupported services
+bool LinAutoAddressing::assign(Search &search, const uint8_t NAD, const uint8_t bit)
+{
+    std::optional<uint32_t> serialNumber;
+    switch (countNodes(search, NAD, serialNumber))
+    {
+    case Population::NONE:
+        if (NAD != search.sharedNAD) {
+            search.occupied.reset(NAD);
+        }
+        return true;
+    case Population::ONE:
+        return settle(search, NAD, serialNumber);
+    case Population::MANY:
+        return resolve(search, NAD, bit);
+    default:
+        return false;
+    }
+}
+
+/// @brief Split a group of nodes until every node has its own NAD
+/// @details the response to CONDITIONAL_CHANGE is identical for all moved nodes (no collision is
+/// visible), so both parts of the group are counted by reading the serial number afterwards.
+/// The remaining part is counted first: if the whole group has moved, it is known to be a group.
+/// @param search state of the search
+/// @param NAD NAD of the group (several nodes are known to answer)
+/// @param bit first bit of the serial number to split by
+/// @return success, false on missing resources (NADs, distinct serial numbers) or unsupported services
+bool LinAutoAddressing::resolve(Search &search, uint8_t NAD, uint8_t bit)
+{
+    while (bit < serialNumberBits)
+    {
+        const std::optional<uint8_t> newNAD = allocate(search);
+        if (!newNAD) {
+            return false;
+        }
+
+        const Population moved = split(search, NAD, bit++, newNAD.value());
+        if (Population::UNSUPPORTED == moved) {
+            return false;
+        }
+        if (Population::NONE == moved) {
+            // bit is set for all nodes of the group: next bit without counting the group again
+            continue;
+        }
+        search.occupied.set(newNAD.value());
+
+        // nodes with the bit set have stayed
+        std::optional<uint32_t> serialNumber;
+        switch (countNodes(search, NAD, serialNumber))
+        {
+        case Population::NONE:
+            // bit is cleared for all nodes of the group: the whole group has moved
+            if (NAD != search.sharedNAD) {
+                search.occupied.reset(NAD);
+            }
+            NAD = newNAD.value();
+            continue;
+        case Population::ONE:
+            return settle(search, NAD, serialNumber) && assign(search, newNAD.value(), bit);
+        case Population::MANY:
+            return assign(search, newNAD.value(), bit) && resolve(search, NAD, bit);
+        default:
+            return false;
+        }
+    }
+
+    // nodes with identical serial numbers
+    return false;
+}
+
+/// @brief A single node is left at a NAD: keep it, or move it away from the shared NAD
+/// @param search state of the search
+/// @param NAD current NAD of the node
+/// @param serialNumber serial number of the node
+/// @return success
+bool LinAutoAddressing::settle(Search &search, const uint8_t NAD, const std::optional<uint32_t> &serialNumber)
+{
+    if (NAD != search.sharedNAD) {
+        search.report.assignments.push_back({NAD, serialNumber});
+        return true;
+    }
+
+    const std::optional<uint8_t> newNAD = allocate(search);
+    if (!newNAD) {
+        return false;
+    }
+
+    uint8_t nad = NAD;
+    search.report.transactions++;
+    if (!assignNAD(nad, 0x7FFF, 0x3FFF, newNAD.value())) {
+        return false;
+    }
+    timingProfile.reset(NAD);
+    search.occupied.set(newNAD.value());
+    search.report.assignments.push_back({newNAD.value(), serialNumber});
+    return true;
+}
+
+/// @brief Count the nodes answering at a NAD by reading the serial number
+/// @param search state of the search
+/// @param NAD Node Address
+/// @param serialNumber set, if a single node has answered
+/// @return count of nodes
+LinAutoAddressing::Population LinAutoAddressing::countNodes(Search &search, const uint8_t NAD, std::optional<uint32_t> &serialNumber)
+{
+    const uint32_t frameErrorsBefore = frameErrors;
+    uint8_t nad = NAD;
+    uint32_t value = 0;
+    search.report.transactions++;
+    const Result result = readSerialNumber(nad, 0x7FFF, 0x3FFF, value);
+
+    const Population population = classify(result, frameErrorsBefore);
+    if (Population::ONE == population) {
+        serialNumber = value;
+    }
+    if (Population::MANY == population) {
+        // a corrupted response must not be answered from cache
+        invalidateCache(NAD);
+    }
+    return population;
+}
+
+/// @brief Move the nodes of a group with a cleared bit of the serial number to a new NAD
+/// @details CONDITIONAL_CHANGE: Id = 1 (serial number), Byte = bit / 8 + 1, Mask = 1 << bit % 8, Invert = 0
+/// the moved nodes answer with the new NAD
+/// @param search state of the search
+/// @param NAD NAD of the group
+/// @param bit bit of the serial number (0 = LSB)
+/// @param newNAD destination of the moved nodes
+/// @return NONE, if no node has moved
+LinAutoAddressing::Population LinAutoAddressing::split(Search &search, const uint8_t NAD, const uint8_t bit, const uint8_t newNAD)
+{
+    const uint32_t frameErrorsBefore = frameErrors;
+    uint8_t nad = NAD;
+    const uint8_t byte = bit / 8 + 1;
+    const uint8_t mask = 1 << (bit % 8);
+    search.report.transactions++;
+    const Result result = conditionalChangeNAD(nad, static_cast<uint8_t>(CMD_Identifier::SERIAL_NUMBER), byte, 0x00, mask, newNAD);
+
+    const Population population = classify(result, frameErrorsBefore);
+    if (Population::NONE != population) {
+        // identity of both NADs has changed (a collision is not seen by conditionalChangeNAD)
+        invalidateCache(NAD);
+        invalidateCache(newNAD);
+        timingProfile.reset(newNAD);
+    }
+    return population;
+}
+
+/// @brief Interpret the result of a request sent to a group of nodes
+/// @param result of the service
+/// @param frameErrorsBefore frameErrors before the request was sent
+/// @return count of answering nodes
+LinAutoAddressing::Population LinAutoAddressing::classify(const Result &result, const uint32_t frameErrorsBefore) const
+{
+    switch (result.status)
+    {
+    case Status::OK:
+        return Population::ONE;
+    case Status::NEGATIVE_RESPONSE:
+        return Population::UNSUPPORTED;
+    case Status::INVALID_RESPONSE:
+        // responses of several nodes may overlay to a valid frame with nonsense content
+        return Population::MANY;
+    default:
+        return (frameErrors != frameErrorsBefore) ? Population::MANY : Population::NONE;
+    }
+}
+
+/// @brief Lowest free NAD of the range
+/// @param search state of the search
+/// @return NAD, or nothing if the range is exhausted
+std::optional<uint8_t> LinAutoAddressing::allocate(const Search &search) const
+{
+    for (uint16_t NAD = search.first; NAD <= search.last; ++NAD)
+    {
+        if (!search.occupied.test(NAD)) {
+            return static_cast<uint8_t>(NAD);
+        }
+    }
+    return {};
+}
+
+/// @brief Broadcast a request of the node position detection (not answered by the nodes)
+/// @details NAD = 0x7F, PCI = 0x06, SID = 0xB5, Supplier ID = 0x7FFF (wildcard), subfunction, NAD, 0xFF
+/// @param subfunction step of the detection
+/// @param NAD new NAD (ASSIGN_NAD only)
+void LinAutoAddressing::requestSnpd(const SnpdSubfunction subfunction, const uint8_t NAD)
+{
+    const std::vector<uint8_t> payload = {
+        static_cast<uint8_t>(ServiceIdentifier::RESERVED),
+        0xFF,   // supplier id LSB (wildcard)
+        0x7F,   // supplier id MSB (wildcard)
+        static_cast<uint8_t>(subfunction),
+        NAD,
+        0xFF
+    };
+
+    for (const PDU& frame : framesetFromPayload(PDU::NAD_Type::BROADCAST, payload))
+    {
+        writeFrame(FRAME_ID::MASTER_REQUEST, frame.asVector());
+    }
+}
@@ -0,0 +1,104 @@
+// LinAutoAddressing.hpp
+//
+// Automatic assignment of unique NADs to identical nodes (e.g. all delivered with the same NAD)
+// - serial number search: the group sharing a NAD is split by CONDITIONAL_CHANGE on single bits of
+//   the serial number, several nodes answering at once are recognized by the corrupted response
+// - node position detection (SNPD): the physical selection of the next node (bus shunt, daisy chain)
+//   is provided by a LinSnpdMethod, the NAD is assigned by the reserved SID 0xB5
+//
+// LIN Specification 2.2A
+// Source https://www.lin-cia.org/fileadmin/microsites/lin-cia.org/resources/documents/LIN_2.2A.pdf
+
+#pragma once
+
+#ifdef UNIT_TEST
+    #include "../test/mock_HardwareSerial.h"
+    using HardwareSerial = mock_HardwareSerial;
+#else
+    #include <Arduino.h>
+#endif
+
+#include <bitset>
+#include <optional>
+#include <vector>
+
+#include "LinNodeDiscovery.hpp"
+
+// hardware part of the node position detection, the selection mechanism is not specified by LIN 2.2A
+class LinSnpdMethod {
+public:
+    virtual ~LinSnpdMethod() = default;
+
+    /// @brief select the next unaddressed node (e.g. enable the shunt current), before the NAD is sent
+    /// @param newNAD NAD the selected node will receive
+    virtual void beginAssignment(const uint8_t newNAD) = 0;
+
+    /// @brief NAD was sent, release the selection
+    /// @param newNAD NAD the selected node has received
+    virtual void endAssignment(const uint8_t newNAD) = 0;
+};
+
+class LinAutoAddressing : protected LinNodeDiscovery {
+public:
+    using LinNodeDiscovery::LinNodeDiscovery;
+    using LinNodeDiscovery::timingProfile;
+    using LinNodeDiscovery::frameStats;
+    using LinNodeDiscovery::logger;
+    using LinNodeDiscovery::trace;
+    using LinNodeDiscovery::drainLog;
+    using LinNodeDiscovery::NAD_first;
+    using LinNodeDiscovery::NAD_last;
+
+    struct Assignment {
+        uint8_t NAD;
+        std::optional<uint32_t> serialNumber; // known, if it was read during the assignment
+    };
+
+    struct Report {
+        std::vector<Assignment> assignments; // in order of assignment
+        size_t transactions = 0;             // count of requests sent
+        bool complete = false;               // every node got a unique NAD
+    };
+
+    // bits of the serial number (READ_BY_ID Id = 1, 4 bytes LSB first)
+    static constexpr uint8_t serialNumberBits = 32;
+
+    Report assignBySerialNumber(const uint8_t sharedNAD, const uint8_t first = NAD_first, const uint8_t last = NAD_last);
+    Report assignBySnpd(LinSnpdMethod &method, const uint8_t first = NAD_first, const uint8_t count = NAD_last);
+
+protected:
+    // subfunctions of SID 0xB5 (LIN 2.2A: reserved for node position detection)
+    enum class SnpdSubfunction : uint8_t {
+        INITIALIZE = 0x01,  // nodes enter the detection, addressed state is cleared
+        ASSIGN_NAD = 0x02,  // the selected node takes the NAD
+        STORE_NAD = 0x03,   // addressed nodes persist their NAD
+        FINISH = 0x04       // nodes leave the detection
+    };
+
+    // count of nodes answering at a NAD
+    enum class Population : uint8_t {
+        NONE,
+        ONE,
+        MANY,
+        UNSUPPORTED     // negative response: serial number or conditional change is not available
+    };
+
+    // state of a running serial number search
+    struct Search {
+        Report report;
+        std::bitset<256> occupied;  // NADs which must not be assigned
+        uint8_t sharedNAD;
+        uint8_t first;
+        uint8_t last;
+    };
+
+    bool assign(Search &search, const uint8_t NAD, const uint8_t bit);
+    bool resolve(Search &search, uint8_t NAD, uint8_t bit);
+    bool settle(Search &search, const uint8_t NAD, const std::optional<uint32_t> &serialNumber);
+    Population countNodes(Search &search, const uint8_t NAD, std::optional<uint32_t> &serialNumber);
+    Population split(Search &search, const uint8_t NAD, const uint8_t bit, const uint8_t newNAD);
+    Population classify(const Result &result, const uint32_t frameErrorsBefore) const;
+    std::optional<uint8_t> allocate(const Search &search) const;
+
+    void requestSnpd(const SnpdSubfunction subfunction, const uint8_t NAD = 0xFF);
+};
@@ -0,0 +1,191 @@
+// LinBreakStrategy.hpp
+//
+// Generation of the break field of a frame header
+// - half baud rate: 0x00 is written at half the baud rate (any UART, reconfigures the UART twice per frame)
+// - native: the UART driver generates the break (e.g. ESP-IDF uart_write_bytes_with_break), provided by a function
+// - GPIO: the TX line is driven by a pin (TX detached from the UART) and timed by delayMicroseconds
+// - every strategy records the time the caller is blocked (cost) and the length of the break
+// - LinFrameTransfer::selectBreakStrategy() selects the cheapest strategy, which meets the spec
+//
+// All strategies are expected to leave a 0x00 in the RX buffer (readback of the break),
+// as a UART receives a break as 0x00 with framing error.
+//
+// LIN Specification 2.2A
+// Source https://www.lin-cia.org/fileadmin/microsites/lin-cia.org/resources/documents/LIN_2.2A.pdf
+
+#pragma once
+
+#ifdef UNIT_TEST
+    #include "../test/mock_HardwareSerial.h"
+    using HardwareSerial = mock_HardwareSerial;
+    #include "../test/mock_micros.h"
+#else
+    #include <Arduino.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+
+class LinBreakStrategy {
+public:
+    // LIN 2.2A Spec 2.3.1.1 Break field: at least 13 nominal bit times dominant, followed by a delimiter of at least 1 bit time
+    static constexpr uint32_t breakBits_min = 13;
+    static constexpr uint32_t delimiterBits_min = 1;
+
+    struct Cost {
+        uint32_t count = 0;       // breaks sent
+        uint32_t last_us = 0;     // caller blocked by the last break
+        uint32_t max_us = 0;
+        uint64_t total_us = 0;
+        uint32_t break_us = 0;    // dominant part of the last break (measured, or nominal if not measurable)
+    };
+
+    virtual ~LinBreakStrategy() = default;
+
+    virtual const char* getName() const = 0;
+
+    /// @brief the strategy can be used with this driver (e.g. a hook is provided)
+    virtual bool isSupported() const { return true; }
+
+    /// @brief send the break field, the UART is idle before (flushed)
+    /// @param driver UART of the bus
+    /// @param baud nominal baud rate of the bus
+    /// @return count of break bytes written (1 on success)
+    virtual size_t writeBreak(HardwareSerial &driver, const unsigned long baud) = 0;
+
+    /// @brief nominal length of the delimiter [bit times], the delimiter of a UART break is its stop bit
+    virtual uint32_t getDelimiterBits() const { return delimiterBits_min; }
+
+    /// @brief send a break and record its cost
+    size_t send(HardwareSerial &driver, const unsigned long baud)
+    {
+        const uint32_t start = micros();
+        const size_t result = writeBreak(driver, baud);
+        const uint32_t elapsed = micros() - start;
+
+        cost.count++;
+        cost.last_us = elapsed;
+        cost.max_us = std::max(cost.max_us, elapsed);
+        cost.total_us += elapsed;
+        return result;
+    }
+
+    /// @brief the last break fulfills LIN 2.2A Spec 2.3.1.1 at this baud rate
+    bool meetsSpec(const unsigned long baud) const
+    {
+        return cost.count &&
+               (static_cast<uint64_t>(cost.break_us) * baud >= breakBits_min * 1000000ull) &&
+               (getDelimiterBits() >= delimiterBits_min);
+    }
+
+    /// @brief mean time the caller is blocked by a break [us]
+    uint32_t getMeanCost() const
+    {
+        return cost.count ? static_cast<uint32_t>(cost.total_us / cost.count) : UINT32_MAX;
+    }
+
+    const Cost& getCost() const { return cost; }
+    void resetCost() { cost = {}; }
+
+protected:
+    Cost cost;
+
+    /// @brief duration of bits [us], rounded up
+    static uint32_t bitsToMicros(const uint32_t bits, const unsigned long baud)
+    {
+        return static_cast<uint32_t>((bits * 1000000ull + baud - 1) / baud);
+    }
+};
+
+// a byte 0x00 at half baud rate: start bit + 8 data bits = 18 bit times dominant, stop bit = 2 bit times delimiter
+class LinHalfBaudBreak : public LinBreakStrategy {
+public:
+    const char* getName() const override { return "half-baud"; }
+
+    size_t writeBreak(HardwareSerial &driver, const unsigned long baud) override
+    {
+        // configure to half baudrate --> a t_bit will be doubled
+        driver.updateBaudRate(baud >> 1);
+        // write 0x00, including Stop-Bit (=1),
+        // qualifies when writing in slow motion like a Break in normal speed
+        size_t result = driver.write(static_cast<uint8_t>(0x00));
+        // ensure this was send
+        driver.flush();
+        // restore normal speed
+        driver.updateBaudRate(baud);
+
+        cost.break_us = bitsToMicros(2 * 9, baud);
+        return result;
+    }
+
+    uint32_t getDelimiterBits() const override { return 2; }
+};
+
+// break generated by the UART driver, the function sends a break of the given bit times and returns false if unsupported
+class LinNativeBreak : public LinBreakStrategy {
+public:
+    using SendBreak = std::function<bool(const uint32_t bits)>;
+
+    explicit LinNativeBreak(SendBreak sendBreak, const uint32_t bits = breakBits_min) :
+        sendBreak(std::move(sendBreak)),
+        bits(bits)
+    {}
+
+    const char* getName() const override { return "native"; }
+
+    bool isSupported() const override { return static_cast<bool>(sendBreak); }
+
+    size_t writeBreak(HardwareSerial &, const unsigned long baud) override
+    {
+        if (!sendBreak || !sendBreak(bits)) {
+            cost.break_us = 0;
+            return 0;
+        }
+        // the length is guaranteed by the UART
+        cost.break_us = bitsToMicros(bits, baud);
+        return 1;
+    }
+
+private:
+    SendBreak sendBreak;
+    uint32_t bits;
+};
+
+// TX line driven by a GPIO while the UART is idle, the dominant time is measured
+class LinGpioBreak : public LinBreakStrategy {
+public:
+    using SetDominant = std::function<void(const bool dominant)>;
+
+    explicit LinGpioBreak(SetDominant setDominant, const uint32_t bits = breakBits_min, const uint32_t delimiterBits = delimiterBits_min) :
+        setDominant(std::move(setDominant)),
+        bits(bits),
+        delimiterBits(delimiterBits)
+    {}
+
+    const char* getName() const override { return "gpio"; }
+
+    bool isSupported() const override { return static_cast<bool>(setDominant); }
+
+    size_t writeBreak(HardwareSerial &, const unsigned long baud) override
+    {
+        if (!setDominant) {
+            cost.break_us = 0;
+            return 0;
+        }
+        const uint32_t start = micros();
+        setDominant(true);
+        delayMicroseconds(bitsToMicros(bits, baud));
+        setDominant(false);
+        cost.break_us = micros() - start;
+        delayMicroseconds(bitsToMicros(delimiterBits, baud));
+        return 1;
+    }
+
+    uint32_t getDelimiterBits() const override { return delimiterBits; }
+
+private:
+    SetDominant setDominant;
+    uint32_t bits;
+    uint32_t delimiterBits;
+};
@@ -0,0 +1,218 @@
+// LinBusExecutor.hpp
+//
+// Serialized access to a single bus from several tasks
+// - the executor owns the bus, only its owner task touches the driver
+// - clients submit requests (any frame or PDU service of the bus) into lock-free MPSC queues
+// - result by std::future or by a callback, executed within the owner task
+// - a queue per priority, FIFO within a priority
+// - deadline per request: an expired request is completed without bus access (empty result)
+
+#pragma once
+
+#ifdef UNIT_TEST
+    #include "../test/mock_millis.h"
+#else
+    #include <Arduino.h>
+#endif
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "LinMpscQueue.hpp"
+
+template <typename Bus, size_t Capacity = 32>
+class LinBusExecutor {
+public:
+    enum class Priority : uint8_t {
+        HIGH = 0,   // e.g. diagnostic requests of a tester
+        NORMAL,
+        LOW         // e.g. background discovery
+    };
+
+    // result of a request: empty, if the request has expired or was not accepted (queue full)
+    template <typename F>
+    using Value = std::conditional_t<std::is_void_v<std::invoke_result_t<F, Bus&>>, bool, std::invoke_result_t<F, Bus&>>;
+
+    // owner task sleeps at most this time, in case a wakeup was missed by a producer [ms]
+    static constexpr uint32_t idleInterval_ms = 1;
+
+    template <typename... Args>
+    explicit LinBusExecutor(Args&&... args) :
+        bus(std::forward<Args>(args)...)
+    {}
+
+    LinBusExecutor(const LinBusExecutor&) = delete;
+    LinBusExecutor& operator=(const LinBusExecutor&) = delete;
+
+    ~LinBusExecutor()
+    {
+        stop();
+    }
+
+    /// @brief Queue a request, the result is delivered by a future
+    /// @param request callable (Bus&), executed by the owner task
+    /// @param priority queue of the request
+    /// @param timeout deadline relative to now [ms], 0 = no deadline
+    /// @return future of the result, empty if expired or rejected
+    template <typename F>
+    std::future<std::optional<Value<F>>> submit(F request, const Priority priority = Priority::NORMAL, const uint32_t timeout = 0)
+    {
+        auto promise = std::make_shared<std::promise<std::optional<Value<F>>>>();
+        auto future = promise->get_future();
+        post(std::move(request), [promise](std::optional<Value<F>> result) {
+            promise->set_value(std::move(result));
+        }, priority, timeout);
+        return future;
+    }
+
+    /// @brief Queue a request, the result is delivered by a callback
+    /// @param request callable (Bus&), executed by the owner task
+    /// @param callback called with the result (by the owner task), or with an empty result if the
+    /// request has expired (owner task) or is rejected (calling task, queue full)
+    /// @param priority queue of the request
+    /// @param timeout deadline relative to now [ms], 0 = no deadline
+    /// @return request was queued
+    template <typename F, typename C>
+    bool post(F request, C callback, const Priority priority = Priority::NORMAL, const uint32_t timeout = 0)
+    {
+        Task task;
+        task.deadline = timeout ? millis() + timeout : 0;
+        task.hasDeadline = (0 != timeout);
+        task.run = [request = std::move(request), callback = std::move(callback)](Bus* bus) mutable {
+            if (!bus) {
+                callback(std::optional<Value<F>> {});
+            } else if constexpr (std::is_void_v<std::invoke_result_t<F, Bus&>>) {
+                request(*bus);
+                callback(std::optional<Value<F>> {true});
+            } else {
+                callback(std::optional<Value<F>> {request(*bus)});
+            }
+        };
+
+        // a rejected task is not moved, it is still owned here
+        if (!queues[static_cast<size_t>(priority)].push(std::move(task))) {
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            task.run(nullptr);
+            return false;
+        }
+        wake.notify_one();
+        return true;
+    }
+
+    /// @brief Start the owner task (a thread)
+    void start()
+    {
+        if (running.exchange(true)) {
+            return;
+        }
+        owner = std::thread([this]() { run(); });
+    }
+
+    /// @brief Stop the owner task, queued requests are executed before
+    void stop()
+    {
+        if (!running.exchange(false)) {
+            return;
+        }
+        wake.notify_one();
+        owner.join();
+    }
+
+    /// @brief Event loop mode (no owner task started): execute all queued requests within the calling task
+    /// @return count of requests (executed and expired)
+    size_t runPending()
+    {
+        if (running.load()) {
+            // the owner task is the single consumer of the queues
+            return 0;
+        }
+        size_t count = 0;
+        while (runNext()) {
+            count++;
+        }
+        return count;
+    }
+
+    size_t getExecuted() const { return executed.load(std::memory_order_relaxed); }
+    size_t getExpired() const { return expired.load(std::memory_order_relaxed); }
+    size_t getRejected() const { return rejected.load(std::memory_order_relaxed); }
+
+protected:
+    struct Task {
+        std::function<void(Bus*)> run;  // nullptr: complete without result
+        uint32_t deadline = 0;          // millis()
+        bool hasDeadline = false;
+    };
+
+    Bus bus;
+    std::array<LinMpscQueue<Task, Capacity>, 3> queues;
+
+    std::atomic<bool> running {false};
+    std::thread owner;
+    std::mutex wakeMutex;               // sleep of the owner task only, never taken by producers
+    std::condition_variable wake;
+
+    std::atomic<size_t> executed {0};
+    std::atomic<size_t> expired {0};
+    std::atomic<size_t> rejected {0};
+
+    /// @brief Execute the oldest request of the highest priority (owner task only)
+    /// @return a request was found
+    bool runNext()
+    {
+        Task task;
+        for (auto &queue : queues)
+        {
+            if (!queue.pop(task)) {
+                continue;
+            }
+            if (task.hasDeadline && (static_cast<int32_t>(millis() - task.deadline) > 0)) {
+                expired.fetch_add(1, std::memory_order_relaxed);
+                task.run(nullptr);
+            } else {
+                task.run(&bus);
+                executed.fetch_add(1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+        return false;
+    }
+
+    bool isIdle()
+    {
+        for (auto &queue : queues) {
+            if (!queue.empty()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// @brief Owner task: execute requests until stop() and the queues are drained
+    void run()
+    {
+        while (true)
+        {
+            if (runNext()) {
+                continue;
+            }
+            if (!running.load()) {
+                return;
+            }
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait_for(lock, std::chrono::milliseconds(idleInterval_ms), [this]() {
+                return !running.load() || !isIdle();
+            });
+        }
+    }
+};
@@ -0,0 +1,201 @@
+// LinBusManager.hpp
+//
+// Operation of several LIN channels (e.g. a gateway with up to 4 UARTs) by a single component
+// - owns one bus instance per channel (any layer: LinFrameTransfer ... LinClusterConfig)
+// - jobs (transactions, schedule slots) are queued per channel and executed in order of submission
+// - worker mode: one thread per channel, the blocking transfers of different channels overlap
+// - event loop mode: runPending() executes the queued jobs round robin within the calling thread
+// - a bus is never accessed by two jobs at the same time
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+template <typename Bus>
+class LinBusManager {
+public:
+    using Job = std::function<void(Bus &bus)>;
+
+    LinBusManager() = default;
+    LinBusManager(const LinBusManager&) = delete;
+    LinBusManager& operator=(const LinBusManager&) = delete;
+
+    ~LinBusManager()
+    {
+        stop();
+    }
+
+    /// @brief Create the bus of a new channel, channels can be added before start() only
+    /// @param args constructor arguments of Bus (e.g. HardwareSerial, debug Stream, verbose)
+    /// @return index of the channel
+    template <typename... Args>
+    size_t addBus(Args&&... args)
+    {
+        channels.push_back(std::make_unique<Channel>());
+        channels.back()->bus = std::make_unique<Bus>(std::forward<Args>(args)...);
+        return channels.size() - 1;
+    }
+
+    /// @brief Start a worker thread per channel
+    void start()
+    {
+        if (running.exchange(true)) {
+            return;
+        }
+        for (auto &channel : channels)
+        {
+            channel->stopping = false;
+            Channel* ch = channel.get();
+            channel->worker = std::thread([ch]() { work(*ch); });
+        }
+    }
+
+    /// @brief Stop all worker threads, jobs already queued are executed before
+    void stop()
+    {
+        if (!running.load()) {
+            return;
+        }
+        for (auto &channel : channels)
+        {
+            std::lock_guard<std::mutex> lock(channel->mutex);
+            channel->stopping = true;
+            channel->wake.notify_one();
+        }
+        for (auto &channel : channels) {
+            channel->worker.join();
+        }
+        // cleared after the workers are joined: runPending() must not consume the queues meanwhile
+        running.store(false);
+    }
+
+    /// @brief Queue a job for a channel
+    /// @param index channel
+    /// @param job executed with exclusive access to the bus of the channel
+    /// @return job was queued (channel exists)
+    bool submit(const size_t index, Job job)
+    {
+        if (index >= channels.size()) {
+            return false;
+        }
+        Channel &channel = *channels[index];
+        std::lock_guard<std::mutex> lock(channel.mutex);
+        channel.queue.push_back(std::move(job));
+        channel.wake.notify_one();
+        return true;
+    }
+
+    /// @brief Event loop mode (no worker started): execute one queued job per channel, round robin
+    /// @return count of executed jobs, 0 if all queues are empty
+    size_t runPending()
+    {
+        if (running.load()) {
+            return 0;
+        }
+        size_t executed = 0;
+        for (auto &channel : channels)
+        {
+            if (runNext(*channel)) {
+                executed++;
+            }
+        }
+        return executed;
+    }
+
+    /// @brief Wait until the queues of all channels are empty and no job is running
+    /// @details event loop mode: executes all queued jobs
+    void waitIdle()
+    {
+        if (!running.load()) {
+            while (runPending()) {}
+            return;
+        }
+        for (auto &channel : channels)
+        {
+            std::unique_lock<std::mutex> lock(channel->mutex);
+            channel->idle.wait(lock, [&channel]() { return channel->queue.empty() && !channel->busy; });
+        }
+    }
+
+    /// @brief Bus of a channel, for direct access while no job of this channel is running
+    Bus& getBus(const size_t index)
+    {
+        return *channels[index]->bus;
+    }
+
+    /// @brief count of jobs executed by a channel
+    size_t getExecuted(const size_t index) const
+    {
+        std::lock_guard<std::mutex> lock(channels[index]->mutex);
+        return channels[index]->executed;
+    }
+
+    size_t getBusCount() const { return channels.size(); }
+    bool isRunning() const { return running.load(); }
+
+protected:
+    struct Channel {
+        std::unique_ptr<Bus> bus;
+        std::deque<Job> queue;
+        mutable std::mutex mutex;
+        std::condition_variable wake;   // job queued or stop requested
+        std::condition_variable idle;   // queue drained
+        std::thread worker;
+        bool busy = false;
+        bool stopping = false;
+        size_t executed = 0;
+    };
+
+    std::vector<std::unique_ptr<Channel>> channels;
+    std::atomic<bool> running {false};
+
+    /// @brief Execute the oldest job of a channel
+    /// @return a job was executed
+    static bool runNext(Channel &channel)
+    {
+        std::unique_lock<std::mutex> lock(channel.mutex);
+        if (channel.queue.empty()) {
+            return false;
+        }
+        Job job = std::move(channel.queue.front());
+        channel.queue.pop_front();
+        channel.busy = true;
+        lock.unlock();
+
+        job(*channel.bus);
+
+        lock.lock();
+        channel.busy = false;
+        channel.executed++;
+        if (channel.queue.empty()) {
+            channel.idle.notify_all();
+        }
+        return true;
+    }
+
+    /// @brief Worker thread of a channel: execute jobs until stop() (queue is drained before)
+    static void work(Channel &channel)
+    {
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(channel.mutex);
+                channel.wake.wait(lock, [&channel]() { return channel.stopping || !channel.queue.empty(); });
+                if (channel.queue.empty()) {
+                    // stopping and drained
+                    return;
+                }
+            }
+            runNext(channel);
+        }
+    }
+};
@@ -0,0 +1,300 @@
+// LinClusterConfig.cpp
+//
+// Declarative configuration of a LIN cluster
+// - desired state: NAD and frame ids of every node, identified by its product id (and serial number)
+// - compared with the inventory, only the required transactions are sent
+// - NAD changes are ordered to avoid collisions (cycles are resolved by a temporary NAD)
+// - a converged cluster costs a verification pass at most
+//
+// LIN Specification 2.2A
+// Source https://www.lin-cia.org/fileadmin/microsites/lin-cia.org/resources/documents/LIN_2.2A.pdf
+
+#include "LinClusterConfig.hpp"
+
+#ifdef UNIT_TEST
+    #include "../test/mock_Arduino.h"
+#else
+    #include <Arduino.h>
+#endif
+
+#include <bitset>
+#include <algorithm>
+
+/// @brief Bring the cluster into the desired state
+/// @details 1. map every plan entry to exactly one node of the inventory (restored nodes are validated)
+/// 2. change NADs, a node is moved only if its new NAD is free (cycles are resolved by a temporary NAD)
+/// 3. assign frame ids which differ from the inventory
+/// 4. save the configuration of each modified node
+/// nodes which are already configured do not cause any transaction
+/// @param inventory discovered or restored nodes, updated by every successful transaction
+/// @param plan desired state
+/// @return transactions in order of execution
+LinClusterConfig::Report LinClusterConfig::apply(LinNodeInventory &inventory, const std::vector<NodePlan> &plan)
+{
+    Report report;
+
+    std::vector<Target> targets = match(inventory, plan, report);
+    moveNADs(inventory, targets, report);
+    assignFrameIds(inventory, targets, report);
+    save(targets, report);
+
+    return report;
+}
+
+/// @brief Plan is converged, when every transaction (or verification) succeeded
+/// @return all nodes are configured according to the plan
+bool LinClusterConfig::Report::isConverged() const
+{
+    return std::all_of(changes.begin(), changes.end(), [](const Change& change) { return change.success; });
+}
+
+/// @brief Count of transactions which modified a node (a verification is no modification)
+/// @return count of modifications
+size_t LinClusterConfig::Report::getModifications() const
+{
+    return std::count_if(changes.begin(), changes.end(), [](const Change& change) {
+        return (Action::VERIFY != change.action) && (Action::MATCH != change.action);
+    });
+}
+
+/// @brief Map plan entries to nodes of the inventory
+/// @param inventory nodes, a restored node is validated by a single probe
+/// @param plan desired state
+/// @param report failed mappings are reported as Action::MATCH
+/// @return mapped plan entries
+std::vector<LinClusterConfig::Target> LinClusterConfig::match(LinNodeInventory &inventory, const std::vector<NodePlan> &plan, Report &report)
+{
+    std::vector<Target> targets;
+    targets.reserve(plan.size());
+
+    for (const NodePlan& nodePlan : plan)
+    {
+        const LinNodeInventory::Node* candidate = nullptr;
+        size_t candidates = 0;
+        for (const LinNodeInventory::Node& node : inventory)
+        {
+            if ((node.supplierId == nodePlan.supplierId) && (node.functionId == nodePlan.functionId) &&
+                (!nodePlan.serialNumber || (node.serialNumber == nodePlan.serialNumber)))
+            {
+                candidate = &node;
+                candidates++;
+            }
+        }
+
+        // STRICT: a node is mapped to a single plan entry only
+        bool isTaken = candidate && std::any_of(targets.begin(), targets.end(),
+            [candidate](const Target& target) { return target.NAD == candidate->NAD; });
+
+        if ((1 != candidates) || isTaken) {
+            report.changes.push_back({Action::MATCH, nodePlan.NAD, nodePlan.NAD, false});
+            continue;
+        }
+
+        const uint8_t NAD = candidate->NAD;
+        const bool wasValidated = candidate->validated;
+        const LinNodeInventory::Node* node = validate(inventory, NAD);
+        if (!wasValidated) {
+            report.changes.push_back({Action::VERIFY, NAD, NAD, nullptr != node});
+        }
+        if (!node) {
+            continue;
+        }
+
+        targets.push_back({&nodePlan, NAD, false});
+    }
+
+    return targets;
+}
+
+/// @brief Move every node to its desired NAD without collision
+/// @details a node is moved only if no other node is using its new NAD. When all remaining moves
+/// are blocked by each other (e.g. two nodes swap their NAD), one node is parked on a temporary NAD.
+/// @param inventory nodes
+/// @param targets mapped plan entries
+/// @param report transactions
+void LinClusterConfig::moveNADs(LinNodeInventory &inventory, std::vector<Target> &targets, Report &report)
+{
+    std::bitset<256> occupied;
+    std::bitset<256> reserved;
+    std::bitset<256> planned;
+    for (const LinNodeInventory::Node& node : inventory) {
+        occupied.set(node.NAD);
+    }
+    for (const Target& target : targets) {
+        planned.set(target.NAD);
+    }
+
+    std::vector<Target*> pending;
+    for (Target& target : targets)
+    {
+        const uint8_t newNAD = target.plan->NAD;
+        if (target.NAD == newNAD) {
+            reserved.set(newNAD);
+            continue;
+        }
+
+        // STRICT: NAD is used by a node outside of the plan, or is desired by another node
+        if ((occupied.test(newNAD) && !planned.test(newNAD)) || reserved.test(newNAD)) {
+            report.changes.push_back({Action::MATCH, target.NAD, newNAD, false});
+            continue;
+        }
+        reserved.set(newNAD);
+        pending.push_back(&target);
+    }
+
+    while (!pending.empty())
+    {
+        bool progress = false;
+        for (auto it = pending.begin(); it != pending.end(); )
+        {
+            Target& target = **it;
+            const uint8_t oldNAD = target.NAD;
+            const uint8_t newNAD = target.plan->NAD;
+            if (occupied.test(newNAD)) {
+                ++it;
+                continue;
+            }
+
+            if (moveNAD(inventory, target, newNAD, report)) {
+                occupied.reset(oldNAD);
+                occupied.set(newNAD);
+            }
+            it = pending.erase(it);
+            progress = true;
+        }
+
+        if (progress) {
+            continue;
+        }
+
+        // blocked by a node which is not going to move (e.g. its own move failed)
+        auto isDeadlocked = [&pending](const Target* target) {
+            return std::none_of(pending.begin(), pending.end(),
+                [target](const Target* other) { return other->NAD == target->plan->NAD; });
+        };
+        for (auto it = pending.begin(); it != pending.end(); )
+        {
+            if (isDeadlocked(*it)) {
+                report.changes.push_back({Action::MATCH, (*it)->NAD, (*it)->plan->NAD, false});
+                it = pending.erase(it);
+                progress = true;
+            } else {
+                ++it;
+            }
+        }
+
+        if (progress) {
+            continue;
+        }
+
+        // all remaining moves are blocked by each other: park one node on a temporary NAD
+        uint8_t parkingNAD = 0;
+        for (uint8_t NAD = NAD_last; NAD >= NAD_first; --NAD)
+        {
+            if (!occupied.test(NAD) && !reserved.test(NAD)) {
+                parkingNAD = NAD;
+                break;
+            }
+        }
+
+        Target& target = *pending.front();
+        const uint8_t oldNAD = target.NAD;
+        if (!parkingNAD) {
+            // cluster is full: no way out of this cycle
+            for (const Target* blocked : pending) {
+                report.changes.push_back({Action::MATCH, blocked->NAD, blocked->plan->NAD, false});
+            }
+            break;
+        }
+
+        if (moveNAD(inventory, target, parkingNAD, report)) {
+            occupied.reset(oldNAD);
+            occupied.set(parkingNAD);
+        } else {
+            pending.erase(pending.begin());
+        }
+    }
+}
+
+/// @brief Change the NAD of a single node and update the inventory
+/// @param inventory nodes
+/// @param target node to be moved
+/// @param newNAD new NAD (desired or temporary)
+/// @param report transactions
+/// @return success
+bool LinClusterConfig::moveNAD(LinNodeInventory &inventory, Target &target, const uint8_t newNAD, Report &report)
+{
+    LinNodeInventory::Node node = *inventory.find(target.NAD);
+    uint8_t NAD = target.NAD;
+
+    bool success = static_cast<bool>(assignNAD(NAD, node.supplierId, node.functionId, newNAD));
+    report.changes.push_back({Action::ASSIGN_NAD, target.NAD, newNAD, success});
+    if (!success) {
+        return false;
+    }
+
+    // learned timing belongs to the node, not to the NAD
+    timingProfile.reset(target.NAD);
+    timingProfile.reset(newNAD);
+
+    inventory.remove(target.NAD);
+    node.NAD = newNAD;
+    inventory.update(node);
+
+    target.NAD = newNAD;
+    target.modified = true;
+    return true;
+}
+
+/// @brief Assign frame ids, which differ from the known assignment
+/// @param inventory nodes, holds the known assignment
+/// @param targets mapped plan entries
+/// @param report transactions
+void LinClusterConfig::assignFrameIds(LinNodeInventory &inventory, std::vector<Target> &targets, Report &report)
+{
+    for (Target& target : targets)
+    {
+        LinNodeInventory::Node node = *inventory.find(target.NAD);
+        const std::array<uint8_t, 4>& PIDs = target.plan->PIDs;
+
+        bool isDifferent = false;
+        for (size_t i = 0; i < PIDs.size(); ++i) {
+            isDifferent |= (0xFF != PIDs[i]) && (PIDs[i] != node.PIDs[i]);
+        }
+        if (!isDifferent) {
+            continue;
+        }
+
+        // 0xFF: keep the current assignment of this index
+        uint8_t NAD = target.NAD;
+        bool success = static_cast<bool>(assignFrameIdRange(NAD, 0, PIDs[0], PIDs[1], PIDs[2], PIDs[3]));
+        report.changes.push_back({Action::ASSIGN_FRAME_ID_RANGE, target.NAD, target.NAD, success});
+        if (!success) {
+            continue;
+        }
+
+        for (size_t i = 0; i < PIDs.size(); ++i) {
+            if (0xFF != PIDs[i]) {
+                node.PIDs[i] = PIDs[i];
+            }
+        }
+        inventory.update(node);
+        target.modified = true;
+    }
+}
+
+/// @brief Save the configuration of every modified node
+/// @param targets mapped plan entries
+/// @param report transactions
+void LinClusterConfig::save(std::vector<Target> &targets, Report &report)
+{
+    for (Target& target : targets)
+    {
+        if (!target.modified || !target.plan->save) {
+            continue;
+        }
+        uint8_t NAD = target.NAD;
+        bool success = static_cast<bool>(saveConfig(NAD));
+        report.changes.push_back({Action::SAVE_CONFIG, target.NAD, target.NAD, success});
+    }
+}
@@ -0,0 +1,89 @@
+// LinClusterConfig.hpp
+//
+// Declarative configuration of a LIN cluster
+// - desired state: NAD and frame ids of every node, identified by its product id (and serial number)
+// - compared with the inventory, only the required transactions are sent
+// - NAD changes are ordered to avoid collisions (cycles are resolved by a temporary NAD)
+// - a converged cluster costs a verification pass at most
+//
+// LIN Specification 2.2A
+// Source https://www.lin-cia.org/fileadmin/microsites/lin-cia.org/resources/documents/LIN_2.2A.pdf
+
+#pragma once
+
+#ifdef UNIT_TEST
+    #include "../test/mock_HardwareSerial.h"
+    using HardwareSerial = mock_HardwareSerial;
+#else
+    #include <Arduino.h>
+#endif
+
+#include <array>
+#include <optional>
+#include <vector>
+
+#include "LinNodeDiscovery.hpp"
+#include "LinNodeInventory.hpp"
+
+class LinClusterConfig : protected LinNodeDiscovery {
+public:
+    using LinNodeDiscovery::LinNodeDiscovery;
+    using LinNodeDiscovery::discover;
+    using LinNodeDiscovery::probe;
+    using LinNodeDiscovery::validate;
+    using LinNodeDiscovery::timingProfile;
+    using LinNodeDiscovery::frameStats;
+    using LinNodeDiscovery::logger;
+    using LinNodeDiscovery::trace;
+    using LinNodeDiscovery::drainLog;
+
+    // desired state of a single node
+    struct NodePlan {
+        uint16_t supplierId;
+        uint16_t functionId;
+        std::optional<uint32_t> serialNumber; // required to distinguish identical products
+        uint8_t NAD;                          // desired NAD
+        std::array<uint8_t, 4> PIDs {0xFF, 0xFF, 0xFF, 0xFF}; // desired frame ids (0xFF = don't care)
+        bool save = true;                     // SAVE_CONFIG after a change
+    };
+
+    enum class Action : uint8_t {
+        VERIFY,                 // identity of a restored node confirmed by the bus
+        ASSIGN_NAD,             // NAD changed (newNAD may be a temporary NAD)
+        ASSIGN_FRAME_ID_RANGE,  // frame ids assigned
+        SAVE_CONFIG,            // configuration saved by node
+        MATCH                   // plan could not be mapped (node missing, ambiguous or NAD occupied)
+    };
+
+    struct Change {
+        Action action;
+        uint8_t NAD;    // NAD of node before the transaction (or desired NAD for Action::MATCH)
+        uint8_t newNAD; // NAD of node after the transaction
+        bool success;
+    };
+
+    struct Report {
+        std::vector<Change> changes;
+
+        // all nodes are configured according to the plan
+        bool isConverged() const;
+        // count of transactions which modified a node
+        size_t getModifications() const;
+    };
+
+    Report apply(LinNodeInventory &inventory, const std::vector<NodePlan> &plan);
+
+protected:
+    // plan entry, mapped to a node of the inventory
+    struct Target {
+        const NodePlan* plan;
+        uint8_t NAD; // current NAD of node
+        bool modified;
+    };
+
+    std::vector<Target> match(LinNodeInventory &inventory, const std::vector<NodePlan> &plan, Report &report);
+    void moveNADs(LinNodeInventory &inventory, std::vector<Target> &targets, Report &report);
+    bool moveNAD(LinNodeInventory &inventory, Target &target, const uint8_t newNAD, Report &report);
+    void assignFrameIds(LinNodeInventory &inventory, std::vector<Target> &targets, Report &report);
+    void save(std::vector<Target> &targets, Report &report);
+};
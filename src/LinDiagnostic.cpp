@@ -0,0 +1,195 @@
+// LinDiagnostic.cpp
+//
+// Diagnostic services (UDS, ISO 14229-1) transported via the Diagnostic Transport Layer (DTL)
+// - ReadDataByIdentifier, several DIDs within a single request
+// - WriteDataByIdentifier
+// - DiagnosticSessionControl
+//
+// LIN Specification 2.2A
+// Source https://www.lin-cia.org/fileadmin/microsites/lin-cia.org/resources/documents/LIN_2.2A.pdf
+
+#include "LinDiagnostic.hpp"
+
+#ifdef UNIT_TEST
+    #include "../test/mock_Arduino.h"
+#else
+    #include <Arduino.h>
+#endif
+
+#include <optional>
+#include <vector>
+#include <cstring>
+
+/// @brief Read several data identifiers within one request (one multi frame exchange)
+/// @details ISO 14229-1 ReadDataByIdentifier (0x22)
+/// Request:  0x22 DID#1 ... DID#n
+/// Response: 0x62 DID#1 data#1 ... DID#n data#n
+/// @param NAD Node Address (wildcard will be replaced by responding NAD)
+/// @param dids list of DIDs, each with a destination buffer of the exact size of its data record
+/// @return status and NRC
+LinDiagnostic::Result LinDiagnostic::readDataByIdentifier(uint8_t &NAD, const std::vector<DataIdentifier>& dids)
+{
+    uint8_t SID = static_cast<uint8_t>(ServiceIdentifier::READ_DATA_BY_IDENTIFIER);
+    std::vector<uint8_t> payload;
+    payload.reserve(1 + 2 * dids.size());
+    payload.push_back(SID);
+
+    size_t expectedBytes = 1;
+    for (const DataIdentifier& did : dids)
+    {
+        payload.push_back(highByte(did.id));
+        payload.push_back(lowByte(did.id));
+        expectedBytes += 2 + did.length;
+    }
+
+    std::optional<std::vector<uint8_t>> raw;
+    Result result = request(NAD, payload, raw);
+    if (!result) {
+        return result;
+    }
+
+    const std::vector<uint8_t>& response = raw.value();
+    if (response.size() < expectedBytes) {
+        return {Status::INVALID_RESPONSE, 0};
+    }
+
+    // decode data records, skip RSID
+    size_t pos = 1;
+    for (const DataIdentifier& did : dids)
+    {
+        uint16_t rxId = response[pos] << 8 | response[pos + 1];
+        if (rxId != did.id) {
+            // STRICT: DIDs are answered in order of request
+            return {Status::INVALID_RESPONSE, 0};
+        }
+        pos += 2;
+
+        std::memcpy(did.buffer, &response[pos], did.length);
+        pos += did.length;
+    }
+
+    return result;
+}
+
+/// @brief Read a single data identifier
+/// @details ISO 14229-1 ReadDataByIdentifier (0x22)
+/// @param NAD Node Address (wildcard will be replaced by responding NAD)
+/// @param id DID
+/// @param buffer destination of data record
+/// @param length size of data record
+/// @return status and NRC
+LinDiagnostic::Result LinDiagnostic::readDataByIdentifier(uint8_t &NAD, uint16_t id, uint8_t* buffer, size_t length)
+{
+    return readDataByIdentifier(NAD, {{id, buffer, length}});
+}
+
+/// @brief Write data record of a data identifier
+/// @details ISO 14229-1 WriteDataByIdentifier (0x2E)
+/// Request:  0x2E DID data
+/// Response: 0x6E DID
+/// @param NAD Node Address
+/// @param id DID
+/// @param data data record
+/// @return status and NRC
+LinDiagnostic::Result LinDiagnostic::writeDataByIdentifier(uint8_t &NAD, uint16_t id, const std::vector<uint8_t>& data)
+{
+    uint8_t SID = static_cast<uint8_t>(ServiceIdentifier::WRITE_DATA_BY_IDENTIFIER);
+    std::vector<uint8_t> payload;
+    payload.reserve(3 + data.size());
+    payload.push_back(SID);
+    payload.push_back(highByte(id));
+    payload.push_back(lowByte(id));
+    payload.insert(payload.end(), data.begin(), data.end());
+
+    std::optional<std::vector<uint8_t>> raw;
+    Result result = request(NAD, payload, raw);
+    if (!result) {
+        return result;
+    }
+
+    const std::vector<uint8_t>& response = raw.value();
+    if ((response.size() < 3) || ((response[1] << 8 | response[2]) != id)) {
+        return {Status::INVALID_RESPONSE, 0};
+    }
+
+    return result;
+}
+
+/// @brief Switch the diagnostic session of a node
+/// @details ISO 14229-1 DiagnosticSessionControl (0x10)
+/// Request:  0x10 session
+/// Response: 0x50 session [timing parameters]
+/// @param NAD Node Address
+/// @param session requested session
+/// @return status and NRC
+LinDiagnostic::Result LinDiagnostic::diagnosticSessionControl(uint8_t &NAD, Session session)
+{
+    uint8_t SID = static_cast<uint8_t>(ServiceIdentifier::DIAGNOSTIC_SESSION_CONTROL);
+    std::vector<uint8_t> payload = {
+        SID,
+        static_cast<uint8_t>(session)
+    };
+
+    std::optional<std::vector<uint8_t>> raw;
+    Result result = request(NAD, payload, raw);
+    if (!result) {
+        return result;
+    }
+
+    const std::vector<uint8_t>& response = raw.value();
+    if ((response.size() < 2) || (response[1] != static_cast<uint8_t>(session))) {
+        return {Status::INVALID_RESPONSE, 0};
+    }
+
+    return result;
+}
+
+/// @brief Transmit request and classify the response
+/// @details waits for the final response, when the node signals "response pending" (NRC 0x78)
+/// @param NAD Node Address
+/// @param payload request, first byte is the SID
+/// @param response received payload (positive or negative)
+/// @param streamed frames of request are written back-to-back without readback verification
+/// @return status and NRC, positive response is verified by RSID
+LinDiagnostic::Result LinDiagnostic::request(uint8_t &NAD, const std::vector<uint8_t>& payload, std::optional<std::vector<uint8_t>>& response, bool streamed)
+{
+    const uint8_t SID = payload.front();
+    response = streamed ? writePDUStreamed(NAD, payload) : writePDU(NAD, payload);
+
+    for (uint8_t pending = 0; pending < responsePending_max; ++pending)
+    {
+        if (!response || response.value().empty()) {
+            return {Status::NO_RESPONSE, 0};
+        }
+
+        const std::vector<uint8_t>& rx = response.value();
+        if (getRSID(SID) == rx.front()) {
+            return {Status::OK, 0};
+        }
+
+        if ((NEGATIVE_RESPONSE != rx.front()) || (rx.size() < 3) || (rx[1] != SID)) {
+            // unexpected: payload[0] is not equal to neither RSID nor 0x7F
+            return {Status::INVALID_RESPONSE, 0};
+        }
+
+        if (NRC_RESPONSE_PENDING != rx[2]) {
+            return {Status::NEGATIVE_RESPONSE, rx[2]};
+        }
+
+        // node is still busy, final response will follow without a new request (within P2*, not by its learned timing)
+        response = readPduResponse(NAD, 0, timeout_ResponsePending);
+    }
+
+    return {Status::NO_RESPONSE, NRC_RESPONSE_PENDING};
+}
+
+/// @brief convert SID to RSID
+/// @details 4.2.3.5 RSID = Response Service Identifier
+/// @param SID input
+/// @return RSID
+constexpr uint8_t LinDiagnostic::getRSID(const uint8_t SID)
+{
+    // RSID = SID + 0x40
+    constexpr uint8_t SID_TO_RSID_MASK = 0x40;
+    return SID + SID_TO_RSID_MASK;
+}
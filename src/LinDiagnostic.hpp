@@ -0,0 +1,82 @@
+// LinDiagnostic.hpp
+//
+// Diagnostic services (UDS, ISO 14229-1) transported via the Diagnostic Transport Layer (DTL)
+// - ReadDataByIdentifier, several DIDs within a single request
+// - WriteDataByIdentifier
+// - DiagnosticSessionControl
+//
+// LIN Specification 2.2A
+// Source https://www.lin-cia.org/fileadmin/microsites/lin-cia.org/resources/documents/LIN_2.2A.pdf
+
+#pragma once
+
+#ifdef UNIT_TEST
+    #include "../test/mock_HardwareSerial.h"
+    using HardwareSerial = mock_HardwareSerial;
+#else
+    #include <Arduino.h>
+#endif
+
+#include <optional>
+#include <vector>
+
+#include "LinTransportLayer.hpp"
+#include "LinNegativeResponse.hpp"
+
+class LinDiagnostic : protected LinTransportLayer {
+public:
+    using LinTransportLayer::LinTransportLayer;
+    using LinTransportLayer::timingProfile;
+    using LinTransportLayer::frameStats;
+    using LinTransportLayer::logger;
+    using LinTransportLayer::trace;
+    using LinTransportLayer::drainLog;
+
+    using Status = LinServiceStatus;
+
+    struct Result {
+        Status status;
+        uint8_t NRC; // Negative Response Code, valid for Status::NEGATIVE_RESPONSE
+
+        explicit operator bool() const { return Status::OK == status; }
+        const char* getNrcString() const { return LinNegativeResponse::toString(NRC); }
+    };
+
+    // Data Identifier to be read, data will be decoded into buffer of caller
+    struct DataIdentifier {
+        uint16_t id;        // DID
+        uint8_t* buffer;    // destination of data record
+        size_t length;      // size of data record of this DID (must be known for a multi DID request)
+    };
+
+    enum class Session : uint8_t {
+        DEFAULT = 0x01,
+        PROGRAMMING = 0x02,
+        EXTENDED = 0x03
+    };
+
+    Result readDataByIdentifier(uint8_t &NAD, const std::vector<DataIdentifier>& dids);
+    Result readDataByIdentifier(uint8_t &NAD, uint16_t id, uint8_t* buffer, size_t length);
+    Result writeDataByIdentifier(uint8_t &NAD, uint16_t id, const std::vector<uint8_t>& data);
+    Result diagnosticSessionControl(uint8_t &NAD, Session session);
+
+protected:
+    // ISO 14229-1 SID
+    enum class ServiceIdentifier : uint8_t {
+        DIAGNOSTIC_SESSION_CONTROL = 0x10,
+        READ_DATA_BY_IDENTIFIER = 0x22,
+        WRITE_DATA_BY_IDENTIFIER = 0x2E
+    };
+
+    // DTL standard payload
+    static constexpr uint8_t NEGATIVE_RESPONSE = LinNegativeResponse::SID;
+    // node accepted the request, but needs more time: final response will follow
+    static constexpr uint8_t NRC_RESPONSE_PENDING = LinNegativeResponse::RESPONSE_PENDING;
+    // count of accepted "response pending" before giving up
+    static constexpr uint8_t responsePending_max = 10;
+    // ISO 14229-2 P2*_server_max: final response after a "response pending" [ms], not learned per node
+    static constexpr uint16_t timeout_ResponsePending = 5000;
+
+    Result request(uint8_t &NAD, const std::vector<uint8_t>& payload, std::optional<std::vector<uint8_t>>& response, bool streamed = false);
+    static constexpr uint8_t getRSID(const uint8_t SID);
+};
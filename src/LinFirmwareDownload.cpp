@@ -0,0 +1,224 @@
+// LinFirmwareDownload.cpp
+//
+// Firmware download (UDS block transfer) via the Diagnostic Transport Layer (DTL)
+// - RequestDownload, TransferData, RequestTransferExit
+// - frames of a block are streamed back-to-back, the block is confirmed by the response only
+// - transfer can be resumed from the last acknowledged block
+//
+// LIN Specification 2.2A
+// Source https://www.lin-cia.org/fileadmin/microsites/lin-cia.org/resources/documents/LIN_2.2A.pdf
+
+#include "LinFirmwareDownload.hpp"
+
+#ifdef UNIT_TEST
+    #include "../test/mock_Arduino.h"
+    #include "../test/mock_millis.h"
+#else
+    #include <Arduino.h>
+#endif
+
+#include <optional>
+#include <vector>
+#include <algorithm>
+
+/// @brief Download an image into a node
+/// @details RequestDownload (0x34) --> n * TransferData (0x36) --> RequestTransferExit (0x37)
+/// a session which allows the download (e.g. Session::PROGRAMMING) must be active
+/// @param NAD Node Address
+/// @param address destination address within the node
+/// @param image data to be downloaded (must be valid until the download is finished or given up)
+/// @param size size of image
+/// @return status and NRC, on failure the download may be continued by resume()
+LinFirmwareDownload::Result LinFirmwareDownload::download(uint8_t &NAD, uint32_t address, const uint8_t* image, size_t size)
+{
+    progress = {};
+    progress.address = address;
+    progress.size = size;
+
+    Result result = requestDownload(NAD);
+    if (!result) {
+        progress = {};
+        return result;
+    }
+
+    return resume(NAD, image);
+}
+
+/// @brief Continue a suspended download with the block following the last acknowledged one
+/// @param NAD Node Address
+/// @param image same image as used by download()
+/// @return status and NRC; NOT_IN_PROGRESS in case no download was started
+LinFirmwareDownload::Result LinFirmwareDownload::resume(uint8_t &NAD, const uint8_t* image)
+{
+    if (0 == progress.blockLength) {
+        // no download started (or already finished)
+        return {Status::NOT_IN_PROGRESS, 0};
+    }
+
+    Result result = transferBlocks(NAD, image);
+    if (!result) {
+        return result;
+    }
+
+    result = requestTransferExit(NAD);
+    if (result) {
+        progress.blockLength = 0;
+    }
+    return result;
+}
+
+/// @brief Current state of the download
+/// @return progress
+const LinFirmwareDownload::Progress& LinFirmwareDownload::getProgress() const
+{
+    return progress;
+}
+
+/// @brief Throughput of TransferData compared to the theoretical maximum of the bus
+/// @details theoretical maximum: every frame slot is a consecutive frame (6 bytes) without any gap
+/// @return bytes per second
+LinFirmwareDownload::Throughput LinFirmwareDownload::getThroughput() const
+{
+    Throughput throughput {};
+    throughput.theoretical = baud * PDU::dataLenConsecutive / getFrameBitsNominal(sizeof(PDU));
+    if (progress.elapsed) {
+        throughput.effective = progress.bytesAcknowledged * 1000 / progress.elapsed;
+    }
+    return throughput;
+}
+
+/// @brief Announce the download and negotiate the block length
+/// @details Request:  0x34 dataFormatIdentifier addressAndLengthFormatIdentifier address size
+///          Response: 0x74 lengthFormatIdentifier maxNumberOfBlockLength
+/// @param NAD Node Address
+/// @return status and NRC
+LinFirmwareDownload::Result LinFirmwareDownload::requestDownload(uint8_t &NAD)
+{
+    uint8_t SID = static_cast<uint8_t>(ServiceIdentifier::REQUEST_DOWNLOAD);
+    std::vector<uint8_t> payload = {
+        SID,
+        0x00, // dataFormatIdentifier: no compression, no encryption
+        0x44, // addressAndLengthFormatIdentifier: 4 bytes size, 4 bytes address
+        static_cast<uint8_t>(progress.address >> 24),
+        static_cast<uint8_t>(progress.address >> 16),
+        static_cast<uint8_t>(progress.address >> 8),
+        static_cast<uint8_t>(progress.address),
+        static_cast<uint8_t>(progress.size >> 24),
+        static_cast<uint8_t>(progress.size >> 16),
+        static_cast<uint8_t>(progress.size >> 8),
+        static_cast<uint8_t>(progress.size)
+    };
+
+    std::optional<std::vector<uint8_t>> raw;
+    Result result = request(NAD, payload, raw);
+    if (!result) {
+        return result;
+    }
+
+    const std::vector<uint8_t>& response = raw.value();
+    size_t lengthBytes = (response.size() >= 2) ? (response[1] >> 4) : 0;
+    if ((0 == lengthBytes) || (response.size() < 2 + lengthBytes)) {
+        return {Status::INVALID_RESPONSE, 0};
+    }
+
+    size_t maxNumberOfBlockLength = 0;
+    for (size_t i = 0; i < lengthBytes; ++i) {
+        maxNumberOfBlockLength = (maxNumberOfBlockLength << 8) | response[2 + i];
+    }
+
+    // maxNumberOfBlockLength does include SID and blockSequenceCounter
+    if (maxNumberOfBlockLength <= 2) {
+        return {Status::INVALID_RESPONSE, 0};
+    }
+    progress.blockLength = std::min(maxNumberOfBlockLength - 2, blockLength_max);
+
+    return result;
+}
+
+/// @brief Transfer all remaining blocks, every block is repeated on failure
+/// @param NAD Node Address
+/// @param image data to be downloaded
+/// @return status and NRC
+LinFirmwareDownload::Result LinFirmwareDownload::transferBlocks(uint8_t &NAD, const uint8_t* image)
+{
+    Result result {Status::OK, 0};
+    // every block is sent at least once
+    const uint8_t attempts = std::max<uint8_t>(retries_max, 1);
+
+    while (progress.bytesAcknowledged < progress.size)
+    {
+        // blockSequenceCounter starts with 0x01, wraps around to 0x00
+        const uint8_t blockSequenceCounter = progress.blockSequenceCounter + 1;
+        const size_t length = std::min(progress.blockLength, progress.size - progress.bytesAcknowledged);
+
+        for (uint8_t attempt = 0; attempt < attempts; ++attempt)
+        {
+            auto start = millis();
+            result = transferData(NAD, blockSequenceCounter, image + progress.bytesAcknowledged, length);
+            progress.elapsed += millis() - start;
+
+            if (result || (Status::NEGATIVE_RESPONSE == result.status)) {
+                // success, or rejected by node: no repetition
+                break;
+            }
+        }
+
+        if (!result) {
+            // suspended: can be resumed by block following the last acknowledged
+            return result;
+        }
+
+        progress.blockSequenceCounter = blockSequenceCounter;
+        progress.bytesAcknowledged += length;
+    }
+
+    return result;
+}
+
+/// @brief Transfer a single block
+/// @details Request:  0x36 blockSequenceCounter data
+///          Response: 0x76 blockSequenceCounter
+/// frames of the block are streamed back-to-back, the response confirms the complete block
+/// @param NAD Node Address
+/// @param blockSequenceCounter of this block
+/// @param data begin of block
+/// @param length bytes of block
+/// @return status and NRC
+LinFirmwareDownload::Result LinFirmwareDownload::transferData(uint8_t &NAD, const uint8_t blockSequenceCounter, const uint8_t* data, size_t length)
+{
+    uint8_t SID = static_cast<uint8_t>(ServiceIdentifier::TRANSFER_DATA);
+    std::vector<uint8_t> payload;
+    payload.reserve(2 + length);
+    payload.push_back(SID);
+    payload.push_back(blockSequenceCounter);
+    payload.insert(payload.end(), data, data + length);
+
+    std::optional<std::vector<uint8_t>> raw;
+    Result result = request(NAD, payload, raw, true);
+    if (!result) {
+        return result;
+    }
+
+    const std::vector<uint8_t>& response = raw.value();
+    if ((response.size() < 2) || (response[1] != blockSequenceCounter)) {
+        return {Status::INVALID_RESPONSE, 0};
+    }
+
+    return result;
+}
+
+/// @brief Finish the download
+/// @details Request:  0x37
+///          Response: 0x77
+/// @param NAD Node Address
+/// @return status and NRC
+LinFirmwareDownload::Result LinFirmwareDownload::requestTransferExit(uint8_t &NAD)
+{
+    uint8_t SID = static_cast<uint8_t>(ServiceIdentifier::REQUEST_TRANSFER_EXIT);
+    std::vector<uint8_t> payload = {
+        SID
+    };
+
+    std::optional<std::vector<uint8_t>> raw;
+    return request(NAD, payload, raw);
+}
@@ -0,0 +1,78 @@
+// LinFirmwareDownload.hpp
+//
+// Firmware download (UDS block transfer) via the Diagnostic Transport Layer (DTL)
+// - RequestDownload, TransferData, RequestTransferExit
+// - frames of a block are streamed back-to-back, the block is confirmed by the response only
+// - transfer can be resumed from the last acknowledged block
+//
+// LIN Specification 2.2A
+// Source https://www.lin-cia.org/fileadmin/microsites/lin-cia.org/resources/documents/LIN_2.2A.pdf
+
+#pragma once
+
+#ifdef UNIT_TEST
+    #include "../test/mock_HardwareSerial.h"
+    using HardwareSerial = mock_HardwareSerial;
+#else
+    #include <Arduino.h>
+#endif
+
+#include <optional>
+#include <vector>
+
+#include "LinDiagnostic.hpp"
+
+class LinFirmwareDownload : protected LinDiagnostic {
+public:
+    using LinDiagnostic::LinDiagnostic;
+    using LinDiagnostic::Status;
+    using LinDiagnostic::Result;
+    using LinDiagnostic::Session;
+    using LinDiagnostic::diagnosticSessionControl;
+    using LinDiagnostic::timingProfile;
+    using LinDiagnostic::frameStats;
+    using LinDiagnostic::logger;
+    using LinDiagnostic::trace;
+    using LinDiagnostic::drainLog;
+
+    struct Progress {
+        uint32_t address;           // destination address of image
+        size_t size;                // size of image
+        size_t bytesAcknowledged;   // confirmed by node
+        size_t blockLength;         // data bytes per TransferData (negotiated by RequestDownload)
+        uint8_t blockSequenceCounter; // of last acknowledged block
+        uint32_t elapsed;           // time spent in TransferData [ms]
+    };
+
+    struct Throughput {
+        uint32_t effective;   // bytes/s of image data (TransferData only)
+        uint32_t theoretical; // bytes/s on the bus, when every frame slot is used for data
+    };
+
+    // attempts for each block, before the download is suspended (at least one)
+    uint8_t retries_max = 3;
+
+    Result download(uint8_t &NAD, uint32_t address, const uint8_t* image, size_t size);
+    Result resume(uint8_t &NAD, const uint8_t* image);
+
+    const Progress& getProgress() const;
+    Throughput getThroughput() const;
+
+protected:
+    // ISO 14229-1 SID
+    enum class ServiceIdentifier : uint8_t {
+        REQUEST_DOWNLOAD = 0x34,
+        TRANSFER_DATA = 0x36,
+        REQUEST_TRANSFER_EXIT = 0x37
+    };
+
+    // DTL limits a PDU to 4095 bytes, reduced by SID and block sequence counter
+    static constexpr size_t blockLength_max = 4095 - 2;
+
+    Progress progress {};
+
+    Result requestDownload(uint8_t &NAD);
+    Result transferBlocks(uint8_t &NAD, const uint8_t* image);
+    Result transferData(uint8_t &NAD, const uint8_t blockSequenceCounter, const uint8_t* data, size_t length);
+    Result requestTransferExit(uint8_t &NAD);
+};
@@ -0,0 +1,138 @@
+// LinFrameStats.hpp
+//
+// Provides statistics of the frame layer per frame ID (64 entries, fixed)
+// - attempts and their outcome: success, timeout, checksum error, readback mismatch, sync/PID error
+// - latency of successful frames: start of the break until the frame is complete [us]
+// - updated by the owner of the bus, read (snapshot) and reset by any task: relaxed atomics, lock-free
+//
+// Counters wrap around, a periodic health report is expected to snapshot and reset the table.
+//
+// LIN Specification 2.2A
+// Source https://www.lin-cia.org/fileadmin/microsites/lin-cia.org/resources/documents/LIN_2.2A.pdf
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+class LinFrameStats {
+public:
+    static constexpr size_t FRAME_IDS = 64;
+
+    enum class Outcome : uint8_t {
+        Success,            // response or readback valid
+        Timeout,            // no (complete) response or readback within the timeout
+        ChecksumError,      // response received, checksum invalid
+        ReadbackMismatch,   // readback deviates from the written frame (bit error, collision)
+        HeadError,          // sync or PID of the header not received as sent
+        Unverified          // written without verification of the readback (ReadbackPolicy Skip or Discard)
+    };
+
+    // copy of the counters of a frame ID
+    struct Snapshot {
+        uint32_t attempts = 0;
+        uint32_t successes = 0;
+        uint32_t timeouts = 0;
+        uint32_t checksumErrors = 0;
+        uint32_t readbackMismatches = 0;
+        uint32_t headErrors = 0;
+        uint32_t latencyMin_us = 0;
+        uint32_t latencyMean_us = 0;
+        uint32_t latencyMax_us = 0;
+    };
+
+    using Table = std::array<Snapshot, FRAME_IDS>;
+
+    /// @brief record the outcome of a frame, called by the owner of the bus only
+    /// @param frameID frame ID (protected ID is masked)
+    /// @param outcome result of the frame
+    /// @param latency_us duration of the frame (Success only)
+    void record(const uint8_t frameID, const Outcome outcome, const uint32_t latency_us = 0)
+    {
+        Entry &entry = entries[frameID & (FRAME_IDS - 1)];
+        entry.attempts.fetch_add(1, std::memory_order_relaxed);
+
+        switch (outcome) {
+        case Outcome::Success:
+            entry.successes.fetch_add(1, std::memory_order_relaxed);
+            entry.latencySum_us.fetch_add(latency_us, std::memory_order_relaxed);
+            // single writer: no compare and swap required
+            if (latency_us < entry.latencyMin_us.load(std::memory_order_relaxed)) {
+                entry.latencyMin_us.store(latency_us, std::memory_order_relaxed);
+            }
+            if (latency_us > entry.latencyMax_us.load(std::memory_order_relaxed)) {
+                entry.latencyMax_us.store(latency_us, std::memory_order_relaxed);
+            }
+            break;
+        case Outcome::Timeout:          entry.timeouts.fetch_add(1, std::memory_order_relaxed); break;
+        case Outcome::ChecksumError:    entry.checksumErrors.fetch_add(1, std::memory_order_relaxed); break;
+        case Outcome::ReadbackMismatch: entry.readbackMismatches.fetch_add(1, std::memory_order_relaxed); break;
+        case Outcome::HeadError:        entry.headErrors.fetch_add(1, std::memory_order_relaxed); break;
+        case Outcome::Unverified:       break;
+        }
+    }
+
+    /// @brief counters of a frame ID, the fields are read one by one (not consistent to each other while the bus is active)
+    Snapshot snapshot(const uint8_t frameID) const
+    {
+        const Entry &entry = entries[frameID & (FRAME_IDS - 1)];
+        Snapshot result;
+        result.attempts = entry.attempts.load(std::memory_order_relaxed);
+        result.successes = entry.successes.load(std::memory_order_relaxed);
+        result.timeouts = entry.timeouts.load(std::memory_order_relaxed);
+        result.checksumErrors = entry.checksumErrors.load(std::memory_order_relaxed);
+        result.readbackMismatches = entry.readbackMismatches.load(std::memory_order_relaxed);
+        result.headErrors = entry.headErrors.load(std::memory_order_relaxed);
+        if (result.successes) {
+            result.latencyMin_us = entry.latencyMin_us.load(std::memory_order_relaxed);
+            result.latencyMean_us = entry.latencySum_us.load(std::memory_order_relaxed) / result.successes;
+            result.latencyMax_us = entry.latencyMax_us.load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    /// @brief counters of all frame IDs
+    void snapshot(Table &table) const
+    {
+        for (size_t id = 0; id < FRAME_IDS; ++id) {
+            table[id] = snapshot(static_cast<uint8_t>(id));
+        }
+    }
+
+    void reset(const uint8_t frameID)
+    {
+        Entry &entry = entries[frameID & (FRAME_IDS - 1)];
+        entry.attempts.store(0, std::memory_order_relaxed);
+        entry.successes.store(0, std::memory_order_relaxed);
+        entry.timeouts.store(0, std::memory_order_relaxed);
+        entry.checksumErrors.store(0, std::memory_order_relaxed);
+        entry.readbackMismatches.store(0, std::memory_order_relaxed);
+        entry.headErrors.store(0, std::memory_order_relaxed);
+        entry.latencySum_us.store(0, std::memory_order_relaxed);
+        entry.latencyMin_us.store(UINT32_MAX, std::memory_order_relaxed);
+        entry.latencyMax_us.store(0, std::memory_order_relaxed);
+    }
+
+    void reset()
+    {
+        for (size_t id = 0; id < FRAME_IDS; ++id) {
+            reset(static_cast<uint8_t>(id));
+        }
+    }
+
+private:
+    struct Entry {
+        std::atomic<uint32_t> attempts {0};
+        std::atomic<uint32_t> successes {0};
+        std::atomic<uint32_t> timeouts {0};
+        std::atomic<uint32_t> checksumErrors {0};
+        std::atomic<uint32_t> readbackMismatches {0};
+        std::atomic<uint32_t> headErrors {0};
+        std::atomic<uint32_t> latencySum_us {0};
+        std::atomic<uint32_t> latencyMin_us {UINT32_MAX};
+        std::atomic<uint32_t> latencyMax_us {0};
+    };
+
+    std::array<Entry, FRAME_IDS> entries {};
+};
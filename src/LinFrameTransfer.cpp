@@ -12,24 +12,22 @@
     #include "../test/mock_Arduino.h"
     #include "../test/mock_millis.h"
     #include "../test/mock_delay.h"
+    #include "../test/mock_micros.h"
 #else
     #include <Arduino.h>
 #endif
 
+#include <array>
 #include <optional>
 #include <vector>
 #include <numeric>
-
-enum class debugLevel {
-    none = 0,
-    error,
-    verbose
-};
-
-constexpr debugLevel debug = debugLevel::verbose;
+#include <algorithm>
 
 constexpr auto timeout_ReadFrame = 50; // ms
 
+// break, sync, PID, data, checksum
+constexpr size_t frameBytes_max = 3 + LinFrameTransfer::FRAME_DATA_LENGTH_MAX + 1;
+
 class FrameReader {
 public:
     enum class State {
@@ -41,40 +39,46 @@ public:
         FrameComplete
     };
 
-    using ChecksumFunction = uint8_t(*)(const uint8_t protectedID, const std::vector<uint8_t>& data);
+    using ChecksumFunction = uint8_t(*)(const uint8_t protectedID, const uint8_t* data, const size_t length);
 
 private:
     State state;
     uint8_t protectedID;
     uint8_t len; // max. value does also protect of overflow
-    std::vector<uint8_t> rxData;
+    uint8_t* rxData; // provided by the caller, len bytes
+    size_t rxCount = 0;
     ChecksumFunction getChecksum;
-    Stream& debugStream;
+    LinLog& logger;
+    LinBusTrace& trace;
 
 public:
+    // errors seen while waiting for the frame (frameStats)
+    uint8_t headErrors = 0;         // sync or PID mismatch after a break
+    uint8_t checksumErrors = 0;
+
     FrameReader(
         const uint8_t PID,
+        uint8_t* buffer,
         uint8_t expectedDataLength, // max. value does also protect of overflow
         ChecksumFunction checksumFunc,
-        Stream& debugStream
+        LinLog& logger,
+        LinBusTrace& trace
     ):
         protectedID(PID),
         len(expectedDataLength),
+        rxData(buffer),
         state(State::WaitForBreak),
         getChecksum(checksumFunc),
-        debugStream(debugStream)
-    {
-        rxData.reserve(expectedDataLength);
-    }
+        logger(logger),
+        trace(trace)
+    {}
 
     void reset()
     {
-        if constexpr (debug >= debugLevel::verbose) {
-            debugStream.println("FrameReader: Reset");
-        }
+        logger.logRepeated(LinLogLevel::Verbose, LinLogEvent::FrameReaderReset, protectedID & LinFrameTransfer::FRAME_ID_MASK);
 
         state = State::WaitForBreak;
-        rxData.clear();
+        rxCount = 0;
     }
 
     inline bool hasHead()
@@ -82,14 +86,30 @@ public:
         return state >= State::WaitForData;
     }
 
+    inline bool isWaitingForResponse()
+    {
+        return (state == State::WaitForData) && (0 == rxCount);
+    }
+
     inline bool isFinish()
     {
         return state == State::FrameComplete;
     }
 
-    std::vector<uint8_t> getData()
+    /// @brief count of bytes, which complete the frame at the earliest
+    /// @details reading no more bytes than this never consumes a byte of the following frame
+    size_t getBytesMissing() const
     {
-        return rxData;
+        size_t head = 0;
+        switch (state) {
+        case State::WaitForBreak:   head = 3; break;
+        case State::WaitForSync:    head = 2; break;
+        case State::WaitForPID:     head = 1; break;
+        case State::FrameComplete:  return 0;
+        default:                    break;
+        }
+        const size_t data = (State::WaitForChkSum == state) ? 0 : len - rxCount;
+        return head + data + 1;
     }
 
     void processByte(const uint8_t newByte)
@@ -106,6 +126,7 @@ public:
             {
                 state = State::WaitForPID;
             } else {
+                headErrors++;
                 reset();
             }
             break;
@@ -113,15 +134,22 @@ public:
         case State::WaitForPID:
             if (newByte == protectedID)
             {
+                LIN_TRACE_STAGE(EchoDone);
                 state = State::WaitForData;
             } else {
+                headErrors++;
                 reset();
             }
             break;
 
         case State::WaitForData:
-            rxData.push_back(newByte);
-            if (rxData.size() >= len) // does also protect of overflow
+            if (0 == rxCount) {
+                LIN_TRACE_STAGE(FirstResponseByte);
+            }
+            if (rxCount < len) {
+                rxData[rxCount++] = newByte;
+            }
+            if (rxCount >= len) // does also protect of overflow
             {
                 state = State::WaitForChkSum;
             }
@@ -129,54 +157,92 @@ public:
         
         case State::WaitForChkSum:
             if (!getChecksum) {
-                if constexpr (debug >= debugLevel::error) {
-                    debugStream.println("FrameReader: Missing checksum function");
-                }
+                logger.log(LinLogLevel::Error, LinLogEvent::ChecksumFunctionMissing);
                 reset();
             }
-            uint8_t expectedChecksum = getChecksum(protectedID, rxData);
+            uint8_t expectedChecksum = getChecksum(protectedID, rxData, rxCount);
             bool checksum_isValid = (newByte == expectedChecksum);
             if (checksum_isValid)
             {
                 // success: frame completely received
+                LIN_TRACE_STAGE(Checksum);
                 state = State::FrameComplete;
-                if constexpr (debug >= debugLevel::verbose) {
-                    printRawFrame(protectedID, rxData, newByte, expectedChecksum);
-                    debugStream.println("FrameReader: Frame valid");
-                }
+                logger.log(LinLogLevel::Verbose, LinLogEvent::FrameValid,
+                    protectedID, newByte, LinLog::Bytes{rxData, rxCount});
             } else {
                 // checksum missmatch
-                if constexpr (debug >= debugLevel::error) {
-                    printRawFrame(protectedID, rxData, newByte, expectedChecksum);
-                }
+                checksumErrors++;
+                logger.logRepeated(LinLogLevel::Error, LinLogEvent::ChecksumMismatch, protectedID & LinFrameTransfer::FRAME_ID_MASK,
+                    protectedID, newByte, expectedChecksum, LinLog::Bytes{rxData, rxCount});
                 reset();
             }
         }
     }
+};
 
-    void printRawFrame(const uint8_t protectedID, const std::vector<uint8_t>& data, uint8_t rxChecksum, uint8_t expectedChecksum)
+/// @brief compares the readback of a written frame with its TX bytes, byte by byte as received
+/// @details bytes before the break are skipped, afterwards the first deviating byte (bit error or collision)
+/// fails the frame immediately. Nothing is copied, the TX data are referenced.
+class EchoComparator {
+public:
+    enum class Result {
+        Pending,
+        Match,
+        Mismatch
+    };
+
+    EchoComparator(const uint8_t protectedID, const std::vector<uint8_t>& data, const uint8_t checksum) :
+        protectedID(protectedID),
+        data(data),
+        checksum(checksum),
+        frameLength(3 + (data.empty() ? 0 : data.size() + 1))
+    {}
+
+    /// @brief count of bytes, which complete the readback at the earliest
+    size_t getBytesMissing() const
     {
-        debugStream.print(" --- FID ");
-        debugStream.print(protectedID & LinFrameTransfer::FRAME_ID_MASK, HEX);
-        debugStream.print("h        = 55|");
-        debugStream.print(protectedID, HEX);
-        debugStream.print("|");
+        return frameLength - position;
+    }
 
-        for (uint8_t byte: data)
-        {
-            debugStream.print(byte, HEX);
-            debugStream.print(".");
+    Result processByte(const uint8_t newByte)
+    {
+        if (0 == position) {
+            // discard all data until break
+            if (newByte == LinFrameTransfer::BREAK_FIELD) {
+                position++;
+            }
+            return Result::Pending;
         }
-        debugStream.print("\b|");
-        debugStream.print(rxChecksum, HEX);
 
-        if (rxChecksum != expectedChecksum)
-        {
-            debugStream.print(" Checksum mismatch, expected ");
-            debugStream.print(expectedChecksum, HEX);
+        if (newByte != getExpected()) {
+            if (position < 3) {
+                // sync or PID mismatch: preceding 0x00 was not our break (stale byte, noise), search again
+                position = (newByte == LinFrameTransfer::BREAK_FIELD) ? 1 : 0;
+                return Result::Pending;
+            }
+            // bit error or collision within our frame
+            return Result::Mismatch;
         }
 
-        debugStream.println();
+        position++;
+        return (position == frameLength) ? Result::Match : Result::Pending;
+    }
+
+private:
+    const uint8_t protectedID;
+    const std::vector<uint8_t>& data;
+    const uint8_t checksum;
+    const size_t frameLength;
+    size_t position = 0; // bytes matched, including break
+
+    uint8_t getExpected() const
+    {
+        switch (position) {
+        case 1:  return LinFrameTransfer::SYNC_FIELD;
+        case 2:  return protectedID;
+        default: break;
+        }
+        return (position < frameLength - 1) ? data[position - 3] : checksum;
     }
 };
 
@@ -185,98 +251,119 @@ public:
 /// @brief write a LIN2.0 frame to the lin-bus. no request for any node response on the bus.
 /// @details write LIN Frame (Break, Synk, PID, Data, Checksum) to the Bus, and hope some node will recognize this
 /// - Checksum Calculations regarding LIN 2.x
-/// - The data of this frame is 'expectedDataLength' long and incuded in the LinFrameTransfer::LinMessage[] array
-/// - use writeReadback_verify or writeReadback_throw to control readback and error handling 
+/// - readback and error handling by the policy of the frame ID (see setReadbackPolicy)
 /// @param FrameID ID of frame (will be converted to protected ID)
-/// @param expectedDataLength count of data within the LinMessage array (containing only the data) should be transmitted
+/// @param data data of frame, no data: head only
 bool LinFrameTransfer::writeFrame(const uint8_t frameID, const std::vector<uint8_t>& data)
 {
-    if (data.size() == 0) {
-        return writeEmptyFrame(frameID);
+    return writeFrame(frameID, data, getReadbackPolicy(frameID));
+}
+
+/// @brief write a LIN2.0 frame to the lin-bus, readback handled by the given policy
+/// @details Discard and Skip do not recognize a bit error or collision, it has to be detected
+/// by the protocol above (e.g. response of the receiver). Used to stream frames back-to-back.
+/// @param FrameID ID of frame (will be converted to protected ID)
+/// @param data data of frame, no data: head only
+/// @param policy readback of this frame (Default: policy of the instance)
+/// @return frame was written (and verified)
+bool LinFrameTransfer::writeFrame(const uint8_t frameID, const std::vector<uint8_t>& data, ReadbackPolicy policy)
+{
+    if (ReadbackPolicy::Default == policy) {
+        policy = readbackPolicy;
     }
 
     const uint8_t protectedID { getProtectedID(frameID) };
-
-    // TX Full Frame
-    writeFrameHead(protectedID);
-    for (const uint8_t& byte : data) {
-        driver.write(byte);
+    // head + data + checksum
+    const size_t frameBytes = 3 + (data.empty() ? 0 : data.size() + 1);
+
+    // TX Full Frame (or Frame Head)
+    if (data.empty()) {
+        writeFrameHead(protectedID);
+    } else {
+        writeFrameBytes(protectedID, data);
     }
 
-    uint8_t chksum = getChecksumLin2x(protectedID, data);
-    driver.write(chksum);
-
     // ensure request is avaliable for receiver
     driver.flush();
-
-    // Do readback written bytes and verify
-    if constexpr (writeReadback_verify) {
-        // RX copy of our TX (Full Frame)
-        auto result = receiveFrameExtractData(protectedID, data.size());
-
-        // verify if frame was received
-        if (!result) {
-            // failed, caused by timeout (debug was printed)
-            return false;
-        }
-
-        // verify rx data == tx data
-        if (result.value() != data) {
-            if constexpr (debug >= debugLevel::error) {
-                debugStream.print(" writeFrame, readback failed");
-            }
+    LIN_TRACE_STAGE(Flush);
+
+    ReadbackStats &stats = readbackStats[static_cast<size_t>(policy) - 1];
+    stats.frames++;
+
+    switch (policy) {
+    case ReadbackPolicy::Skip:
+        // readback is purged before the next frame
+        readbackSkipped += frameBytes;
+        frameStats.record(frameID, LinFrameStats::Outcome::Unverified);
+        LIN_TRACE_STAGE(Complete);
+        return true;
+
+    case ReadbackPolicy::Discard:
+        // readback of this frame as far as received, the rest (e.g. delayed by the RX FIFO timeout of the UART)
+        // is purged before the next frame, a missing echo is counted there
+        readbackDeferred += frameBytes - discardReadback(frameBytes);
+        frameStats.record(frameID, LinFrameStats::Outcome::Unverified);
+        LIN_TRACE_STAGE(Complete);
+        return true;
+
+    default:
+        // RX copy of our TX, compared while received
+        if (!receiveReadback(protectedID, data)) {
+            // failed, caused by bit error or timeout (recorded in logger, printed by drainLog())
+            stats.errors++;
             return false;
         }
+        LIN_TRACE_STAGE(Complete);
+        return true;
     }
+}
 
-    // discard written bytes
-    if constexpr (writeReadback_throw)
-    {
-        // remove bytes from buffer (head + data + checksum)
-        int frameBytes = 3 + data.size() + 1;
-        for (auto i=0; i<frameBytes; ++i) {
-            driver.read();
-        }
-    }
-
-    return true;
+/// @brief format the recorded log events into debugStream, outside of the bus timing (e.g. idle loop or background task)
+/// @param max count of events at most
+/// @return count of events formatted
+size_t LinFrameTransfer::drainLog(const size_t max)
+{
+    return logger.drain(debugStream, max);
 }
 
 bool LinFrameTransfer::writeEmptyFrame(const uint8_t frameID)
 {
-    const uint8_t protectedID { getProtectedID(frameID) };
-
-    // TX Frame Head
-    writeFrameHead(protectedID);
-    // no data
-    // no checksum
+    // TX Frame Head, no data, no checksum
+    return writeFrame(frameID, {});
+}
 
-    // ensure request is avaliable for receiver
-    driver.flush();
+/// @brief Readback of written frames for all frame IDs without own policy
+/// @param policy Verify (default), Discard or Skip
+void LinFrameTransfer::setReadbackPolicy(const ReadbackPolicy policy)
+{
+    readbackPolicy = (ReadbackPolicy::Default == policy) ? ReadbackPolicy::Verify : policy;
+}
 
-    // Do readback written bytes and verify
-    if constexpr (writeReadback_verify)
-    {
-        auto result = receiveFrameHead(protectedID);
+/// @brief Readback of written frames of a frame ID
+/// @param frameID ID of frame
+/// @param policy Verify, Discard, Skip or Default (policy of the instance)
+void LinFrameTransfer::setReadbackPolicy(const uint8_t frameID, const ReadbackPolicy policy)
+{
+    readbackPolicies[frameID & FRAME_ID_MASK] = policy;
+}
 
-        // verify if frame was received
-        if (!result) {
-            // failed, caused by timeout (debug was printed)
-            return false;
-        }
-    }
+LinFrameTransfer::ReadbackPolicy LinFrameTransfer::getReadbackPolicy(const uint8_t frameID) const
+{
+    const ReadbackPolicy policy = readbackPolicies[frameID & FRAME_ID_MASK];
+    return (ReadbackPolicy::Default == policy) ? readbackPolicy : policy;
+}
 
-    // discard written bytes
-    if constexpr (writeReadback_throw)
-    {
-        // remove bytes from buffer (head + data + checksum)
-        int frameBytes = 3;
-        for (auto i=0; i<frameBytes; ++i) {
-            driver.read();
-        }
-    }
+/// @brief Frames written and errors caught by a policy
+/// @details Verify: bit error, collision or timeout. Discard: echo was missing.
+/// Skip: purged bytes did not match the skipped readback (missing echo or noise).
+const LinFrameTransfer::ReadbackStats& LinFrameTransfer::getReadbackStats(const ReadbackPolicy policy) const
+{
+    return readbackStats[static_cast<size_t>((ReadbackPolicy::Default == policy) ? readbackPolicy : policy) - 1];
+}
 
-    return true;
+void LinFrameTransfer::resetReadbackStats()
+{
+    readbackStats = {};
 }
 
 /// @brief reads data from a lin node by requesting a specific FrameID
@@ -288,25 +375,151 @@ bool LinFrameTransfer::writeEmptyFrame(const uint8_t frameID)
 /// @returns rx data on success, otherwise std::nullopt
 std::optional<std::vector<uint8_t>> LinFrameTransfer::readFrame(const uint8_t frameID, uint8_t expectedDataLength)
 {
-    const uint8_t protectedID { getProtectedID(frameID) };
+    const FrameHead head { prepareFrameHead(frameID, expectedDataLength) };
 
     // TX only Frame Head
-    writeFrameHead(protectedID);
+    sendFrameHead(head);
 
     // ensure request is avaliable for receiver
     driver.flush();
+    LIN_TRACE_STAGE(Flush);
 
     // RX loopback of our TX AND response from receiver
-    auto result = receiveFrameExtractData(protectedID, expectedDataLength);
+    return receiveResponse(head);
+}
 
-    return result;
+/// @brief Prepare the header of a frame once, to send it without delay at its slot
+/// @param FrameID FrameID (will be converted to ProtectedID)
+/// @param expectedDataLength Length of data bytes [0..8] (default=8) of the response
+LinFrameTransfer::FrameHead LinFrameTransfer::prepareFrameHead(const uint8_t frameID, const uint8_t expectedDataLength)
+{
+    return {static_cast<uint8_t>(frameID & FRAME_ID_MASK), getProtectedID(frameID), expectedDataLength};
+}
+
+/// @brief Send a prepared header, returns without waiting for its transmission
+/// @details the response is read by receiveResponse(), e.g. after the result of the previous frame was processed
+void LinFrameTransfer::sendFrameHead(const FrameHead& head)
+{
+    writeFrameHead(head.protectedID);
+}
+
+/// @brief Receive the loopback of a sent header and the response of the node
+/// @returns rx data on success, otherwise std::nullopt
+std::optional<std::vector<uint8_t>> LinFrameTransfer::receiveResponse(const FrameHead& head)
+{
+    return receiveFrameExtractData(head.protectedID, head.dataLength);
+}
+
+/// @brief Read a list of frames back-to-back, e.g. all frames of a sensor
+/// @details sequential, as a loop of readFrame(): the header of a frame is sent after the previous frame
+/// is complete (or timed out). The results land in the arena, nothing is allocated.
+/// @param requests frame IDs and expected lengths, read in this order (limited by the results of the arena)
+/// @param count count of requests
+/// @param arena results and data, cleared first
+/// @return count of frames with valid response
+size_t LinFrameTransfer::readFrames(const FrameRequest* requests, const size_t count, ResultArena& arena)
+{
+    arena.clear();
+    size_t succeeded = 0;
+
+    for (size_t i = 0; (i < count) && (arena.count < arena.results.size()); ++i)
+    {
+        const FrameHead head { prepareFrameHead(requests[i].frameID, requests[i].dataLength) };
+        ResultArena::Result &result = arena.results[arena.count++];
+        result = {head.frameID, FrameStatus::Overflow, 0, arena.used};
+
+        if (arena.used + head.dataLength > arena.bytes.size()) {
+            continue;
+        }
+
+        sendFrameHead(head);
+        result.status = receiveFrameData(head.protectedID, arena.bytes.data() + arena.used, head.dataLength);
+        if (FrameStatus::Ok == result.status) {
+            result.length = head.dataLength;
+            arena.used += head.dataLength;
+            succeeded++;
+        }
+    }
+
+    // each break flushes the frame before, the last frame is flushed here: the UART is idle on return
+    driver.flush();
+    return succeeded;
 }
 
 void LinFrameTransfer::writeFrameHead(uint8_t protectedID)
 {
     writeBreak();
-    driver.write(SYNC_FIELD);
-    driver.write(protectedID);
+    const uint8_t head[] = {SYNC_FIELD, protectedID};
+    driver.write(head, sizeof(head));
+    LIN_TRACE_STAGE(Header);
+}
+
+/// @brief write a frame (head, data and checksum) by a single bulk write after the break
+/// @param protectedID protected ID of the frame
+/// @param data data of the frame, no data: head only
+void LinFrameTransfer::writeFrameBytes(const uint8_t protectedID, const std::vector<uint8_t>& data)
+{
+    writeBreak();
+
+    if (data.size() > FRAME_DATA_LENGTH_MAX)
+    {
+        // non compliant frame (more than 8 data bytes): head, data and checksum are written separately
+        const uint8_t head[] = {SYNC_FIELD, protectedID};
+        driver.write(head, sizeof(head));
+        driver.write(data.data(), data.size());
+        driver.write(getChecksumLin2x(protectedID, data));
+        LIN_TRACE_STAGE(Header);
+        return;
+    }
+
+    // sync, PID, data, checksum
+    std::array<uint8_t, frameBytes_max - 1> frame;
+    frame[0] = SYNC_FIELD;
+    frame[1] = protectedID;
+    size_t frameLength = 2;
+    if (!data.empty()) {
+        std::copy(data.begin(), data.end(), frame.begin() + frameLength);
+        frameLength += data.size();
+        frame[frameLength++] = getChecksumLin2x(protectedID, data);
+    }
+    driver.write(frame.data(), frameLength);
+    LIN_TRACE_STAGE(Header);
+}
+
+/// @brief remove the readback of a written frame from the rx buffer by bulk reads, without waiting for missing bytes
+/// @param frameBytes count of bytes (head + data + checksum)
+/// @return count of bytes removed
+size_t LinFrameTransfer::discardReadback(const size_t frameBytes)
+{
+    std::array<uint8_t, frameBytes_max> discard;
+    size_t removed = 0;
+    int available = 0;
+    while ((removed < frameBytes) && ((available = driver.available()) > 0))
+    {
+        const size_t count = std::min({frameBytes - removed, static_cast<size_t>(available), discard.size()});
+        removed += driver.readBytes(discard.data(), count);
+    }
+    return removed;
+}
+
+/// @brief remove the skipped or deferred readback of previous frames (and all other received bytes) from the rx buffer
+void LinFrameTransfer::purgeReadback()
+{
+    std::array<uint8_t, frameBytes_max> discard;
+    size_t removed = 0;
+    int available = 0;
+    while ((available = driver.available()) > 0)
+    {
+        removed += driver.readBytes(discard.data(), std::min(static_cast<size_t>(available), discard.size()));
+    }
+
+    if (removed != readbackSkipped + readbackDeferred) {
+        // missing echo or noise on the bus
+        const ReadbackPolicy policy = readbackSkipped ? ReadbackPolicy::Skip : ReadbackPolicy::Discard;
+        readbackStats[static_cast<size_t>(policy) - 1].errors++;
+    }
+    readbackSkipped = 0;
+    readbackDeferred = 0;
 }
 
 /// @brief Send a Break for introduction of a Frame
@@ -314,25 +527,67 @@ void LinFrameTransfer::writeFrameHead(uint8_t protectedID)
 size_t LinFrameTransfer::writeBreak()
 {
     // Goal: Brake Length (dominant + delimiter) = min 14 Tbit (see 2.8.1)
-    // This is done by sending a Byte (0x00) + Stop Bit by using half baud rate
+    // generated by the selected strategy, default: a Byte (0x00) + Stop Bit at half baud rate
 
+    LIN_TRACE_BEGIN(Frame);
     driver.flush();
-    // configure to half baudrate --> a t_bit will be doubled
-    driver.updateBaudRate(baud >> 1);
-    // write 0x00, including Stop-Bit (=1),
-    // qualifies when writing in slow motion like a Break in normal speed
-    size_t result = driver.write(BREAK_FIELD);
-    // ensure this was send
-    driver.flush();
-    // restore normal speed
-    driver.updateBaudRate(baud);
+    frameStart_us = micros();
+    // summaries of error storms, as soon as their window has elapsed
+    logger.flushRepeated(frameStart_us);
+    if (readbackSkipped || readbackDeferred) {
+        purgeReadback();
+    }
+    const size_t result = getBreakStrategy().send(driver, baud);
+    LIN_TRACE_STAGE(Break);
     return result;
 }
 
+/// @brief Select the cheapest break strategy, which meets LIN 2.2A Spec 2.3.1.1
+/// @details sends calibration breaks (without frame) on an idle bus, their readback is discarded.
+///          Unsupported strategies, failed breaks or breaks out of spec are not selected.
+/// @param candidates strategies in order of preference on equal cost (the default half baud break may be included)
+/// @param samples count of breaks per strategy
+/// @return selected strategy, nullptr if none qualified (strategy unchanged)
+LinBreakStrategy* LinFrameTransfer::selectBreakStrategy(std::initializer_list<LinBreakStrategy*> candidates, const size_t samples)
+{
+    LinBreakStrategy* selected = nullptr;
+    uint8_t candidate = 0;
+
+    for (LinBreakStrategy* strategy : candidates)
+    {
+        const uint8_t index = candidate++;
+        if (!strategy || !strategy->isSupported()) {
+            continue;
+        }
+
+        strategy->resetCost();
+        bool qualified = true;
+        for (size_t i = 0; (i < samples) && qualified; ++i)
+        {
+            driver.flush();
+            qualified = (strategy->send(driver, baud) == 1) && strategy->meetsSpec(baud);
+            driver.flush();
+            discardReadback(1);
+        }
+
+        logger.log(LinLogLevel::Verbose, LinLogEvent::BreakStrategyCost,
+            index, static_cast<uint8_t>(qualified), strategy->getMeanCost());
+
+        if (qualified && (samples > 0) && (!selected || (strategy->getMeanCost() < selected->getMeanCost()))) {
+            selected = strategy;
+        }
+    }
+
+    if (selected) {
+        setBreakStrategy(*selected);
+    }
+    return selected;
+}
+
 /// get Protected ID by calculating parity bits and combine with Frame ID
 /// @param frameID (0x00-0x3F) to be converted (avaliable parity bits will be overwritten)
 /// @return Protected ID
-constexpr uint8_t LinFrameTransfer::getProtectedID(const uint8_t frameID)
+uint8_t LinFrameTransfer::getProtectedID(const uint8_t frameID)
 {
     // calc Parity Bit 0
     uint8_t p0 = bitRead(frameID, 0) ^ bitRead(frameID, 1) ^ bitRead(frameID, 2) ^ bitRead(frameID, 4);
@@ -346,71 +601,135 @@ constexpr uint8_t LinFrameTransfer::getProtectedID(const uint8_t frameID)
 }
 
 /// @brief reads a full frame from bus.
-/// discard all data, until break, sync, PID, data, chksum valid is OR timeout occurs
 /// @param protectedID expected ProtectedID; only success if matched
 /// @param expectedDataLength expected lenght of data; only success if matched
 /// @return vector of received data (may 0 byte) OR fail
 std::optional<std::vector<uint8_t>> LinFrameTransfer::receiveFrameExtractData(uint8_t protectedID, size_t expectedDataLength)
 {
-    FrameReader frameReader(protectedID, expectedDataLength, getChecksumLin2x, debugStream);
+    std::vector<uint8_t> data(expectedDataLength);
+    if (FrameStatus::Ok != receiveFrameData(protectedID, data.data(), expectedDataLength)) {
+        return {};
+    }
+    return data;
+}
 
-    auto timeout_stop = millis() + timeout_ReadFrame;
+/// @brief reads a full frame from bus into a buffer of the caller, nothing is allocated.
+/// discard all data, until break, sync, PID, data, chksum valid is OR timeout occurs
+/// @param protectedID expected ProtectedID; only success if matched
+/// @param data buffer of expectedDataLength bytes, content is undefined on failure
+/// @param expectedDataLength expected lenght of data; only success if matched
+/// @return Ok, NoResponse (timeout) or Invalid (response received, but invalid)
+LinFrameTransfer::FrameStatus LinFrameTransfer::receiveFrameData(const uint8_t protectedID, uint8_t* data, const size_t expectedDataLength)
+{
+    FrameReader frameReader(protectedID, data, expectedDataLength, getChecksumLin2x, logger, trace);
+
+    const auto timeout_frame = millis() + timeout_ReadFrame;
+    auto timeout_stop = timeout_frame;
+    bool responseSlot = false;
+    bool responseReceived = false;
     while ((millis() < timeout_stop) && (!frameReader.isFinish()))
     {
+        // header is complete: a silent node is recognized by an empty response slot
+        if (timeout_NoResponse && !responseSlot && frameReader.isWaitingForResponse())
+        {
+            responseSlot = true;
+            timeout_stop = std::min<decltype(timeout_stop)>(timeout_frame, millis() + timeout_NoResponse);
+        }
+        // response has started: complete frame within the regular timeout
+        if (responseSlot && !frameReader.isWaitingForResponse())
+        {
+            responseSlot = false;
+            timeout_stop = timeout_frame;
+        }
+
         // ensure timeout is checked, while no data are avaliable
-        if (!driver.available())
+        const int available = driver.available();
+        if (available <= 0)
         {
             continue;
         }
 
-        // get byte, verify and use (or may discard)
-        uint8_t newByte = driver.read();
-        frameReader.processByte(newByte);
+        // get bytes of this frame only (bulk), verify and use (or may discard)
+        std::array<uint8_t, frameBytes_max> rxBytes;
+        const size_t count = driver.readBytes(rxBytes.data(),
+            std::min({static_cast<size_t>(available), frameReader.getBytesMissing(), rxBytes.size()}));
+        for (size_t i = 0; i < count; ++i)
+        {
+            responseReceived |= frameReader.hasHead();
+            frameReader.processByte(rxBytes[i]);
+        }
     }
 
+    const uint8_t frameID = protectedID & FRAME_ID_MASK;
     if (!frameReader.isFinish())
     {
-        // rx of valid frame failed!
-        if constexpr (debug >= debugLevel::error) {
-            debugStream.print("timeout: no valid frame received\n");
+        if (responseReceived) {
+            // response was not empty, but invalid
+            frameErrors++;
         }
-        return {};
+        frameStats.record(frameID,
+            frameReader.checksumErrors ? LinFrameStats::Outcome::ChecksumError :
+            frameReader.headErrors ? LinFrameStats::Outcome::HeadError : LinFrameStats::Outcome::Timeout);
+        // rx of valid frame failed!
+        logger.logRepeated(LinLogLevel::Error, LinLogEvent::FrameTimeout, frameID, protectedID);
+        LIN_TRACE_STAGE(Complete);
+        return responseReceived ? FrameStatus::Invalid : FrameStatus::NoResponse;
     }
 
-    return frameReader.getData();
+    frameStats.record(frameID, LinFrameStats::Outcome::Success, micros() - frameStart_us);
+    LIN_TRACE_STAGE(Complete);
+    return FrameStatus::Ok;
 }
 
-/// @brief reads a frame head - no frame response - from bus.
-/// discard all data, until break, sync, PID OR timeout occurs
-/// @param protectedID expected ProtectedID; only success if matched
-/// @return success
-bool LinFrameTransfer::receiveFrameHead(uint8_t protectedID)
+/// @brief verifies the readback of a written frame, each byte is compared as soon as it is received
+/// discard all data until break, abort at the first byte deviating from the TX bytes OR timeout occurs
+/// @param protectedID ProtectedID of the written frame
+/// @param data data of the written frame (may 0 byte: head only)
+/// @return readback matches
+bool LinFrameTransfer::receiveReadback(const uint8_t protectedID, const std::vector<uint8_t>& data)
 {
-    FrameReader frameReader(protectedID, 0, nullptr, debugStream);
+    EchoComparator echo(protectedID, data, data.empty() ? 0 : getChecksumLin2x(protectedID, data));
 
+    auto result = EchoComparator::Result::Pending;
     auto timeout_stop = millis() + timeout_ReadFrame;
-    while ((millis() < timeout_stop) && (!frameReader.hasHead()))
+    while ((millis() < timeout_stop) && (EchoComparator::Result::Pending == result))
     {
         // ensure timeout is checked, while no data are avaliable
-        if (!driver.available())
+        const int available = driver.available();
+        if (available <= 0)
         {
             continue;
         }
 
-        // get byte, verify and use (or may discard)
-        uint8_t newByte = driver.read();
-        frameReader.processByte(newByte);
+        // get bytes of this frame only (bulk), compare until the first mismatch
+        std::array<uint8_t, frameBytes_max> rxBytes;
+        const size_t count = driver.readBytes(rxBytes.data(),
+            std::min({static_cast<size_t>(available), echo.getBytesMissing(), rxBytes.size()}));
+        for (size_t i = 0; (i < count) && (EchoComparator::Result::Pending == result); ++i)
+        {
+            result = echo.processByte(rxBytes[i]);
+        }
     }
 
-    if (!frameReader.hasHead())
+    if (EchoComparator::Result::Mismatch == result)
+    {
+        // remove the rest of this frame, as far as received
+        discardReadback(echo.getBytesMissing() - 1);
+        frameStats.record(protectedID & FRAME_ID_MASK, LinFrameStats::Outcome::ReadbackMismatch);
+        logger.logRepeated(LinLogLevel::Error, LinLogEvent::ReadbackMismatch, protectedID & FRAME_ID_MASK, protectedID);
+        return false;
+    }
+
+    if (EchoComparator::Result::Match != result)
     {
         // rx of valid frame failed!
-        if constexpr (debug >= debugLevel::error) {
-            debugStream.print("timeout: no valid frame head received\n");
-        }
+        frameStats.record(protectedID & FRAME_ID_MASK, LinFrameStats::Outcome::Timeout);
+        logger.logRepeated(LinLogLevel::Error, LinLogEvent::ReadbackTimeout, protectedID & FRAME_ID_MASK, protectedID);
         return false;
     }
 
+    frameStats.record(protectedID & FRAME_ID_MASK, LinFrameStats::Outcome::Success, micros() - frameStart_us);
+    LIN_TRACE_STAGE(EchoDone);
     return true;
 }
 
@@ -419,6 +738,16 @@ bool LinFrameTransfer::receiveFrameHead(uint8_t protectedID)
 /// @param data vector of n Data bytes
 /// @return calculated checksum
 uint8_t LinFrameTransfer::getChecksumLin2x(const uint8_t protectedID, const std::vector<uint8_t>& data)
+{
+    return getChecksumLin2x(protectedID, data.data(), data.size());
+}
+
+/// @brief calculates Classic Checksum (Lin2.x) WITH ProtectedID except for FID >= Master Request
+/// @param protectedID expected ProtectedID
+/// @param data n Data bytes
+/// @param length count of data bytes
+/// @return calculated checksum
+uint8_t LinFrameTransfer::getChecksumLin2x(const uint8_t protectedID, const uint8_t* data, const size_t length)
 {
     // REMARK: since FrameID 0x3E and 0x3F shall not be used (see 2.3.3.5)
     // we do not distinct here and use classic checksum (incorrect)
@@ -427,14 +756,14 @@ uint8_t LinFrameTransfer::getChecksumLin2x(const uint8_t protectedID, const std:
         // Classic Checksum (see 2.3.1.5)
         // FID 0x3C Master Request
         // FID 0x3D Slave Request
-        return getChecksumEnhanced(0x00, data);
+        return getChecksumEnhanced(0x00, data, length);
     }
 
     // Enhanced Checksum
     // FID 0x00..0x3B
     // FID 0x3E reserved, incorrect according to 2.3.1.5
     // FID 0x3F reserved, incorrect according to 2.3.1.5
-    return getChecksumEnhanced(protectedID, data);
+    return getChecksumEnhanced(protectedID, data, length);
 }
 
 /// @brief calculates Classic Checksum (Lin1.3) WITH ProtectedID in ALL cases
@@ -469,13 +798,23 @@ uint8_t LinFrameTransfer::getChecksumClassic(const std::vector<uint8_t>& data)
 /// @param data vector of n Data bytes
 /// @returns calculated checksum
 uint8_t LinFrameTransfer::getChecksumEnhanced(const uint8_t protectedID, const std::vector<uint8_t>& data)
+{
+    return getChecksumEnhanced(protectedID, data.data(), data.size());
+}
+
+/// @brief Checksum calculation for LIN Frame WITH ProtectedID, see above
+/// @param protectedID initial Byte, set to 0x00, when calc Checksum for classic LIN Frame
+/// @param data n Data bytes
+/// @param length count of data bytes
+/// @returns calculated checksum
+uint8_t LinFrameTransfer::getChecksumEnhanced(const uint8_t protectedID, const uint8_t* data, const size_t length)
 {
     uint16_t sum { protectedID };
 
     // sum up all bytes (including carryover to the high byte)
-    for (const uint8_t& byte : data)
+    for (size_t i = 0; i < length; ++i)
     {
-        sum += byte;
+        sum += data[i];
     }
 
     // extract low byte and add high byte (sum of carry over)
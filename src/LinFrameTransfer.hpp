@@ -17,19 +17,36 @@
     #include <Arduino.h>
 #endif
 
+#include <array>
+#include <initializer_list>
+#include <iterator>
 #include <optional>
 #include <vector>
 
+#include "LinBreakStrategy.hpp"
+#include "LinFrameStats.hpp"
+#include "LinLog.hpp"
+#include "LinTrace.hpp"
+
 class LinFrameTransfer {
 public:
-    // Do readback written bytes and verify
-    static constexpr bool writeReadback_verify = true;
-    // Do readback written bytes and ignore
-    static constexpr bool writeReadback_throw = false;
+    // handling of the readback (echo) of written frames
+    enum class ReadbackPolicy : uint8_t {
+        Default = 0,    // policy of the instance (frame ID without own policy)
+        Verify,         // compare with the TX bytes, fail at the first mismatch or timeout
+        Discard,        // remove the readback of the frame as far as received, the rest before the next frame
+        Skip            // no readback, the rx buffer is purged before the next frame
+    };
+
+    struct ReadbackStats {
+        uint32_t frames = 0;    // frames written by the policy
+        uint32_t errors = 0;    // errors caught by the policy
+    };
 
     static constexpr uint8_t BREAK_FIELD = 0x00;
     static constexpr uint8_t SYNC_FIELD = 0x55;
     static constexpr uint8_t FRAME_ID_MASK = 0b0011'1111;
+    static constexpr size_t FRAME_DATA_LENGTH_MAX = 8;
 
     enum FRAME_ID : const uint8_t {
     //    0-50 (0x00-0x3B) are used for normal Signal/data carrying frames.
@@ -55,22 +72,143 @@ public:
     int8_t rxPin = -1;
     int8_t txPin = -1;
 
+    // early no-response detection: once the own header is received, the response has to start
+    // within this time [ms], otherwise the frame is given up (0 = disabled, wait for full timeout)
+    unsigned long timeout_NoResponse = 0;
+
+    // count of frames given up after a response was received (e.g. checksum error caused by a collision)
+    uint32_t frameErrors = 0;
+
+    // attempts, errors and latency per frame ID, may be read and reset by any task
+    LinFrameStats frameStats;
+
+    // events of the frame and transport layer, formatted by drainLog() only (level at runtime)
+    LinLog logger;
+
+    size_t drainLog(const size_t max = SIZE_MAX);
+
+    // time per stage of the frames and PDUs of this bus (-D LIN_TRACE), read by the owner of the bus
+    LinBusTrace trace;
+
     bool writeFrame(const uint8_t frameID, const std::vector<uint8_t>& data);
+    bool writeFrame(const uint8_t frameID, const std::vector<uint8_t>& data, ReadbackPolicy policy);
     bool writeEmptyFrame(const uint8_t frameID);
 
+    void setReadbackPolicy(const ReadbackPolicy policy);
+    void setReadbackPolicy(const uint8_t frameID, const ReadbackPolicy policy);
+    ReadbackPolicy getReadbackPolicy(const uint8_t frameID) const;
+    const ReadbackStats& getReadbackStats(const ReadbackPolicy policy) const;
+    void resetReadbackStats();
+
     std::optional<std::vector<uint8_t>> readFrame(const uint8_t frameID, uint8_t expectedDataLength = 8);
 
+    // header of a frame, prepared ahead of its slot (pipelined master, see LinSchedule)
+    struct FrameHead {
+        uint8_t frameID;
+        uint8_t protectedID;
+        uint8_t dataLength;
+    };
+
+    FrameHead prepareFrameHead(const uint8_t frameID, const uint8_t expectedDataLength = 8);
+    void sendFrameHead(const FrameHead& head);
+    std::optional<std::vector<uint8_t>> receiveResponse(const FrameHead& head);
+
+    // request of readFrames(): frame ID and expected length of the response
+    struct FrameRequest {
+        uint8_t frameID;
+        uint8_t dataLength = 8;
+    };
+
+    enum class FrameStatus : uint8_t {
+        Ok,
+        NoResponse,     // no response within the timeout
+        Invalid,        // response received, but invalid (e.g. checksum)
+        Overflow        // not read, data of the arena exhausted
+    };
+
+    // results of readFrames(): data of all frames in one contiguous buffer, allocated once by the constructor
+    class ResultArena {
+    public:
+        struct Result {
+            uint8_t frameID;
+            FrameStatus status;
+            uint8_t length;     // count of data bytes, 0 on failure
+            size_t offset;      // first data byte within the arena
+        };
+
+        explicit ResultArena(const size_t maxFrames, const size_t maxBytes = 0) :
+            results(maxFrames),
+            bytes(maxBytes ? maxBytes : maxFrames * FRAME_DATA_LENGTH_MAX)
+        {}
+
+        void clear() { count = 0; used = 0; }
+        size_t size() const { return count; }
+        const Result& operator[](const size_t index) const { return results[index]; }
+        const uint8_t* getData(const Result& result) const { return bytes.data() + result.offset; }
+
+    private:
+        friend class LinFrameTransfer;
+        std::vector<Result> results;
+        std::vector<uint8_t> bytes;
+        size_t count = 0;   // results of the last readFrames()
+        size_t used = 0;    // bytes of the last readFrames()
+    };
+
+    size_t readFrames(const FrameRequest* requests, const size_t count, ResultArena& arena);
+
+    template <typename Requests>
+    size_t readFrames(const Requests& requests, ResultArena& arena)
+    {
+        return readFrames(std::data(requests), std::size(requests), arena);
+    }
+
+    // break field: half baud rate by default, a native or GPIO break may be provided by the application
+    void setBreakStrategy(LinBreakStrategy &strategy) { breakStrategy = &strategy; }
+    LinBreakStrategy& getBreakStrategy() { return breakStrategy ? *breakStrategy : halfBaudBreak; }
+    LinBreakStrategy* selectBreakStrategy(std::initializer_list<LinBreakStrategy*> candidates, const size_t samples = 4);
+
+    // LIN 2.2A Spec 2.3.2 Frame slots
+    // THeader_Nominal = 34 * TBit, TResponse_Nominal = 10 * (NDataBytes + 1) * TBit
+    static constexpr uint32_t getFrameBitsNominal(const size_t dataLength)
+    {
+        return 34 + 10 * (dataLength + 1);
+    }
+
+    // LIN 2.2A Spec 2.3.2 Frame slots
+    // TResponse_Maximum = 1.4 * TResponse_Nominal, rounded up to full ms
+    unsigned long getResponseTimeMax(const size_t dataLength) const
+    {
+        const uint32_t bits = 14 * (dataLength + 1);
+        return (bits * 1000 + baud - 1) / baud;
+    }
+
 protected:
+    LinHalfBaudBreak halfBaudBreak;
+    LinBreakStrategy* breakStrategy = nullptr; // nullptr: halfBaudBreak
+
+    ReadbackPolicy readbackPolicy = ReadbackPolicy::Verify;
+    std::array<ReadbackPolicy, FRAME_ID_MASK + 1> readbackPolicies {};    // Default
+    std::array<ReadbackStats, 3> readbackStats {};                        // Verify, Discard, Skip
+    size_t readbackSkipped = 0;                                            // bytes of skipped readback, not purged yet
+    size_t readbackDeferred = 0;                                           // bytes of discarded readback, not received in time
+
+    uint32_t frameStart_us = 0;     // start of the break of the current frame (latency of frameStats)
 
-    inline void writeFrameHead(const uint8_t protectedID);
-    inline size_t writeBreak();
-    inline constexpr uint8_t getProtectedID(const uint8_t frameID);
+    void writeFrameHead(const uint8_t protectedID);
+    void writeFrameBytes(const uint8_t protectedID, const std::vector<uint8_t>& data);
+    size_t writeBreak();
+    uint8_t getProtectedID(const uint8_t frameID);
 
     std::optional<std::vector<uint8_t>> receiveFrameExtractData(uint8_t protectedID, size_t expectedDataLength);
-    bool receiveFrameHead(uint8_t protectedID);
+    FrameStatus receiveFrameData(const uint8_t protectedID, uint8_t* data, const size_t expectedDataLength);
+    bool receiveReadback(const uint8_t protectedID, const std::vector<uint8_t>& data);
+    size_t discardReadback(const size_t frameBytes);
+    void purgeReadback();
 
-    inline static uint8_t getChecksumLin2x(uint8_t protectedID, const std::vector<uint8_t>& data);
+    static uint8_t getChecksumLin2x(uint8_t protectedID, const std::vector<uint8_t>& data);
+    static uint8_t getChecksumLin2x(const uint8_t protectedID, const uint8_t* data, const size_t length);
     inline static uint8_t getChecksumLin13(const uint8_t protectedID, const std::vector<uint8_t>& data);
     inline static uint8_t getChecksumClassic(const std::vector<uint8_t>& data);
     static uint8_t getChecksumEnhanced(const uint8_t protectedID, const std::vector<uint8_t>& data);
+    static uint8_t getChecksumEnhanced(const uint8_t protectedID, const uint8_t* data, const size_t length);
 };
@@ -0,0 +1,113 @@
+// LinInventoryStorage.hpp
+//
+// Persistent storage of the node inventory (see LinNodeInventory)
+// - pluggable: the inventory is handed over as a binary blob
+// - ESP32: Non-Volatile Storage by Preferences
+// - others (e.g. native/Linux): file
+//
+// LIN Specification 2.2A
+// Source https://www.lin-cia.org/fileadmin/microsites/lin-cia.org/resources/documents/LIN_2.2A.pdf
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if defined(ARDUINO_ARCH_ESP32) && !defined(UNIT_TEST)
+    #include <Preferences.h>
+#endif
+
+class LinInventoryStorage {
+public:
+    virtual ~LinInventoryStorage() = default;
+
+    /// @brief Read the stored blob
+    /// @param blob destination
+    /// @return blob was found
+    virtual bool load(std::vector<uint8_t> &blob) = 0;
+
+    /// @brief Replace the stored blob
+    /// @param blob source
+    /// @return blob was written completely
+    virtual bool store(const std::vector<uint8_t> &blob) = 0;
+};
+
+#if defined(ARDUINO_ARCH_ESP32) && !defined(UNIT_TEST)
+
+class LinInventoryPreferences : public LinInventoryStorage {
+public:
+    LinInventoryPreferences(const char* nameSpace = "lin", const char* key = "inventory"):
+        nameSpace(nameSpace),
+        key(key)
+    {}
+
+    bool load(std::vector<uint8_t> &blob) override
+    {
+        Preferences preferences;
+        if (!preferences.begin(nameSpace, true)) {
+            return false;
+        }
+        blob.resize(preferences.getBytesLength(key));
+        bool result = !blob.empty() && (preferences.getBytes(key, blob.data(), blob.size()) == blob.size());
+        preferences.end();
+        return result;
+    }
+
+    bool store(const std::vector<uint8_t> &blob) override
+    {
+        Preferences preferences;
+        if (!preferences.begin(nameSpace, false)) {
+            return false;
+        }
+        bool result = (preferences.putBytes(key, blob.data(), blob.size()) == blob.size());
+        preferences.end();
+        return result;
+    }
+
+private:
+    const char* nameSpace;
+    const char* key;
+};
+
+#else
+
+class LinInventoryFile : public LinInventoryStorage {
+public:
+    LinInventoryFile(const std::string &path):
+        path(path)
+    {}
+
+    bool load(std::vector<uint8_t> &blob) override
+    {
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file) {
+            return false;
+        }
+        blob.clear();
+        uint8_t buffer[64];
+        size_t count;
+        while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            blob.insert(blob.end(), buffer, buffer + count);
+        }
+        std::fclose(file);
+        return !blob.empty();
+    }
+
+    bool store(const std::vector<uint8_t> &blob) override
+    {
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            return false;
+        }
+        bool result = (std::fwrite(blob.data(), 1, blob.size(), file) == blob.size());
+        result = (0 == std::fclose(file)) && result;
+        return result;
+    }
+
+private:
+    std::string path;
+};
+
+#endif
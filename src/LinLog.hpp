@@ -0,0 +1,353 @@
+// LinLog.hpp
+//
+// Deferred binary log of the frame and transport layer
+// - the hot path records an event ID and its arguments (bytes) into a ring buffer, nothing is formatted
+// - the log level is set at runtime, a disabled level costs a single load
+// - drain() formats the records as text into a Stream, called by the application (e.g. a background task)
+// - pop() provides the binary records, to be decoded elsewhere (e.g. sent to a host)
+// - a full ring drops new records and counts them, the bus is never blocked by the log
+// - repeated events (error storms) are coalesced: the first one is recorded, further ones of the same
+//   event and key (frame ID, NAD) are counted and summarized once per window
+//   ("12 frame timeouts on 0x3D in the last 1000 ms")
+//
+// Single producer (owner of the bus), single consumer (drain or pop)
+
+#pragma once
+
+#ifdef UNIT_TEST
+    #include "../test/mock_Stream.h"
+    using Stream = mock_Stream;
+    #include "../test/mock_micros.h"
+#else
+    #include <Arduino.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+enum class LinLogLevel : uint8_t {
+    None = 0,
+    Error,
+    Verbose
+};
+
+// arguments of an event, in order of recording
+enum class LinLogEvent : uint8_t {
+    FrameReaderReset,           // -
+    ChecksumFunctionMissing,    // -
+    FrameValid,                 // PID, checksum, data
+    ChecksumMismatch,           // PID, checksum, expected checksum, data
+    FrameTimeout,               // PID
+    ReadbackMismatch,           // PID
+    ReadbackTimeout,            // PID
+    BreakStrategyCost,          // index of candidate, qualified, mean cost [us] (uint32_t)
+    PduFrameMissing,            // NAD
+    PduFrameSize,               // count of data bytes
+    Repeated                    // event, key, count (uint32_t), period [ms] (uint32_t)
+};
+
+class LinLog {
+public:
+    static constexpr size_t CAPACITY = 32;      // records, power of 2
+    static constexpr size_t ARGS_MAX = 12;      // PID, 2 checksums, length and 8 data bytes
+    static constexpr size_t REPEAT_SLOTS = 8;   // events coalesced at the same time
+    static constexpr uint32_t REPEAT_WINDOW_us = 1000000;
+
+    struct Record {
+        uint32_t timestamp_us;
+        LinLogEvent event;
+        uint8_t length;                         // bytes of args used
+        std::array<uint8_t, ARGS_MAX> args;
+    };
+
+    // data bytes as argument: recorded as length followed by the bytes
+    struct Bytes {
+        const uint8_t* data;
+        size_t length;
+    };
+
+    void setLevel(const LinLogLevel value) { level.store(value, std::memory_order_relaxed); }
+    LinLogLevel getLevel() const { return level.load(std::memory_order_relaxed); }
+
+    bool isEnabled(const LinLogLevel value) const
+    {
+        return (LinLogLevel::None != value) && (value <= getLevel());
+    }
+
+    /// @brief record an event, if its level is enabled
+    /// @param args integral values (little endian, by their size) or Bytes
+    template <typename... Args>
+    void log(const LinLogLevel value, const LinLogEvent event, const Args... args)
+    {
+        if (!isEnabled(value)) {
+            return;
+        }
+
+        const size_t position = head.load(std::memory_order_relaxed);
+        if (position - tail.load(std::memory_order_acquire) >= CAPACITY) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        Record &record = records[position & (CAPACITY - 1)];
+        record.timestamp_us = micros();
+        record.event = event;
+        record.length = 0;
+        (append(record, args), ...);
+        head.store(position + 1, std::memory_order_release);
+    }
+
+    /// @brief record an event once per window, repetitions of the same event and key are counted only
+    /// @details the count is recorded as summary (event Repeated) by the next repetition or flushRepeated() after the window.
+    /// Without a free slot the event is recorded as by log().
+    /// @param key distinguishes the sources of an event, e.g. frame ID or NAD
+    template <typename... Args>
+    void logRepeated(const LinLogLevel value, const LinLogEvent event, const uint8_t key, const Args... args)
+    {
+        if (!isEnabled(value)) {
+            return;
+        }
+
+        const uint32_t now = micros();
+        Repeat* free = nullptr;
+        for (Repeat &repeat : repeats)
+        {
+            if (!repeat.active) {
+                free = free ? free : &repeat;
+                continue;
+            }
+            if ((repeat.event != event) || (repeat.key != key)) {
+                continue;
+            }
+            if (now - repeat.start_us < REPEAT_WINDOW_us) {
+                // storm: counted only
+                repeat.count++;
+                return;
+            }
+            summarize(repeat, now);
+            log(value, event, args...);
+            return;
+        }
+
+        if (free) {
+            *free = {event, key, true, 0, now};
+            activeRepeats++;
+        }
+        log(value, event, args...);
+    }
+
+    /// @brief record the summaries of the elapsed windows, called by the owner of the bus (e.g. before each frame)
+    /// @details the slot of an event without repetition is released
+    void flushRepeated(const uint32_t now)
+    {
+        if (!activeRepeats) {
+            return;
+        }
+        for (Repeat &repeat : repeats)
+        {
+            if (!repeat.active || (now - repeat.start_us < REPEAT_WINDOW_us)) {
+                continue;
+            }
+            if (!repeat.count) {
+                repeat.active = false;
+                activeRepeats--;
+                continue;
+            }
+            summarize(repeat, now);
+        }
+    }
+
+    /// @brief take the oldest record
+    /// @return false if empty
+    bool pop(Record &record)
+    {
+        const size_t position = tail.load(std::memory_order_relaxed);
+        if (position == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        record = records[position & (CAPACITY - 1)];
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief format recorded events as text, oldest first
+    /// @param stream output, e.g. debugStream
+    /// @param max count of records at most
+    /// @return count of records formatted
+    size_t drain(Stream &stream, const size_t max = SIZE_MAX)
+    {
+        size_t count = 0;
+        Record record;
+        while ((count < max) && pop(record))
+        {
+            print(record, stream);
+            count++;
+        }
+
+        const uint32_t lost = dropped.exchange(0, std::memory_order_relaxed);
+        if (lost) {
+            stream.print("log: ");
+            stream.print(lost);
+            stream.println(" records dropped");
+        }
+        return count;
+    }
+
+    /// @brief records lost by a full ring since the last drain()
+    uint32_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+    /// @brief decoder of a record, same text as printed inline before
+    static void print(const Record &record, Stream &stream)
+    {
+        const uint8_t* args = record.args.data();
+        switch (record.event) {
+        case LinLogEvent::FrameReaderReset:
+            stream.println("FrameReader: Reset");
+            break;
+        case LinLogEvent::ChecksumFunctionMissing:
+            stream.println("FrameReader: Missing checksum function");
+            break;
+        case LinLogEvent::FrameValid:
+            printRawFrame(stream, args[0], args + 3, args[2], args[1], args[1]);
+            stream.println("FrameReader: Frame valid");
+            break;
+        case LinLogEvent::ChecksumMismatch:
+            printRawFrame(stream, args[0], args + 4, args[3], args[1], args[2]);
+            break;
+        case LinLogEvent::FrameTimeout:
+            stream.print("timeout: no valid frame received, PID ");
+            stream.println(args[0], HEX);
+            break;
+        case LinLogEvent::ReadbackMismatch:
+            stream.print(" writeFrame, readback failed, PID ");
+            stream.println(args[0], HEX);
+            break;
+        case LinLogEvent::ReadbackTimeout:
+            stream.print("timeout: no valid frame readback received, PID ");
+            stream.println(args[0], HEX);
+            break;
+        case LinLogEvent::BreakStrategyCost:
+            stream.print("LIN break candidate ");
+            stream.print(args[0]);
+            stream.print(args[1] ? ": mean cost [us] " : ": not qualified, mean cost [us] ");
+            stream.println(static_cast<unsigned long>(getUint32(args + 2)));
+            break;
+        case LinLogEvent::PduFrameMissing:
+            stream.print("Failed to read initial PDU, NAD ");
+            stream.println(args[0], HEX);
+            break;
+        case LinLogEvent::PduFrameSize:
+            stream.print("Invalid frame size for PDU: ");
+            stream.println(args[0]);
+            break;
+        case LinLogEvent::Repeated:
+            stream.print(static_cast<unsigned long>(getUint32(args + 2)));
+            stream.print(" ");
+            stream.print(getRepeatedName(static_cast<LinLogEvent>(args[0])));
+            stream.print(" on 0x");
+            stream.print(args[1], HEX);
+            stream.print(" in the last ");
+            stream.print(static_cast<unsigned long>(getUint32(args + 6)));
+            stream.println(" ms");
+            break;
+        }
+    }
+
+private:
+    struct Repeat {
+        LinLogEvent event;
+        uint8_t key;
+        bool active;
+        uint32_t count;         // repetitions within the window, not recorded yet
+        uint32_t start_us;      // start of the window
+    };
+
+    std::array<Record, CAPACITY> records {};
+    std::atomic<size_t> head {0};       // next record to write (producer)
+    std::atomic<size_t> tail {0};       // next record to read (consumer)
+    std::atomic<uint32_t> dropped {0};
+    std::atomic<LinLogLevel> level {LinLogLevel::Error};
+
+    // coalesced events, owned by the producer
+    std::array<Repeat, REPEAT_SLOTS> repeats {};
+    size_t activeRepeats = 0;
+
+    void summarize(Repeat &repeat, const uint32_t now)
+    {
+        if (repeat.count) {
+            log(LinLogLevel::Error, LinLogEvent::Repeated, static_cast<uint8_t>(repeat.event), repeat.key,
+                repeat.count, (now - repeat.start_us) / 1000);
+        }
+        repeat.count = 0;
+        repeat.start_us = now;
+    }
+
+    static uint32_t getUint32(const uint8_t* bytes)
+    {
+        return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24);
+    }
+
+    static const char* getRepeatedName(const LinLogEvent event)
+    {
+        switch (event) {
+        case LinLogEvent::FrameReaderReset:     return "frame reader resets";
+        case LinLogEvent::ChecksumMismatch:     return "checksum errors";
+        case LinLogEvent::FrameTimeout:         return "frame timeouts";
+        case LinLogEvent::ReadbackMismatch:     return "readback mismatches";
+        case LinLogEvent::ReadbackTimeout:      return "readback timeouts";
+        case LinLogEvent::PduFrameMissing:      return "missing PDU frames";
+        case LinLogEvent::PduFrameSize:         return "invalid PDU frame sizes";
+        default:                                return "events";
+        }
+    }
+
+    template <typename T>
+    static void append(Record &record, const T value)
+    {
+        static_assert(std::is_integral<T>::value, "integral argument or Bytes");
+        for (size_t i = 0; (i < sizeof(T)) && (record.length < ARGS_MAX); ++i) {
+            record.args[record.length++] = static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * i));
+        }
+    }
+
+    static void append(Record &record, const Bytes bytes)
+    {
+        if (record.length >= ARGS_MAX) {
+            return;
+        }
+        // truncated to the space left
+        const size_t length = std::min(bytes.length, ARGS_MAX - record.length - 1);
+        record.args[record.length++] = static_cast<uint8_t>(length);
+        for (size_t i = 0; i < length; ++i) {
+            record.args[record.length++] = bytes.data[i];
+        }
+    }
+
+    static void printRawFrame(Stream &stream, const uint8_t protectedID, const uint8_t* data, const size_t length, const uint8_t rxChecksum, const uint8_t expectedChecksum)
+    {
+        stream.print(" --- FID ");
+        stream.print(protectedID & 0x3F, HEX);
+        stream.print("h        = 55|");
+        stream.print(protectedID, HEX);
+        stream.print("|");
+
+        for (size_t i = 0; i < length; ++i)
+        {
+            stream.print(data[i], HEX);
+            stream.print(".");
+        }
+        stream.print("\b|");
+        stream.print(rxChecksum, HEX);
+
+        if (rxChecksum != expectedChecksum)
+        {
+            stream.print(" Checksum mismatch, expected ");
+            stream.print(expectedChecksum, HEX);
+        }
+
+        stream.println();
+    }
+};
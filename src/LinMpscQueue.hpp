@@ -0,0 +1,102 @@
+// LinMpscQueue.hpp
+//
+// Bounded lock-free queue: many producers, a single consumer (MPSC)
+// - fixed ring of cells, no allocation after construction
+// - every cell carries a sequence number, producers claim a cell by compare-exchange of the enqueue position
+// - push() fails when the ring is full (no blocking), pop() is called by the owner of the queue only
+//
+// Algorithm: bounded queue by D. Vyukov, reduced to a single consumer
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+template <typename T, size_t Capacity>
+class LinMpscQueue {
+    static_assert((Capacity >= 2) && ((Capacity & (Capacity - 1)) == 0), "Capacity must be a power of 2");
+
+public:
+    LinMpscQueue()
+    {
+        for (size_t i = 0; i < Capacity; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    LinMpscQueue(const LinMpscQueue&) = delete;
+    LinMpscQueue& operator=(const LinMpscQueue&) = delete;
+
+    /// @brief Append an element, may be called by any thread
+    /// @param value moved into the queue on success only
+    /// @return false if the queue is full
+    bool push(T &&value)
+    {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &cells[pos & mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (0 == diff) {
+                // cell is free: claim it
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // cell is still used by the consumer: full
+                return false;
+            } else {
+                // another producer was faster
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->data = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Remove the oldest element, must be called by the consumer only
+    /// @param value destination
+    /// @return false if the queue is empty (or the oldest element is not published yet)
+    bool pop(T &value)
+    {
+        Cell &cell = cells[dequeuePos & mask];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(dequeuePos + 1) < 0) {
+            return false;
+        }
+
+        value = std::move(cell.data);
+        cell.data = T {};
+        cell.sequence.store(dequeuePos + Capacity, std::memory_order_release);
+        dequeuePos++;
+        return true;
+    }
+
+    /// @brief Consumer side: an element is ready to be popped
+    bool empty() const
+    {
+        const Cell &cell = cells[dequeuePos & mask];
+        return static_cast<intptr_t>(cell.sequence.load(std::memory_order_acquire)) - static_cast<intptr_t>(dequeuePos + 1) < 0;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    static constexpr size_t mask = Capacity - 1;
+
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    std::array<Cell, Capacity> cells;
+    alignas(64) std::atomic<size_t> enqueuePos {0};
+    alignas(64) size_t dequeuePos = 0; // consumer only
+};
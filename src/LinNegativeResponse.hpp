@@ -0,0 +1,89 @@
+// LinNegativeResponse.hpp
+//
+// Status of a service (node configuration and diagnostic) and Negative Response Codes (NRC)
+// - shared by LinNodeConfig and LinDiagnostic
+// - NRC to text by a constexpr table (no allocation, no instance)
+//
+// LIN Specification 2.2A
+// Source https://www.lin-cia.org/fileadmin/microsites/lin-cia.org/resources/documents/LIN_2.2A.pdf
+
+#pragma once
+
+#include <cstdint>
+#include <array>
+
+enum class LinServiceStatus : uint8_t {
+    OK = 0,
+    NO_RESPONSE,        // no (valid) PDU received
+    NEGATIVE_RESPONSE,  // node responded with NRC
+    INVALID_RESPONSE,   // unexpected RSID, DID or length of response
+    NOT_IN_PROGRESS     // nothing to be continued, e.g. resume() without a suspended download
+};
+
+class LinNegativeResponse {
+public:
+    // DTL standard payload: 0x7F SID NRC
+    static constexpr uint8_t SID = 0x7F;
+
+    // LIN 2.2A 4.2.4 Negative Response Codes, completed by ISO 14229-1 (diagnostic services)
+    enum Code : uint8_t {
+        GENERAL_REJECT = 0x10,
+        SERVICE_NOT_SUPPORTED = 0x11,
+        SUBFUNCTION_NOT_SUPPORTED = 0x12,
+        INCORRECT_MSG_LENGTH_OR_INVALID_FORMAT = 0x13,
+        RESPONSE_TOO_LONG = 0x14,
+        BUSY_REPEAT_REQUEST = 0x21,
+        CONDITIONS_NOT_CORRECT = 0x22,
+        REQUEST_SEQUENCE_ERROR = 0x24,
+        REQUEST_OUT_OF_RANGE = 0x31,
+        SECURITY_ACCESS_DENIED = 0x33,
+        INVALID_KEY = 0x35,
+        UPLOAD_DOWNLOAD_NOT_ACCEPTED = 0x70,
+        TRANSFER_DATA_SUSPENDED = 0x71,
+        GENERAL_PROGRAMMING_FAILURE = 0x72,
+        WRONG_BLOCK_SEQUENCE_COUNTER = 0x73,
+        RESPONSE_PENDING = 0x78,
+        SUBFUNCTION_NOT_SUPPORTED_IN_ACTIVE_SESSION = 0x7E,
+        SERVICE_NOT_SUPPORTED_IN_ACTIVE_SESSION = 0x7F
+    };
+
+    /// @brief get error string out of code
+    /// @param code Negative Response Code
+    /// @return short string, describes error
+    static constexpr const char* toString(const uint8_t code)
+    {
+        for (const Entry& entry : table) {
+            if (entry.code == code) {
+                return entry.text;
+            }
+        }
+        return "Unknown NegativeResponseCode";
+    }
+
+private:
+    struct Entry {
+        uint8_t code;
+        const char* text;
+    };
+
+    static constexpr std::array<Entry, 18> table {{
+        {GENERAL_REJECT, "NRC_GENERAL_REJECT"},
+        {SERVICE_NOT_SUPPORTED, "NRC_SERVICE_NOT_SUPPORTED"},
+        {SUBFUNCTION_NOT_SUPPORTED, "NRC_SUBFUNCTION_NOT_SUPPORTED"},
+        {INCORRECT_MSG_LENGTH_OR_INVALID_FORMAT, "NRC_INCORRECT_MSG_LENGTH_OR_INVALID_FORMAT"},
+        {RESPONSE_TOO_LONG, "NRC_RESPONSE_TOO_LONG"},
+        {BUSY_REPEAT_REQUEST, "NRC_BUSY_REPEAT_REQUEST"},
+        {CONDITIONS_NOT_CORRECT, "NRC_CONDITIONS_NOT_CORRECT"},
+        {REQUEST_SEQUENCE_ERROR, "NRC_REQUEST_SEQUENCE_ERROR"},
+        {REQUEST_OUT_OF_RANGE, "NRC_REQUEST_OUT_OF_RANGE"},
+        {SECURITY_ACCESS_DENIED, "NRC_SECURITY_ACCESS_DENIED"},
+        {INVALID_KEY, "NRC_INVALID_KEY"},
+        {UPLOAD_DOWNLOAD_NOT_ACCEPTED, "NRC_UPLOAD_DOWNLOAD_NOT_ACCEPTED"},
+        {TRANSFER_DATA_SUSPENDED, "NRC_TRANSFER_DATA_SUSPENDED"},
+        {GENERAL_PROGRAMMING_FAILURE, "NRC_GENERAL_PROGRAMMING_FAILURE"},
+        {WRONG_BLOCK_SEQUENCE_COUNTER, "NRC_WRONG_BLOCK_SEQUENCE_COUNTER"},
+        {RESPONSE_PENDING, "NRC_RESPONSE_PENDING"},
+        {SUBFUNCTION_NOT_SUPPORTED_IN_ACTIVE_SESSION, "NRC_SUBFUNCTION_NOT_SUPPORTED_IN_ACTIVE_SESSION"},
+        {SERVICE_NOT_SUPPORTED_IN_ACTIVE_SESSION, "NRC_SERVICE_NOT_SUPPORTED_IN_ACTIVE_SESSION"}
+    }};
+};
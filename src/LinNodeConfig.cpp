@@ -17,6 +17,7 @@
 
 #include <optional>
 #include <vector>
+#include <algorithm>
 
 #include "LinFrameTransfer.hpp"
 #include "LinPDU.hpp"
@@ -58,31 +59,27 @@ void LinNodeConfig::requestGoToSleep()
     writeFrame(FRAME_ID::MASTER_REQUEST, cmdSleep.asVector());
 }
 
-std::optional<std::vector<uint8_t>> LinNodeConfig::readById(uint8_t &NAD, uint16_t supplierId, uint16_t functionId, uint8_t id)
+/// @brief read an identifier of a node
+/// @details see LIN Spec 2.2A 4.2.6.1 Read by identifier
+/// @param NAD Node Adress (may wildcard, will be replaced by responding NAD)
+/// @param supplierId Supplier ID (may wildcard)
+/// @param functionId Function ID (may wildcard)
+/// @param id Identifier (0 = product id, 1 = serial number, 32-63 user defined)
+/// @param mode FRESH: request node, CACHED: use a previous response of the same request
+/// @return status, NRC and up to 5 data bytes of response (without RSID)
+LinNodeConfig::Result LinNodeConfig::readById(uint8_t &NAD, uint16_t supplierId, uint16_t functionId, uint8_t id, ReadMode mode)
 {
-    uint8_t SID = static_cast<uint8_t>(ServiceIdentifier::READ_BY_ID);
-    std::vector<uint8_t> payload = {
-        SID,
-        id,
-        (uint8_t)lowByte(supplierId),
-        (uint8_t)highByte(supplierId),
-        (uint8_t)lowByte(functionId),
-        (uint8_t)highByte(functionId)
-    };
-    auto raw = writePDU(NAD, payload);
-
-    if (!checkPayload_isValid(SID, raw))
+    if (ReadMode::CACHED == mode)
     {
-        return {};
+        auto it = readByIdCache.find(NAD << 8 | id);
+        if ((it != readByIdCache.end()) && (it->second.supplierId == supplierId) && (it->second.functionId == functionId)) {
+            return {Status::OK, 0, NAD, it->second.length, 0, it->second.data};
+        }
     }
 
-    std::vector<uint8_t> result;
-    // leave out: data()[0]
-    result.push_back(raw.value().data()[1]);
-    result.push_back(raw.value().data()[2]);
-    result.push_back(raw.value().data()[3]);
-    result.push_back(raw.value().data()[4]);
-    result.push_back(raw.value().data()[5]);
+    Request request = encodeReadById(NAD, supplierId, functionId, id);
+    Result result = transfer(request);
+    NAD = request.NAD;
 
     return result;
 }
@@ -93,28 +90,14 @@ std::optional<std::vector<uint8_t>> LinNodeConfig::readById(uint8_t &NAD, uint16
 /// @param supplierId Supplier ID (may wildcard)
 /// @param functionId Function ID (may wildcard)
 /// @param variantId Variant of identical nodes
-/// @return success
-bool LinNodeConfig::readProductId(uint8_t &NAD, uint16_t &supplierId, uint16_t &functionId, uint8_t &variantId)
+/// @param mode FRESH: request node, CACHED: use a previous response of the same request
+/// @return status and NRC
+LinNodeConfig::Result LinNodeConfig::readProductId(uint8_t &NAD, uint16_t &supplierId, uint16_t &functionId, uint8_t &variantId, ReadMode mode)
 {
-    uint8_t SID = static_cast<uint8_t>(ServiceIdentifier::READ_BY_ID);
-    std::vector<uint8_t> payload = {
-        SID,
-        (uint8_t)CMD_Identifier::PRODUCT_ID,
-        (uint8_t)lowByte(supplierId),
-        (uint8_t)highByte(supplierId),
-        (uint8_t)lowByte(functionId),
-        (uint8_t)highByte(functionId)
-    };
-    auto raw = writePDU(NAD, payload);
-
-    if (!checkPayload_isValid(SID, raw))
-    {
-        return false;
-    }
+    Result result = readById(NAD, supplierId, functionId, (uint8_t)CMD_Identifier::PRODUCT_ID, mode);
 
     struct responseSid0ProductId
     {
-        uint8_t RSID;
         uint8_t supplierId_LSB;
         uint8_t supplierId_MSB;
         uint8_t functionId_LSB;
@@ -122,59 +105,81 @@ bool LinNodeConfig::readProductId(uint8_t &NAD, uint16_t &supplierId, uint16_t &
         uint8_t variantId;
     };
 
-    responseSid0ProductId& re = *reinterpret_cast<responseSid0ProductId*>(raw.value().data());
+    if (!result) {
+        return result;
+    }
+    if (result.length < sizeof(responseSid0ProductId)) {
+        result.status = Status::INVALID_RESPONSE;
+        return result;
+    }
+
+    const responseSid0ProductId& re = *reinterpret_cast<const responseSid0ProductId*>(result.data.data());
 
     supplierId = re.supplierId_MSB << 8 | re.supplierId_LSB;
     functionId = re.functionId_MSB << 8 | re.functionId_LSB;
     variantId = re.variantId;
 
-    return true;
+    return result;
 }
 
 /// @brief get Serial Number from specific node (optinal Function of Node)
 /// @details see LIN Spec 2.2A 4.2.1 LIN PRODUCT IDENTIFICATION
-/// @param NAD
-/// @param supplierId
-/// @param functionId
-/// @param serialNumber
-/// @return Serial number or fail
-std::optional<uint32_t> LinNodeConfig::readSerialNumber(uint8_t &NAD, uint16_t supplierId, uint16_t functionId)
+/// @param NAD Node Adress (may wildcard)
+/// @param supplierId Supplier ID (may wildcard)
+/// @param functionId Function ID (may wildcard)
+/// @param serialNumber Serial number, written on success
+/// @param mode FRESH: request node, CACHED: use a previous response of the same request
+/// @return status and NRC
+LinNodeConfig::Result LinNodeConfig::readSerialNumber(uint8_t &NAD, uint16_t supplierId, uint16_t functionId, uint32_t &serialNumber, ReadMode mode)
 {
-    uint8_t SID = static_cast<uint8_t>(ServiceIdentifier::READ_BY_ID);
-    std::vector<uint8_t> payload = {
-        SID,
-        (uint8_t)CMD_Identifier::PRODUCT_ID,
-        (uint8_t)lowByte(supplierId),
-        (uint8_t)highByte(supplierId),
-        (uint8_t)lowByte(functionId),
-        (uint8_t)highByte(functionId)
-    };
-    auto raw = writePDU(NAD, payload);
-
-    if (!checkPayload_isValid(SID, raw))
-    {
-        return {};
-    }
+    Result result = readById(NAD, supplierId, functionId, (uint8_t)CMD_Identifier::SERIAL_NUMBER, mode);
 
-    struct responseSid0ProductId
+    struct responseSid1SerialNumber
     {
-        uint8_t RSID;
         uint8_t serialNumber_LSB;
         uint8_t serialNumber_LSB2;
         uint8_t serialNumber_LSB3;
         uint8_t serialNumber_MSB;
     };
 
-    responseSid0ProductId& re = *reinterpret_cast<responseSid0ProductId*>(raw.value().data());
+    if (!result) {
+        return result;
+    }
+    if (result.length < sizeof(responseSid1SerialNumber)) {
+        result.status = Status::INVALID_RESPONSE;
+        return result;
+    }
 
-    /* no double check neccessary
-        if (re.RSID != getRSID(SID))
-            return false;
-    */
+    const responseSid1SerialNumber& re = *reinterpret_cast<const responseSid1SerialNumber*>(result.data.data());
 
-    uint32_t serialNumber = re.serialNumber_MSB << 24 | re.serialNumber_LSB3 << 16 | re.serialNumber_LSB2 << 8 | re.serialNumber_LSB;
+    serialNumber = (uint32_t)re.serialNumber_MSB << 24 | re.serialNumber_LSB3 << 16 | re.serialNumber_LSB2 << 8 | re.serialNumber_LSB;
 
-    return serialNumber;
+    return result;
+}
+
+/// @brief forget cached READ_BY_ID responses of a node
+/// @param NAD Node Address (wildcard: all nodes)
+void LinNodeConfig::invalidateCache(const uint8_t NAD)
+{
+    if (PDU::NAD_Type::BROADCAST == NAD) {
+        clearCache();
+        return;
+    }
+
+    for (auto it = readByIdCache.begin(); it != readByIdCache.end(); )
+    {
+        if ((it->first >> 8) == NAD) {
+            it = readByIdCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/// @brief forget all cached READ_BY_ID responses
+void LinNodeConfig::clearCache()
+{
+    readByIdCache.clear();
 }
 
 
@@ -184,32 +189,15 @@ std::optional<uint32_t> LinNodeConfig::readSerialNumber(uint8_t &NAD, uint16_t s
 /// @param supplierId wildcard = 0x7FFF
 /// @param functionId wildcard = 0x3FFF
 /// @param newNAD new NAD
-/// @return success
-bool LinNodeConfig::assignNAD(uint8_t &NAD, uint16_t supplierId, uint16_t functionId, uint8_t newNAD)
+/// @return status and NRC
+LinNodeConfig::Result LinNodeConfig::assignNAD(uint8_t &NAD, uint16_t supplierId, uint16_t functionId, uint8_t newNAD)
 {
-    uint8_t SID = static_cast<uint8_t>(ServiceIdentifier::ASSIGN_NAD);
-    std::vector<uint8_t> payload = {
-        SID,
-        (uint8_t)lowByte(supplierId),
-        (uint8_t)highByte(supplierId),
-        (uint8_t)lowByte(functionId),
-        (uint8_t)highByte(functionId),
-        (uint8_t)newNAD
-    };
-    auto raw = writePDU(NAD, payload);
     // Response on initial NAD
+    Request request = encodeAssignNAD(NAD, supplierId, functionId, newNAD);
+    Result result = transfer(request);
+    NAD = request.NAD;
 
-    if (!checkPayload_isValid(SID, raw))
-    {
-        return false;
-    }
-
-    // expected: all verified within writePDU() and checkPayload_isValid()
-    // initial NAD (not the new one)
-    // PCI = Single Frame, Length = 1
-    // RSID is valid
-
-    return true;
+    return result;
 }
 
 /// @brief conditional change of NAD (NEEDs FIX)
@@ -220,61 +208,46 @@ bool LinNodeConfig::assignNAD(uint8_t &NAD, uint16_t supplierId, uint16_t functi
 /// @param invert 3. Do a bitwise XOR with Invert
 /// @param mask 4. Do a bitwise AND with Mask
 /// @param newNAD 5. if the final result is zero change the NAD to newNAD
-/// @return success
-bool LinNodeConfig::conditionalChangeNAD(uint8_t &NAD, uint8_t id, uint8_t byte, uint8_t invert, uint8_t mask, uint8_t newNAD)
+/// @return status and NRC
+LinNodeConfig::Result LinNodeConfig::conditionalChangeNAD(uint8_t &NAD, uint8_t id, uint8_t byte, uint8_t invert, uint8_t mask, uint8_t newNAD)
 {
-    uint8_t SID = static_cast<uint8_t>(ServiceIdentifier::CONDITIONAL_CHANGE);
-    std::vector<uint8_t> payload = {
-        SID,
-        id,
-        byte,
-        mask,
-        invert,
-        newNAD
-    };
-    auto raw = writePDU(NAD, payload, newNAD);
-
-// TODO: response will use the new NAD, not the initial one!
-// FIX: response will use the new NAD, not the initial one!
-
+    // response will use the new NAD, not the initial one
+    Request request = encodeConditionalChangeNAD(NAD, id, byte, invert, mask, newNAD);
+    Result result = transfer(request);
+    NAD = request.NAD;
 
-    if (!checkPayload_isValid(SID, raw))
-    {
-        return false;
-    }
+    return result;
+}
 
-    // expected: NOT verified within writePDU() and checkPayload_isValid()
-    // new NAD (not the old one!!!)
-    // PCI = Single Frame, Length = 1
-    // RSID is valid
+/// @brief exchange of user defined data
+/// @details LIN SPEC 2.2A 4.2.5.3 Data dump
+/// the content of request and response is defined by the supplier of the node,
+/// should be used with a single node only (e.g. in production)
+/// @param NAD Node Address
+/// @param data D1..D5 of request
+/// @return status, NRC and D1..D5 of response
+LinNodeConfig::Result LinNodeConfig::dataDump(uint8_t &NAD, const std::array<uint8_t, 5> &data)
+{
+    Request request = encodeDataDump(NAD, data);
+    Result result = transfer(request);
+    NAD = request.NAD;
 
-    return true;
+    return result;
 }
 
-// LIN SPEC 2.2A 4.2.5.3 Data dump
-// - not implemented -
-// std::vector<uint8_t> LinNodeConfig::dataDump(uint8_t* NAD, std::vector<uint8_t>)
-
 /// @brief Saves the configuration of the LIN node.
 /// @details LIN SPEC 2.2A 4.2.5.4 Save Configuration
 /// Request the node to save its current configuration. The implementation follows the
 /// LIN specification and ensures that the node retains its settings after a power cycle.
 /// @param NAD Node Address (NAD) of the target
-/// @return success
-bool LinNodeConfig::saveConfig(uint8_t &NAD)
+/// @return status and NRC
+LinNodeConfig::Result LinNodeConfig::saveConfig(uint8_t &NAD)
 {
-    uint8_t SID = static_cast<uint8_t>(ServiceIdentifier::SAVE_CONFIG);
-    std::vector<uint8_t> payload = {
-        SID
-    };
-    auto raw = writePDU(NAD, payload);
+    Request request = encodeSaveConfig(NAD);
+    Result result = transfer(request);
+    NAD = request.NAD;
 
-    if (!checkPayload_isValid(SID, raw))
-    {
-        return false;
-    }
-
-    return true;
+    return result;
 }
 
 /// @brief Assigns a range of frame IDs to a LIN node
@@ -285,77 +258,244 @@ bool LinNodeConfig::saveConfig(uint8_t &NAD)
 /// @param PID1 second protected identifier (PID) in the frame ID range
 /// @param PID2 third protected identifier (PID) in the frame ID range
 /// @param PID3 fourth protected identifier (PID) in the frame ID range
-/// @return success
-bool LinNodeConfig::assignFrameIdRange(uint8_t &NAD, uint8_t startIndex, uint8_t PID0, uint8_t PID1, uint8_t PID2, uint8_t PID3)
+/// @return status and NRC
+LinNodeConfig::Result LinNodeConfig::assignFrameIdRange(uint8_t &NAD, uint8_t startIndex, uint8_t PID0, uint8_t PID1, uint8_t PID2, uint8_t PID3)
 {
-    uint8_t SID = static_cast<uint8_t>(ServiceIdentifier::ASSIGN_FRAME_IDENTIFIER_RANGE);
-    std::vector<uint8_t> payload = {
-        SID,
-        startIndex,
-        PID0,
-        PID1,
-        PID2,
-        PID3
-    };
-    auto raw = writePDU(NAD, payload);
+    // no double check of RSID neccessary
+    Request request = encodeAssignFrameIdRange(NAD, startIndex, PID0, PID1, PID2, PID3);
+    Result result = transfer(request);
+    NAD = request.NAD;
+
+    return result;
+}
 
-    if (!checkPayload_isValid(SID, raw))
+/// @brief Execute all queued services in order of the batch
+/// @details requests are streamed back-to-back without readback verification (the response of the
+/// node confirms the request) by a single reused frame buffer, the learned timing of each node is used.
+/// A failed service does not stop the batch, its status is kept by the item.
+/// @param batch queued services, results are written to the items
+/// @return count of successful services
+size_t LinNodeConfig::execute(Batch &batch)
+{
+    size_t succeeded = 0;
+    for (Request &request : batch.requests)
     {
-        return false;
+        if (transfer(request, true)) {
+            succeeded++;
+        }
     }
-
-    // no double check of RSID neccessary
-    return true;
+    return succeeded;
 }
 
-/// @brief Check payload for expected SID or ErrorCode
-/// @param SID expected SID for positive response
-/// @param payload data to investigate
-/// @return data are valid, expected SID was recognizes, no error code
-bool LinNodeConfig::checkPayload_isValid(const uint8_t SID, const std::optional<std::vector<uint8_t>> &payload)
+/// @brief Transmit request and classify the response
+/// @details a negative response is reported by status and NRC, the text is available by Result::getNrcString()
+/// @param request encoded service, NAD is replaced by the responding NAD (wildcard, NAD change)
+/// @param streamed request is not verified by its readback
+/// @return status, NRC, responding NAD, elapsed time and data of response (without RSID)
+LinNodeConfig::Result LinNodeConfig::transfer(Request &request, const bool streamed)
 {
-    uint8_t expectedRSID = getRSID(SID);
+    const uint8_t SID = request.payload.front();
+    const uint8_t initialNAD = request.NAD;
+    const auto start = millis();
+
+    // Single Frame: NAD PCI SID D1..D5, reused for every request
+    requestFrame[0] = request.NAD;
+    requestFrame[1] = static_cast<uint8_t>(PDU::PCI_Type::SINGLE) | request.length;
+    std::copy(request.payload.begin(), request.payload.end(), requestFrame.begin() + 2);
+    if (streamed) {
+        writeFrame(FRAME_ID::MASTER_REQUEST, requestFrame, ReadbackPolicy::Discard);
+    } else {
+        writeFrame(FRAME_ID::MASTER_REQUEST, requestFrame);
+    }
+    auto raw = readPduResponse(request.NAD, request.newNAD);
+
+    Result &result = request.result;
+    result = {Status::NO_RESPONSE, 0, request.NAD, 0, static_cast<uint32_t>(millis() - start), {}};
 
-    if (!payload) {
-        return false;
+    if (!raw || raw.value().empty()) {
+        return result;
     }
+    const std::vector<uint8_t>& response = raw.value();
 
-    if ((!payload.value().empty()) && (expectedRSID == payload.value().front())) {
+    if (getRSID(SID) == response.front()) {
         // looks like valid response
-        return true;
+        result.status = Status::OK;
+        result.length = static_cast<uint8_t>(std::min(response.size() - 1, result.data.size()));
+        std::copy_n(response.begin() + 1, result.length, result.data.begin());
+        updateCache(request, initialNAD);
+        return result;
     }
 
-    // now we are having trouble.
+    if ((LinNegativeResponse::SID != response.front()) || (response.size() < 3) || (response[1] != SID)) {
+        // unexpected: payload[0] is not equal to neither RSID nor 0x7F
+        result.status = Status::INVALID_RESPONSE;
+        return result;
+    }
 
-    struct Error {
-        uint8_t magicnumber;
-        uint8_t SID;
-        NegativeResponseCode errorCode;
-    };
+    result.status = Status::NEGATIVE_RESPONSE;
+    result.NRC = response[2];
+    return result;
+}
 
-    if (payload.value().size() < sizeof(Error)) {
-        return false;
+/// @brief Keep the READ_BY_ID cache consistent with a successful service
+/// @param request executed service
+/// @param initialNAD addressed NAD, before it was replaced by the responding one
+void LinNodeConfig::updateCache(const Request &request, const uint8_t initialNAD)
+{
+    const auto& payload = request.payload;
+    switch (static_cast<ServiceIdentifier>(payload[0]))
+    {
+    case ServiceIdentifier::READ_BY_ID:
+        if (isCacheable(payload[1])) {
+            // NAD of responding node (wildcard was replaced)
+            readByIdCache[request.NAD << 8 | payload[1]] = {
+                static_cast<uint16_t>(payload[2] | payload[3] << 8),
+                static_cast<uint16_t>(payload[4] | payload[5] << 8),
+                request.result.length,
+                request.result.data
+            };
+        }
+        break;
+
+    case ServiceIdentifier::ASSIGN_NAD:
+    case ServiceIdentifier::CONDITIONAL_CHANGE:
+        // identity of both NADs has changed
+        invalidateCache(initialNAD);
+        invalidateCache(request.NAD);
+        invalidateCache(payload[5]);
+        break;
+
+    case ServiceIdentifier::DATA_DUMP:
+    case ServiceIdentifier::SAVE_CONFIG:
+        invalidateCache(request.NAD);
+        break;
+
+    default:
+        break;
     }
-    const Error* err = reinterpret_cast<const Error*>(payload.value().data());
+}
 
-    if (NEGATIVE_RESPONSE != err->magicnumber) {
-        // unexpected: payload[0] is not equal to neither RSID nor 0x7F
-        debugStream.print("writePDU failed: unexpected RSID");
-        return {};
-    }
+/// @brief Encode a Single Frame request
+/// @param NAD Node Address
+/// @param payload SID + up to 5 data bytes, unused bytes are filled by 0xFF
+/// @param newNAD response is accepted by this NAD as well (NAD change)
+/// @return request
+LinNodeConfig::Request LinNodeConfig::encode(const uint8_t NAD, std::initializer_list<uint8_t> payload, const uint8_t newNAD)
+{
+    Request request {};
+    request.NAD = NAD;
+    request.newNAD = newNAD;
+    request.length = static_cast<uint8_t>(std::min(payload.size(), request.payload.size()));
+    request.payload.fill(PDU::fillByte);
+    std::copy_n(payload.begin(), request.length, request.payload.begin());
+    request.result = {Status::NO_RESPONSE, 0, NAD, 0, 0, {}};
+    return request;
+}
+
+LinNodeConfig::Request LinNodeConfig::encodeReadById(const uint8_t NAD, uint16_t supplierId, uint16_t functionId, uint8_t id)
+{
+    return encode(NAD, {
+        static_cast<uint8_t>(ServiceIdentifier::READ_BY_ID),
+        id,
+        (uint8_t)lowByte(supplierId),
+        (uint8_t)highByte(supplierId),
+        (uint8_t)lowByte(functionId),
+        (uint8_t)highByte(functionId)
+    });
+}
+
+LinNodeConfig::Request LinNodeConfig::encodeAssignNAD(const uint8_t NAD, uint16_t supplierId, uint16_t functionId, uint8_t newNAD)
+{
+    return encode(NAD, {
+        static_cast<uint8_t>(ServiceIdentifier::ASSIGN_NAD),
+        (uint8_t)lowByte(supplierId),
+        (uint8_t)highByte(supplierId),
+        (uint8_t)lowByte(functionId),
+        (uint8_t)highByte(functionId),
+        newNAD
+    });
+}
+
+LinNodeConfig::Request LinNodeConfig::encodeConditionalChangeNAD(const uint8_t NAD, uint8_t id, uint8_t byte, uint8_t invert, uint8_t mask, uint8_t newNAD)
+{
+    return encode(NAD, {
+        static_cast<uint8_t>(ServiceIdentifier::CONDITIONAL_CHANGE),
+        id,
+        byte,
+        mask,
+        invert,
+        newNAD
+    }, newNAD);
+}
+
+LinNodeConfig::Request LinNodeConfig::encodeDataDump(const uint8_t NAD, const std::array<uint8_t, 5> &data)
+{
+    return encode(NAD, {
+        static_cast<uint8_t>(ServiceIdentifier::DATA_DUMP),
+        data[0], data[1], data[2], data[3], data[4]
+    });
+}
+
+LinNodeConfig::Request LinNodeConfig::encodeSaveConfig(const uint8_t NAD)
+{
+    return encode(NAD, {
+        static_cast<uint8_t>(ServiceIdentifier::SAVE_CONFIG)
+    });
+}
+
+LinNodeConfig::Request LinNodeConfig::encodeAssignFrameIdRange(const uint8_t NAD, uint8_t startIndex, uint8_t PID0, uint8_t PID1, uint8_t PID2, uint8_t PID3)
+{
+    return encode(NAD, {
+        static_cast<uint8_t>(ServiceIdentifier::ASSIGN_FRAME_IDENTIFIER_RANGE),
+        startIndex,
+        PID0,
+        PID1,
+        PID2,
+        PID3
+    });
+}
 
-    auto rxSID = err->SID;
-    auto errorcode = err->errorCode;
+LinNodeConfig::Batch& LinNodeConfig::Batch::readById(const uint8_t NAD, uint16_t supplierId, uint16_t functionId, uint8_t id)
+{
+    requests.push_back(encodeReadById(NAD, supplierId, functionId, id));
+    return *this;
+}
+
+LinNodeConfig::Batch& LinNodeConfig::Batch::assignNAD(const uint8_t NAD, uint16_t supplierId, uint16_t functionId, uint8_t newNAD)
+{
+    requests.push_back(encodeAssignNAD(NAD, supplierId, functionId, newNAD));
+    return *this;
+}
+
+LinNodeConfig::Batch& LinNodeConfig::Batch::conditionalChangeNAD(const uint8_t NAD, uint8_t id, uint8_t byte, uint8_t invert, uint8_t mask, uint8_t newNAD)
+{
+    requests.push_back(encodeConditionalChangeNAD(NAD, id, byte, invert, mask, newNAD));
+    return *this;
+}
+
+LinNodeConfig::Batch& LinNodeConfig::Batch::dataDump(const uint8_t NAD, const std::array<uint8_t, 5> &data)
+{
+    requests.push_back(encodeDataDump(NAD, data));
+    return *this;
+}
 
-    debugStream.print("writePDU failed: SID=0x");
-    debugStream.print(rxSID, HEX);
-    debugStream.print(" Error Code=0x");
-    debugStream.print((uint8_t)(errorcode), HEX);
-    debugStream.print(" = ");
-    debugStream.print(get_NegativeResponseCode_String(errorcode));
-    debugStream.println();
+LinNodeConfig::Batch& LinNodeConfig::Batch::saveConfig(const uint8_t NAD)
+{
+    requests.push_back(encodeSaveConfig(NAD));
+    return *this;
+}
+
+LinNodeConfig::Batch& LinNodeConfig::Batch::assignFrameIdRange(const uint8_t NAD, uint8_t startIndex, uint8_t PID0, uint8_t PID1, uint8_t PID2, uint8_t PID3)
+{
+    requests.push_back(encodeAssignFrameIdRange(NAD, startIndex, PID0, PID1, PID2, PID3));
+    return *this;
+}
 
-    return false;
+/// @brief count of items which have failed (or were not executed yet)
+size_t LinNodeConfig::Batch::getFailures() const
+{
+    return std::count_if(requests.begin(), requests.end(),
+        [](const Request &request) { return !request.result; });
 }
 
 /// @brief convert SID to RSID
@@ -368,12 +508,3 @@ constexpr uint8_t LinNodeConfig::getRSID(const uint8_t SID)
     constexpr uint8_t SID_TO_RSID_MASK = 0x40;
     return SID + SID_TO_RSID_MASK;
 }
-
-/// @brief get error string out of code
-/// @param code Error code
-/// @return short string, describes error
-const char* LinNodeConfig::get_NegativeResponseCode_String(NegativeResponseCode code)
-{
-    auto it = codeMap.find(code);
-    return (it != codeMap.end()) ? it->second : "Unknown NegativeResponseCode";
-}
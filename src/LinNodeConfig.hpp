@@ -14,32 +14,96 @@
     #include <Arduino.h>
 #endif
 
+#include <array>
+#include <initializer_list>
 #include <optional>
 #include <vector>
 #include <unordered_map>
 
 #include "LinTransportLayer.hpp"
+#include "LinNegativeResponse.hpp"
 
 class LinNodeConfig : protected LinTransportLayer{
 public:
     using LinTransportLayer::LinTransportLayer;
+    using LinTransportLayer::frameStats;
+    using LinTransportLayer::logger;
+    using LinTransportLayer::trace;
+    using LinTransportLayer::drainLog;
+
+    using Status = LinServiceStatus;
+
+    // result of a service, without any heap allocation
+    struct Result {
+        Status status;
+        uint8_t NRC;                    // Negative Response Code, valid for Status::NEGATIVE_RESPONSE
+        uint8_t NAD;                    // NAD of responding node
+        uint8_t length;                 // count of valid bytes within data
+        uint32_t elapsed;               // duration of the service [ms], 0 if answered by cache
+        std::array<uint8_t, 5> data;    // response without RSID (e.g. READ_BY_ID: 5 bytes)
+
+        explicit operator bool() const { return Status::OK == status; }
+        const char* getNrcString() const { return LinNegativeResponse::toString(NRC); }
+    };
 
     void requestWakeup();
     void requestGoToSleep();
 
-    std::optional<std::vector<uint8_t>> readById(uint8_t &NAD, uint16_t supplierId, uint16_t functionId, uint8_t id);
-    bool readProductId(uint8_t &NAD, uint16_t &supplierId, uint16_t &functionId, uint8_t &variantId);
-    std::optional<uint32_t> readSerialNumber(uint8_t &NAD, uint16_t supplierId, uint16_t functionId);
+    // READ_BY_ID: FRESH = request the node (result is cached), CACHED = answer from cache if available
+    enum class ReadMode : uint8_t {
+        FRESH,
+        CACHED
+    };
+
+    Result readById(uint8_t &NAD, uint16_t supplierId, uint16_t functionId, uint8_t id, ReadMode mode = ReadMode::FRESH);
+    Result readProductId(uint8_t &NAD, uint16_t &supplierId, uint16_t &functionId, uint8_t &variantId, ReadMode mode = ReadMode::FRESH);
+    Result readSerialNumber(uint8_t &NAD, uint16_t supplierId, uint16_t functionId, uint32_t &serialNumber, ReadMode mode = ReadMode::FRESH);
+
+    void invalidateCache(const uint8_t NAD);
+    void clearCache();
+
+    Result assignNAD(uint8_t &NAD, uint16_t supplierId, uint16_t functionId, uint8_t newNAD);
+    Result conditionalChangeNAD(uint8_t &NAD, uint8_t id, uint8_t byte, uint8_t invert, uint8_t mask, uint8_t newNAD);
+    Result dataDump(uint8_t &NAD, const std::array<uint8_t, 5> &data);
+
+    Result saveConfig(uint8_t &NAD);
 
-    bool assignNAD(uint8_t &NAD, uint16_t supplierId, uint16_t functionId, uint8_t newNAD);
-    bool conditionalChangeNAD(uint8_t &NAD, uint8_t id, uint8_t byte, uint8_t invert, uint8_t mask, uint8_t newNAD);
+    Result assignFrameIdRange(uint8_t &NAD, uint8_t startIndex, uint8_t PID0, uint8_t PID1, uint8_t PID2, uint8_t PID3);
 
-    // not implemented:
-    // std::optional<std::vector<uint8_t>> LinNodeConfig::dataDump(uint8_t* NAD, std::vector<uint8_t>)
+    // encoded service: Single Frame MasterRequest (SID + up to 5 data bytes)
+    struct Request {
+        uint8_t NAD;                    // addressed NAD, replaced by the responding NAD (wildcard, NAD change)
+        uint8_t newNAD;                 // response is accepted by this NAD as well (NAD change), 0 = none
+        uint8_t length;                 // count of valid bytes within payload
+        std::array<uint8_t, PDU::dataLenSingle> payload;
+        Result result;                  // written by execution
+    };
+
+    // services for one or many nodes, queued and executed back-to-back in order
+    class Batch {
+    public:
+        Batch& readById(const uint8_t NAD, uint16_t supplierId, uint16_t functionId, uint8_t id);
+        Batch& assignNAD(const uint8_t NAD, uint16_t supplierId, uint16_t functionId, uint8_t newNAD);
+        Batch& conditionalChangeNAD(const uint8_t NAD, uint8_t id, uint8_t byte, uint8_t invert, uint8_t mask, uint8_t newNAD);
+        Batch& dataDump(const uint8_t NAD, const std::array<uint8_t, 5> &data);
+        Batch& saveConfig(const uint8_t NAD);
+        Batch& assignFrameIdRange(const uint8_t NAD, uint8_t startIndex, uint8_t PID0, uint8_t PID1, uint8_t PID2, uint8_t PID3);
+
+        void reserve(size_t count) { requests.reserve(count); }
+        void clear() { requests.clear(); }
+        size_t size() const { return requests.size(); }
+        const Request& operator[](size_t index) const { return requests[index]; }
+        std::vector<Request>::const_iterator begin() const { return requests.begin(); }
+        std::vector<Request>::const_iterator end() const { return requests.end(); }
+
+        size_t getFailures() const;
+
+    private:
+        friend class LinNodeConfig;
+        std::vector<Request> requests;
+    };
 
-    bool saveConfig(uint8_t &NAD);
-    
-    bool assignFrameIdRange(uint8_t &NAD, uint8_t startIndex, uint8_t PID0, uint8_t PID1, uint8_t PID2, uint8_t PID3);
+    size_t execute(Batch &batch);
 
 protected:
     // 3.2.1.4 SID
@@ -68,37 +132,34 @@ protected:
         // 64-255 Reserved
     };
 
-    // DTL standard payload
-    static constexpr uint8_t NEGATIVE_RESPONSE = 0x7F;
-
-    // Negative Response Codes NRC
-    enum NegativeResponseCode: uint8_t {
-        GENERAL_REJECT = 0x10,
-        SERVICE_NOT_SUPPORTED = 0x11,
-        SUBFUNCTION_NOT_SUPPORTED = 0x12,
-        INCORRECT_MSG_LENGTH_OR_INVALID_FORMAT = 0x13,
-        RESPONSE_TOO_LONG = 0x14,
-        BUSY_REPEAT_REQUEST = 0x21,
-        CONDITIONS_NOT_CORRECT = 0x22,
-        REQUEST_OUT_OF_RANGE = 0x31,
-        SECURITY_ACCESS_DENIED = 0x33,
-        INVALID_KEY = 0x35
+    // cached READ_BY_ID response, only valid for the same supplier/function filter
+    struct CacheEntry {
+        uint16_t supplierId;
+        uint16_t functionId;
+        uint8_t length;
+        std::array<uint8_t, 5> data;
     };
-
-    const std::unordered_map<NegativeResponseCode, const char*> codeMap = {
-        {NegativeResponseCode::GENERAL_REJECT, "NRC_GENERAL_REJECT"},
-        {NegativeResponseCode::SERVICE_NOT_SUPPORTED, "NRC_SERVICE_NOT_SUPPORTED"},
-        {NegativeResponseCode::SUBFUNCTION_NOT_SUPPORTED, "NRC_SUBFUNCTION_NOT_SUPPORTED"},
-        {NegativeResponseCode::INCORRECT_MSG_LENGTH_OR_INVALID_FORMAT, "NRC_INCORRECT_MSG_LENGTH_OR_INVALID_FORMAT"},
-        {NegativeResponseCode::RESPONSE_TOO_LONG, "NRC_RESPONSE_TOO_LONG"},
-        {NegativeResponseCode::BUSY_REPEAT_REQUEST, "NRC_BUSY_REPEAT_REQUEST"},
-        {NegativeResponseCode::CONDITIONS_NOT_CORRECT, "NRC_CONDITIONS_NOT_CORRECT"},
-        {NegativeResponseCode::REQUEST_OUT_OF_RANGE, "NRC_REQUEST_OUT_OF_RANGE"},
-        {NegativeResponseCode::SECURITY_ACCESS_DENIED, "NRC_SECURITY_ACCESS_DENIED"},
-        {NegativeResponseCode::INVALID_KEY, "NRC_INVALID_KEY"}
-    };
-
-    bool checkPayload_isValid(const uint8_t SID, const std::optional<std::vector<uint8_t>> &payload);
+    // key: NAD << 8 | id
+    std::unordered_map<uint16_t, CacheEntry> readByIdCache;
+
+    // identifiers with static content: product id, serial number, user defined (32-63)
+    static constexpr bool isCacheable(const uint8_t id)
+    {
+        return (id <= static_cast<uint8_t>(CMD_Identifier::SERIAL_NUMBER)) || ((32 <= id) && (id <= 63));
+    }
+
+    // MasterRequest frame, encoded in place for every request
+    std::vector<uint8_t> requestFrame = std::vector<uint8_t>(sizeof(PDU), PDU::fillByte);
+
+    static Request encode(const uint8_t NAD, std::initializer_list<uint8_t> payload, const uint8_t newNAD = 0);
+    static Request encodeReadById(const uint8_t NAD, uint16_t supplierId, uint16_t functionId, uint8_t id);
+    static Request encodeAssignNAD(const uint8_t NAD, uint16_t supplierId, uint16_t functionId, uint8_t newNAD);
+    static Request encodeConditionalChangeNAD(const uint8_t NAD, uint8_t id, uint8_t byte, uint8_t invert, uint8_t mask, uint8_t newNAD);
+    static Request encodeDataDump(const uint8_t NAD, const std::array<uint8_t, 5> &data);
+    static Request encodeSaveConfig(const uint8_t NAD);
+    static Request encodeAssignFrameIdRange(const uint8_t NAD, uint8_t startIndex, uint8_t PID0, uint8_t PID1, uint8_t PID2, uint8_t PID3);
+
+    Result transfer(Request &request, const bool streamed = false);
+    void updateCache(const Request &request, const uint8_t initialNAD);
     inline constexpr uint8_t getRSID(const uint8_t SID);
-    const char* get_NegativeResponseCode_String(NegativeResponseCode code);
 };
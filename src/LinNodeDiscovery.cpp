@@ -0,0 +1,151 @@
+// LinNodeDiscovery.cpp
+//
+// Discovery of all nodes within a LIN cluster
+// - sweeps the NAD range by READ_BY_ID (product identification + serial number)
+// - a silent NAD is given up after the response window (P2_min), polled at once and shortly before the end of
+//   the window, an empty SlaveResponse slot is cut short (early no-response detection)
+// - result is kept in a LinNodeInventory, a restored inventory is revalidated lazily (one probe per node)
+//
+// LIN Specification 2.2A
+// Source https://www.lin-cia.org/fileadmin/microsites/lin-cia.org/resources/documents/LIN_2.2A.pdf
+
+#include "LinNodeDiscovery.hpp"
+
+#ifdef UNIT_TEST
+    #include "../test/mock_Arduino.h"
+#else
+    #include <Arduino.h>
+#endif
+
+#include <optional>
+
+/// @brief Sweep a range of NADs and update the inventory
+/// @details every NAD gets a READ_BY_ID (product identification), a responding node is asked for
+/// its serial number right away. A NAD which stays silent within the response window is skipped,
+/// it is polled twice instead of in every SlaveResponse slot.
+/// @param inventory updated: responding nodes are added, silent NADs of the range are removed
+/// @param first first NAD of the sweep
+/// @param last last NAD of the sweep (included)
+/// @return count of responding nodes within the range
+size_t LinNodeDiscovery::discover(LinNodeInventory &inventory, const uint8_t first, const uint8_t last)
+{
+    size_t found = 0;
+    for (uint16_t NAD = first; NAD <= last; ++NAD)
+    {
+        if (probe(inventory, static_cast<uint8_t>(NAD))) {
+            found++;
+        }
+    }
+    return found;
+}
+
+/// @brief Identify a single NAD with early no-response detection and update the inventory
+/// @param inventory updated: node is added, or removed if silent
+/// @param NAD Node Address
+/// @return node responded
+bool LinNodeDiscovery::probe(LinNodeInventory &inventory, const uint8_t NAD)
+{
+    // shorten the wait for silent nodes, learned nodes keep their own timeout
+    const auto timeout_NoResponse_restore = timeout_NoResponse;
+    const auto timeout_default_restore = timingProfile.timeout_default;
+    const auto pollInterval_default_restore = timingProfile.pollInterval_default;
+    timeout_NoResponse = getResponseTimeMax(sizeof(PDU));
+    timingProfile.timeout_default = responseWindow;
+    timingProfile.pollInterval_default = getWindowPollInterval();
+
+    bool found = identify(inventory, NAD);
+
+    timeout_NoResponse = timeout_NoResponse_restore;
+    timingProfile.timeout_default = timeout_default_restore;
+    timingProfile.pollInterval_default = pollInterval_default_restore;
+
+    if (!found) {
+        inventory.remove(NAD);
+    }
+    return found;
+}
+
+/// @brief Confirm a node of a restored inventory, before it is used the first time
+/// @details a node is validated only once: the first call costs a single READ_BY_ID exchange,
+/// all following calls are answered from the inventory. A node which does not confirm its
+/// identity (silent, or replaced by another node) is removed from the inventory.
+/// @param inventory e.g. restored by LinNodeInventory::load()
+/// @param NAD Node Address
+/// @return validated entry or nullptr
+const LinNodeInventory::Node* LinNodeDiscovery::validate(LinNodeInventory &inventory, const uint8_t NAD)
+{
+    const LinNodeInventory::Node* node = inventory.find(NAD);
+    if (!node || node->validated) {
+        return node;
+    }
+
+    const auto timeout_NoResponse_restore = timeout_NoResponse;
+    timeout_NoResponse = getResponseTimeMax(sizeof(PDU));
+
+    bool confirmed = confirm(*node);
+
+    timeout_NoResponse = timeout_NoResponse_restore;
+
+    if (!confirmed) {
+        inventory.remove(NAD);
+        return nullptr;
+    }
+
+    LinNodeInventory::Node validated = *node;
+    validated.validated = true;
+    return &inventory.update(validated);
+}
+
+/// @brief Single probe: node does still answer with the stored identity
+/// @details supplier and function id are used as filter of the request, the serial number
+/// (if known) distinguishes between identical nodes
+/// @param node stored entry
+/// @return identity confirmed
+bool LinNodeDiscovery::confirm(const LinNodeInventory::Node &node)
+{
+    uint8_t nad = node.NAD;
+    if (node.serialNumber) {
+        uint32_t serialNumber = 0;
+        return readSerialNumber(nad, node.supplierId, node.functionId, serialNumber) && (serialNumber == node.serialNumber.value());
+    }
+
+    uint16_t supplierId = node.supplierId;
+    uint16_t functionId = node.functionId;
+    uint8_t variantId = 0;
+    return readProductId(nad, supplierId, functionId, variantId) && (variantId == node.variantId);
+}
+
+/// @brief Read product identification and serial number of a node
+/// @param inventory updated on success
+/// @param NAD Node Address
+/// @return node responded with its product identification
+bool LinNodeDiscovery::identify(LinNodeInventory &inventory, const uint8_t NAD)
+{
+    LinNodeInventory::Node node {};
+    node.NAD = NAD;
+    node.supplierId = 0x7FFF; // wildcard
+    node.functionId = 0x3FFF; // wildcard
+
+    uint8_t nad = NAD;
+    if (!readProductId(nad, node.supplierId, node.functionId, node.variantId)) {
+        return false;
+    }
+
+    // optional service: a node without serial number is still a valid node
+    nad = NAD;
+    uint32_t serialNumber = 0;
+    if (readSerialNumber(nad, node.supplierId, node.functionId, serialNumber)) {
+        node.serialNumber = serialNumber;
+    }
+    node.latency = timingProfile.getLatency(NAD);
+    node.validated = true;
+
+    // frame ids are not readable from the node: keep the known assignment of the same product
+    const LinNodeInventory::Node* known = inventory.find(NAD);
+    if (known && (known->supplierId == node.supplierId) && (known->functionId == node.functionId)) {
+        node.PIDs = known->PIDs;
+    }
+
+    inventory.update(node);
+    return true;
+}
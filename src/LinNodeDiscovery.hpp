@@ -0,0 +1,54 @@
+// LinNodeDiscovery.hpp
+//
+// Discovery of all nodes within a LIN cluster
+// - sweeps the NAD range by READ_BY_ID (product identification + serial number)
+// - a silent NAD is given up after the response window (P2_min), polled at once and shortly before the end of
+//   the window, an empty SlaveResponse slot is cut short (early no-response detection)
+// - result is kept in a LinNodeInventory, a restored inventory is revalidated lazily (one probe per node)
+//
+// LIN Specification 2.2A
+// Source https://www.lin-cia.org/fileadmin/microsites/lin-cia.org/resources/documents/LIN_2.2A.pdf
+
+#pragma once
+
+#ifdef UNIT_TEST
+    #include "../test/mock_HardwareSerial.h"
+    using HardwareSerial = mock_HardwareSerial;
+#else
+    #include <Arduino.h>
+#endif
+
+#include "LinNodeConfig.hpp"
+#include "LinNodeInventory.hpp"
+
+class LinNodeDiscovery : protected LinNodeConfig {
+public:
+    using LinNodeConfig::LinNodeConfig;
+    using LinNodeConfig::timingProfile;
+    using LinNodeConfig::frameStats;
+    using LinNodeConfig::logger;
+    using LinNodeConfig::trace;
+    using LinNodeConfig::drainLog;
+
+    // LIN 2.2A Spec 4.2.3.2 NAD: 0x01 - 0x7D are valid node addresses
+    static constexpr uint8_t NAD_first = 0x01;
+    static constexpr uint8_t NAD_last = 0x7D;
+
+    // time a NAD without learned latency gets to answer, before it is treated as empty [ms]
+    // a node is not obligated to answer before P2_min, a shorter window drops slow nodes from the inventory
+    uint16_t responseWindow = LinTimingProfile::P2_min;
+
+    size_t discover(LinNodeInventory &inventory, const uint8_t first = NAD_first, const uint8_t last = NAD_last);
+    bool probe(LinNodeInventory &inventory, const uint8_t NAD);
+    const LinNodeInventory::Node* validate(LinNodeInventory &inventory, const uint8_t NAD);
+
+protected:
+    bool identify(LinNodeInventory &inventory, const uint8_t NAD);
+    bool confirm(const LinNodeInventory::Node &node);
+
+    // hold off after an empty poll within the response window: a silent NAD is polled twice, not in every slot
+    uint16_t getWindowPollInterval() const
+    {
+        return (responseWindow > 2 * LinTimingProfile::timeout_min) ? responseWindow - 2 * LinTimingProfile::timeout_min : 0;
+    }
+};
@@ -0,0 +1,209 @@
+// LinNodeInventory.hpp
+//
+// In-memory inventory of the nodes within a LIN cluster
+// - one entry per NAD: product identification, serial number and response latency
+// - filled by LinNodeDiscovery, entries are kept sorted by NAD
+// - persisted as versioned binary blob by a LinInventoryStorage, for a warm startup
+//
+// LIN Specification 2.2A
+// Source https://www.lin-cia.org/fileadmin/microsites/lin-cia.org/resources/documents/LIN_2.2A.pdf
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include <array>
+#include <algorithm>
+
+#include "LinInventoryStorage.hpp"
+
+class LinNodeInventory {
+public:
+    // LIN 2.2A Spec 4.2.1 LIN Product Identification
+    struct Node {
+        uint8_t NAD;
+        uint16_t supplierId;
+        uint16_t functionId;
+        uint8_t variantId;
+        std::optional<uint32_t> serialNumber; // optional service of a node
+        uint16_t latency;                     // typical response latency [ms]
+        std::array<uint8_t, 4> PIDs {0xFF, 0xFF, 0xFF, 0xFF}; // assigned frame ids (0xFF = unassigned)
+        bool validated = false;               // confirmed by the bus since startup (not persisted)
+    };
+
+    // layout of blob: magic, version, count, count * node, CRC
+    static constexpr uint8_t blobVersion = 1;
+
+    using const_iterator = std::vector<Node>::const_iterator;
+
+    /// @brief Lookup a node
+    /// @param NAD Node Address
+    /// @return entry or nullptr, when the NAD is unknown
+    const Node* find(const uint8_t NAD) const
+    {
+        auto it = lowerBound(NAD);
+        return ((it != nodes.end()) && (it->NAD == NAD)) ? &(*it) : nullptr;
+    }
+
+    /// @brief Insert a node, or replace the entry of the same NAD
+    /// @param node identified node
+    /// @return stored entry (valid until the next modification of the inventory)
+    const Node& update(const Node& node)
+    {
+        auto it = lowerBound(node.NAD);
+        if ((it != nodes.end()) && (it->NAD == node.NAD)) {
+            *it = node;
+            return *it;
+        }
+        return *nodes.insert(it, node);
+    }
+
+    /// @brief Forget a node (e.g. it does not respond anymore)
+    /// @param NAD Node Address
+    /// @return node was known
+    bool remove(const uint8_t NAD)
+    {
+        auto it = lowerBound(NAD);
+        if ((it == nodes.end()) || (it->NAD != NAD)) {
+            return false;
+        }
+        nodes.erase(it);
+        return true;
+    }
+
+    /// @brief Encode inventory into a compact binary blob
+    /// @details little endian: 'L' 'N' version count {NAD flags supplier function variant serial latency PID[4]} CRC16
+    /// @return blob
+    std::vector<uint8_t> serialize() const
+    {
+        std::vector<uint8_t> blob;
+        blob.reserve(headerSize + nodes.size() * nodeSize + sizeof(uint16_t));
+        blob.insert(blob.end(), {'L', 'N', blobVersion, static_cast<uint8_t>(nodes.size())});
+
+        for (const Node& node : nodes)
+        {
+            const uint32_t serial = node.serialNumber.value_or(0);
+            blob.insert(blob.end(), {
+                node.NAD,
+                static_cast<uint8_t>(node.serialNumber ? FLAG_SERIAL_NUMBER : 0),
+                lo(node.supplierId), hi(node.supplierId),
+                lo(node.functionId), hi(node.functionId),
+                node.variantId,
+                static_cast<uint8_t>(serial), static_cast<uint8_t>(serial >> 8),
+                static_cast<uint8_t>(serial >> 16), static_cast<uint8_t>(serial >> 24),
+                lo(node.latency), hi(node.latency)
+            });
+            blob.insert(blob.end(), node.PIDs.begin(), node.PIDs.end());
+        }
+
+        const uint16_t crc = getCrc16(blob.data(), blob.size());
+        blob.push_back(lo(crc));
+        blob.push_back(hi(crc));
+        return blob;
+    }
+
+    /// @brief Replace inventory by the content of a blob, all nodes are marked as not validated
+    /// @param blob created by serialize()
+    /// @return blob was valid (inventory is unchanged otherwise)
+    bool deserialize(const std::vector<uint8_t> &blob)
+    {
+        if ((blob.size() < headerSize + sizeof(uint16_t)) || ('L' != blob[0]) || ('N' != blob[1]) || (blobVersion != blob[2])) {
+            return false;
+        }
+        const size_t count = blob[3];
+        const size_t payloadSize = headerSize + count * nodeSize;
+        if (blob.size() != payloadSize + sizeof(uint16_t)) {
+            return false;
+        }
+        if (getCrc16(blob.data(), payloadSize) != (blob[payloadSize] | blob[payloadSize + 1] << 8)) {
+            return false;
+        }
+
+        std::vector<Node> restored;
+        restored.reserve(count);
+        for (const uint8_t* p = &blob[headerSize]; p < &blob[payloadSize]; p += nodeSize)
+        {
+            Node node {};
+            node.NAD = p[0];
+            node.supplierId = p[2] | p[3] << 8;
+            node.functionId = p[4] | p[5] << 8;
+            node.variantId = p[6];
+            if (p[1] & FLAG_SERIAL_NUMBER) {
+                node.serialNumber = static_cast<uint32_t>(p[7] | p[8] << 8 | p[9] << 16) | static_cast<uint32_t>(p[10]) << 24;
+            }
+            node.latency = p[11] | p[12] << 8;
+            std::copy_n(p + 13, node.PIDs.size(), node.PIDs.begin());
+            node.validated = false;
+
+            // STRICT: sorted and unique, as written by serialize()
+            if (!restored.empty() && (restored.back().NAD >= node.NAD)) {
+                return false;
+            }
+            restored.push_back(node);
+        }
+
+        nodes = std::move(restored);
+        return true;
+    }
+
+    /// @brief Restore inventory from storage
+    /// @param storage source
+    /// @return valid inventory was found
+    bool load(LinInventoryStorage &storage)
+    {
+        std::vector<uint8_t> blob;
+        return storage.load(blob) && deserialize(blob);
+    }
+
+    /// @brief Persist inventory
+    /// @param storage destination
+    /// @return success
+    bool store(LinInventoryStorage &storage) const
+    {
+        return storage.store(serialize());
+    }
+
+    void clear() { nodes.clear(); }
+    size_t size() const { return nodes.size(); }
+    bool empty() const { return nodes.empty(); }
+
+    const_iterator begin() const { return nodes.begin(); }
+    const_iterator end() const { return nodes.end(); }
+
+private:
+    static constexpr size_t headerSize = 4;
+    static constexpr size_t nodeSize = 17;
+    static constexpr uint8_t FLAG_SERIAL_NUMBER = 0x01;
+
+    std::vector<Node> nodes; // sorted by NAD
+
+    static uint8_t lo(uint16_t value) { return static_cast<uint8_t>(value); }
+    static uint8_t hi(uint16_t value) { return static_cast<uint8_t>(value >> 8); }
+
+    /// @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF)
+    static uint16_t getCrc16(const uint8_t* data, size_t length)
+    {
+        uint16_t crc = 0xFFFF;
+        for (size_t i = 0; i < length; ++i)
+        {
+            crc ^= static_cast<uint16_t>(data[i]) << 8;
+            for (uint8_t bit = 0; bit < 8; ++bit) {
+                crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+            }
+        }
+        return crc;
+    }
+
+    std::vector<Node>::iterator lowerBound(const uint8_t NAD)
+    {
+        return std::lower_bound(nodes.begin(), nodes.end(), NAD,
+            [](const Node& node, const uint8_t value) { return node.NAD < value; });
+    }
+
+    std::vector<Node>::const_iterator lowerBound(const uint8_t NAD) const
+    {
+        return std::lower_bound(nodes.begin(), nodes.end(), NAD,
+            [](const Node& node, const uint8_t value) { return node.NAD < value; });
+    }
+};
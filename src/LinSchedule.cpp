@@ -0,0 +1,86 @@
+// LinSchedule.cpp
+//
+// Schedule table of a LIN master, pipelined header and response
+//
+// LIN Specification 2.2A
+// Source https://www.lin-cia.org/fileadmin/microsites/lin-cia.org/resources/documents/LIN_2.2A.pdf
+
+#include "LinSchedule.hpp"
+
+#ifdef UNIT_TEST
+    #include "../test/mock_micros.h"
+#else
+    #include <Arduino.h>
+#endif
+
+/// @brief Append a frame to the schedule, its header is prepared now
+/// @param frameID FrameID of an unconditional frame
+/// @param dataLength expected length of the response [0..8]
+/// @param slot_us time from this header to the next one [us], 0 = back-to-back
+void LinSchedule::add(const uint8_t frameID, const uint8_t dataLength, const uint32_t slot_us)
+{
+    entries.push_back({bus.prepareFrameHead(frameID, dataLength), slot_us});
+}
+
+void LinSchedule::clear()
+{
+    entries.clear();
+}
+
+/// @brief Read all frames of the schedule
+/// @details the result of a frame is handled after the header of the next frame was sent,
+/// the handler runs while header and response of the next frame are on the bus
+/// @param handler called once per frame, in order of the schedule
+/// @param rounds count of passes through the schedule
+/// @return count of frames with valid response
+size_t LinSchedule::run(const Handler &handler, const size_t rounds)
+{
+    const size_t total = entries.size() * rounds;
+    size_t succeeded = 0;
+
+    const Entry* previous = nullptr;
+    std::optional<std::vector<uint8_t>> result;
+    uint32_t slotStart = 0;
+
+    for (size_t i = 0; i < total; ++i)
+    {
+        const Entry &entry = entries[i % entries.size()];
+
+        // next header at the boundary of the previous slot
+        if (previous) {
+            waitForSlot(slotStart, previous->slot_us);
+        }
+        slotStart = micros();
+        bus.sendFrameHead(entry.head);
+
+        // previous frame is handled, while this one is on the bus
+        if (previous) {
+            handler(previous->head.frameID, result);
+        }
+
+        result = bus.receiveResponse(entry.head);
+        frames++;
+        if (result) {
+            succeeded++;
+        } else {
+            failures++;
+        }
+        previous = &entry;
+    }
+
+    if (previous) {
+        // each break flushes the frame before, the last frame is flushed here: the UART is idle on return
+        bus.driver.flush();
+        handler(previous->head.frameID, result);
+    }
+
+    return succeeded;
+}
+
+void LinSchedule::waitForSlot(const uint32_t slotStart, const uint32_t slot_us)
+{
+    const uint32_t elapsed = micros() - slotStart;
+    if (elapsed < slot_us) {
+        delayMicroseconds(slot_us - elapsed);
+    }
+}
@@ -0,0 +1,52 @@
+// LinSchedule.hpp
+//
+// Schedule table of a LIN master: frames are read in a fixed order, round by round
+// - pipelined: the header of the next frame is sent as soon as the current frame is complete (or at its slot boundary),
+//   the result of a frame is passed to the handler while the next frame is on the bus
+// - headers are prepared once (PID), no work is left between the end of a frame and the next header
+// - slot time per entry: the next header is sent exactly at the slot boundary, 0 = back-to-back
+//
+// LIN Specification 2.2A
+// Source https://www.lin-cia.org/fileadmin/microsites/lin-cia.org/resources/documents/LIN_2.2A.pdf
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "LinFrameTransfer.hpp"
+
+class LinSchedule {
+public:
+    // result of a frame: received data, std::nullopt on failure
+    using Handler = std::function<void(const uint8_t frameID, const std::optional<std::vector<uint8_t>>& data)>;
+
+    struct Entry {
+        LinFrameTransfer::FrameHead head;
+        uint32_t slot_us;   // time from this header to the next one (LIN 2.2A Spec 2.4: TFrame_Slot), 0 = back-to-back
+    };
+
+    explicit LinSchedule(LinFrameTransfer &bus) :
+        bus(bus)
+    {}
+
+    void add(const uint8_t frameID, const uint8_t dataLength = 8, const uint32_t slot_us = 0);
+    void clear();
+    const std::vector<Entry>& getEntries() const { return entries; }
+
+    size_t run(const Handler &handler, const size_t rounds = 1);
+
+    uint32_t getFrames() const { return frames; }
+    uint32_t getFailures() const { return failures; }
+
+protected:
+    LinFrameTransfer &bus;
+    std::vector<Entry> entries;
+
+    uint32_t frames = 0;    // frames read
+    uint32_t failures = 0;  // frames without valid response
+
+    void waitForSlot(const uint32_t slotStart, const uint32_t slot_us);
+};
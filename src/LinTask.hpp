@@ -0,0 +1,194 @@
+// LinTask.hpp
+//
+// Coroutine type of the optional coroutine API (C++20), see LinAsyncTransportLayer
+// - lazy: started by co_await of the calling coroutine, or by start() of a top level flow
+// - the caller is resumed when the task has finished (symmetric transfer, no nesting of the stack)
+// - coroutine frames are allocated from a fixed block pool, a frame exceeding a block falls back to the heap
+// - single threaded: all flows are resumed by the poll() loop of the bus
+//
+// Available with compiler support of coroutines only (e.g. -std=gnu++20)
+
+#pragma once
+
+#if defined(__cpp_impl_coroutine)
+
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <new>
+#include <optional>
+#include <utility>
+
+template <size_t BlockSize, size_t BlockCount>
+class LinCoroutinePool {
+public:
+    LinCoroutinePool()
+    {
+        for (size_t i = 0; i < BlockCount; ++i) {
+            blocks[i].next = (i + 1 < BlockCount) ? &blocks[i + 1] : nullptr;
+        }
+        freeList = &blocks[0];
+    }
+
+    LinCoroutinePool(const LinCoroutinePool&) = delete;
+    LinCoroutinePool& operator=(const LinCoroutinePool&) = delete;
+
+    void* allocate(const size_t size)
+    {
+        if ((size <= BlockSize) && freeList) {
+            Block* block = freeList;
+            freeList = block->next;
+            used++;
+            return block->storage;
+        }
+        // frame too large or pool exhausted
+        fallbacks++;
+        return ::operator new(size);
+    }
+
+    void deallocate(void* pointer)
+    {
+        if (!owns(pointer)) {
+            ::operator delete(pointer);
+            return;
+        }
+        Block* block = reinterpret_cast<Block*>(pointer);
+        block->next = freeList;
+        freeList = block;
+        used--;
+    }
+
+    static constexpr size_t getBlockSize() { return BlockSize; }
+    size_t getUsed() const { return used; }
+    size_t getFallbacks() const { return fallbacks; }
+
+private:
+    union Block {
+        Block* next;
+        alignas(std::max_align_t) unsigned char storage[BlockSize];
+    };
+
+    std::array<Block, BlockCount> blocks;
+    Block* freeList = nullptr;
+    size_t used = 0;
+    size_t fallbacks = 0; // count of frames allocated from the heap
+
+    bool owns(const void* pointer) const
+    {
+        const auto* p = static_cast<const unsigned char*>(pointer);
+        const auto* first = reinterpret_cast<const unsigned char*>(blocks.data());
+        return (p >= first) && (p < first + sizeof(blocks));
+    }
+};
+
+// shared by all coroutine flows
+// a request() of the transport layer keeps two frames (request and its transaction) while running
+inline LinCoroutinePool<768, 16> linCoroutinePool;
+
+template <typename T>
+class LinTask {
+public:
+    struct promise_type {
+        std::optional<T> value;
+        std::coroutine_handle<> continuation;
+
+        LinTask get_return_object()
+        {
+            return LinTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        auto final_suspend() noexcept
+        {
+            struct Resume {
+                bool await_ready() noexcept { return false; }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> coroutine) noexcept
+                {
+                    auto caller = coroutine.promise().continuation;
+                    return caller ? caller : std::noop_coroutine();
+                }
+                void await_resume() noexcept {}
+            };
+            return Resume {};
+        }
+
+        template <typename U>
+        void return_value(U&& result)
+        {
+            value.emplace(std::forward<U>(result));
+        }
+
+        // no exceptions on the target
+        void unhandled_exception() { std::terminate(); }
+
+        static void* operator new(const size_t size) { return linCoroutinePool.allocate(size); }
+        static void operator delete(void* pointer) { linCoroutinePool.deallocate(pointer); }
+    };
+
+    LinTask(LinTask&& other) noexcept :
+        coroutine(std::exchange(other.coroutine, nullptr))
+    {}
+
+    LinTask(const LinTask&) = delete;
+    LinTask& operator=(const LinTask&) = delete;
+    LinTask& operator=(LinTask&&) = delete;
+
+    ~LinTask()
+    {
+        if (coroutine) {
+            coroutine.destroy();
+        }
+    }
+
+    /// @brief Run a top level flow until its first suspension, continued by poll() of the bus
+    /// @details a task is either started or awaited, not both
+    void start()
+    {
+        if (coroutine && !started) {
+            started = true;
+            coroutine.resume();
+        }
+    }
+
+    bool done() const
+    {
+        return coroutine && coroutine.done();
+    }
+
+    /// @brief Result of a finished task
+    T& result()
+    {
+        return *coroutine.promise().value;
+    }
+
+    // awaited by a calling coroutine: started now, the caller is resumed on completion
+    bool await_ready() const noexcept
+    {
+        return done();
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept
+    {
+        coroutine.promise().continuation = caller;
+        started = true;
+        return coroutine;
+    }
+
+    T await_resume()
+    {
+        return std::move(*coroutine.promise().value);
+    }
+
+private:
+    explicit LinTask(std::coroutine_handle<promise_type> handle) :
+        coroutine(handle)
+    {}
+
+    std::coroutine_handle<promise_type> coroutine;
+    bool started = false;
+};
+
+#endif // __cpp_impl_coroutine
@@ -0,0 +1,160 @@
+// LinTimingProfile.hpp
+//
+// Provides per node (NAD) response timing for the Diagnostic Transport Layer (DTL)
+// - learns the response latency of every slave node by a running percentile estimate
+// - derives timeout and polling interval of the SlaveResponse frame within the bounds of the spec
+//
+// LIN Specification 2.2A
+// Source https://www.lin-cia.org/fileadmin/microsites/lin-cia.org/resources/documents/LIN_2.2A.pdf
+
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <array>
+
+class LinTimingProfile {
+public:
+    // LIN2.2A Spec 3.2.5 Timing constraints
+    static constexpr uint16_t P2_min = 50;     // ms - master may poll the response earlier, but node is not obligated to answer
+    static constexpr uint16_t N_As = 1000;     // ms - max. time until the slave response is transmitted
+    static constexpr uint16_t timeout_min = 10; // ms - about one SlaveResponse frame slot including jitter
+
+    // timeout used for nodes without any learned latency (legacy behaviour)
+    uint16_t timeout_default = 50; // ms - Spec has higher timeout: ~1 second
+    // hold off after an empty poll of a node without learned latency, 0 = poll every slot
+    uint16_t pollInterval_default = 0; // ms
+
+    // count of samples before the estimation is trusted
+    static constexpr uint16_t samples_min = 4;
+
+    struct Estimate {
+        uint16_t p50;     // running median of the response latency [1/16 ms]
+        uint16_t p90;     // running 90th percentile of the response latency [1/16 ms]
+        uint16_t samples; // count of recorded responses (saturates)
+        uint16_t timeouts; // count of missed responses (saturates)
+    };
+
+    /// @brief Adds a observed response latency of a node to its estimation
+    /// @param NAD Node Address of the responding node
+    /// @param latency time between end of request and first response frame [ms]
+    void recordLatency(const uint8_t NAD, const uint16_t latency)
+    {
+        Estimate& e = nodes[NAD & MASK_NAD];
+        uint32_t sample = std::min<uint32_t>(latency, N_As) << FRACTION_BITS;
+
+        if (0 == e.samples) {
+            e.p50 = static_cast<uint16_t>(sample);
+            e.p90 = static_cast<uint16_t>(sample);
+        } else {
+            e.p50 = updateQuantile(e.p50, sample, 50);
+            e.p90 = updateQuantile(e.p90, sample, 90);
+            // p90 shall never undercut the median
+            e.p90 = std::max(e.p90, e.p50);
+        }
+
+        if (e.samples < UINT16_MAX) {
+            e.samples++;
+        }
+    }
+
+    /// @brief Node did not respond within the timeout: widen the estimation
+    /// @details a timeout is only a lower bound of the real latency, the estimation grows stepwise
+    /// until the node is answering within the derived timeout (limited by N_As)
+    /// @param NAD Node Address of the silent node
+    void recordTimeout(const uint8_t NAD)
+    {
+        Estimate& e = nodes[NAD & MASK_NAD];
+        if (e.timeouts < UINT16_MAX) {
+            e.timeouts++;
+        }
+        if (e.samples < samples_min) {
+            // unknown or silent node: do not learn out of nothing
+            return;
+        }
+        uint32_t widened = std::min<uint32_t>(e.p90 * 2u, N_As << FRACTION_BITS);
+        e.p90 = static_cast<uint16_t>(widened);
+    }
+
+    /// @brief Timeout for the (first) SlaveResponse frame of a node
+    /// @param NAD Node Address (wildcards will use the default)
+    /// @return timeout [ms], limited to spec bounds
+    uint16_t getTimeout(const uint8_t NAD) const
+    {
+        const Estimate& e = nodes[NAD & MASK_NAD];
+        if (e.samples < samples_min) {
+            return timeout_default;
+        }
+        // twice the 90th percentile covers the tail, plus one frame slot for the SlaveResponse itself
+        uint32_t timeout = ((e.p90 * 2u) >> FRACTION_BITS) + timeout_min;
+        return static_cast<uint16_t>(std::clamp<uint32_t>(timeout, timeout_min, N_As));
+    }
+
+    /// @brief Hold off time before polling the SlaveResponse frame (after request, or after an empty poll)
+    /// @details a fast node gets polled immediately, a slow node is polled shortly before its answer is expected
+    /// @param NAD Node Address (wildcards will use the default)
+    /// @return delay [ms], limited to P2_min
+    uint16_t getPollInterval(const uint8_t NAD) const
+    {
+        const Estimate& e = nodes[NAD & MASK_NAD];
+        if (e.samples < samples_min) {
+            return 0;
+        }
+        // half of the median: keeps the count of empty polls low, without delaying the response
+        uint32_t interval = e.p50 >> (FRACTION_BITS + 1);
+        return static_cast<uint16_t>(std::min<uint32_t>(interval, P2_min));
+    }
+
+    /// @brief Typical response latency of a node
+    /// @param NAD Node Address
+    /// @return running median [ms], 0 for a node without any response
+    uint16_t getLatency(const uint8_t NAD) const
+    {
+        return nodes[NAD & MASK_NAD].p50 >> FRACTION_BITS;
+    }
+
+    /// @brief Access the raw estimation of a node
+    /// @param NAD Node Address
+    /// @return Estimate (values in 1/16 ms)
+    const Estimate& getEstimate(const uint8_t NAD) const
+    {
+        return nodes[NAD & MASK_NAD];
+    }
+
+    /// @brief Forget all learned latencies
+    void reset()
+    {
+        nodes.fill({});
+    }
+
+    /// @brief Forget learned latency of a single node (e.g. after NAD was changed)
+    /// @param NAD Node Address
+    void reset(const uint8_t NAD)
+    {
+        nodes[NAD & MASK_NAD] = {};
+    }
+
+private:
+    static constexpr uint8_t FRACTION_BITS = 4; // fixed point: 1/16 ms
+    static constexpr uint8_t MASK_NAD = 0x7F;   // 0x00..0x7F, free usage NADs are folded
+
+    std::array<Estimate, MASK_NAD + 1> nodes {};
+
+    /// @brief stochastic approximation of a quantile, step size adapts to the magnitude of the estimate
+    /// @param estimate current estimation [1/16 ms]
+    /// @param sample new sample [1/16 ms]
+    /// @param percent quantile to estimate (50 = median)
+    /// @return new estimation
+    static uint16_t updateQuantile(const uint16_t estimate, const uint32_t sample, const uint32_t percent)
+    {
+        // step: 1/8 of estimation, at least 1ms
+        uint32_t step = std::max<uint32_t>(estimate >> 3, 1u << FRACTION_BITS);
+        int32_t next = estimate;
+        if (sample > estimate) {
+            next += static_cast<int32_t>(std::min(step * percent / 100, sample - estimate));
+        } else if (sample < estimate) {
+            next -= static_cast<int32_t>(std::min(step * (100 - percent) / 100, estimate - sample));
+        }
+        return static_cast<uint16_t>(std::clamp<int32_t>(next, 0, N_As << FRACTION_BITS));
+    }
+};
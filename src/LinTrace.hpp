@@ -0,0 +1,172 @@
+// LinTrace.hpp
+//
+// Optional tracepoints of the hot path: where does the time of a frame (or PDU) go
+// - stages of a frame: break, header, flush, echo done, first response byte, checksum, completion
+// - stages of a PDU: request written, first response frame, completion
+// - every stage records the time since the previous stage of its frame (or PDU) [us]
+// - aggregated into histograms with fixed buckets (powers of 2), no allocation
+// - read by getHistogram() or dumped over a Stream (e.g. debugStream)
+//
+// Compiled in by the build flag -D LIN_TRACE only, otherwise the tracepoints are removed.
+// One trace per bus (LinFrameTransfer::trace), updated by the task owning the bus (see LinBusExecutor).
+// Not synchronized: read or dumped by the owner of the bus, or while the bus is idle.
+
+#pragma once
+
+#ifdef UNIT_TEST
+    #include "../test/mock_Stream.h"
+    using Stream = mock_Stream;
+    #include "../test/mock_micros.h"
+#else
+    #include <Arduino.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+enum class LinTraceStage : uint8_t {
+    // frame (LinFrameTransfer, FrameReader)
+    Break,              // break sent (incl. flush of the previous frame)
+    Header,             // sync and PID written
+    Flush,              // transmission of the frame awaited
+    EchoDone,           // readback verified (head, or full frame on write)
+    FirstResponseByte,  // waiting for the node
+    Checksum,           // response received and checksum valid
+    Complete,           // frame returned to the caller
+    // PDU (LinTransportLayer)
+    PduRequest,         // all frames of the request written
+    PduFirstResponse,   // first frame of the response received
+    PduComplete,        // response reassembled
+    Count
+};
+
+class LinTraceHistogram {
+public:
+    // bucket i: [2^i, 2^(i+1)) us, bucket 0: [0, 2) us, last bucket: all above
+    static constexpr size_t bucketCount = 16;
+
+    void record(const uint32_t us)
+    {
+        size_t bucket = 0;
+        for (uint32_t value = us >> 1; value && (bucket < bucketCount - 1); value >>= 1) {
+            bucket++;
+        }
+        buckets[bucket]++;
+        count++;
+        sum += us;
+        min = std::min(min, us);
+        max = std::max(max, us);
+    }
+
+    uint32_t getCount() const { return count; }
+    uint32_t getMin() const { return count ? min : 0; }
+    uint32_t getMax() const { return max; }
+    uint32_t getMean() const { return count ? static_cast<uint32_t>(sum / count) : 0; }
+    const std::array<uint32_t, bucketCount>& getBuckets() const { return buckets; }
+
+    /// @brief lower limit of a bucket [us]
+    static uint32_t getBucketFloor(const size_t bucket) { return bucket ? (1u << bucket) : 0; }
+
+private:
+    std::array<uint32_t, bucketCount> buckets {};
+    uint32_t count = 0;
+    uint64_t sum = 0;
+    uint32_t min = UINT32_MAX;
+    uint32_t max = 0;
+};
+
+class LinTrace {
+public:
+    enum class Track : uint8_t {
+        Frame,
+        Pdu
+    };
+
+    /// @brief start of a frame or PDU, reference of its first stage
+    void begin(const Track track)
+    {
+        last[static_cast<size_t>(track)] = micros();
+    }
+
+    /// @brief stage reached, the time since the previous stage is recorded
+    void stage(const LinTraceStage stage)
+    {
+        const uint32_t now = micros();
+        uint32_t &previous = last[static_cast<size_t>(getTrack(stage))];
+        histograms[static_cast<size_t>(stage)].record(now - previous);
+        previous = now;
+    }
+
+    const LinTraceHistogram& getHistogram(const LinTraceStage stage) const
+    {
+        return histograms[static_cast<size_t>(stage)];
+    }
+
+    void reset()
+    {
+        histograms = {};
+    }
+
+    /// @brief one line per stage: count, min/mean/max [us] and the non-empty buckets (floor:count)
+    void dump(Stream &stream) const
+    {
+        static const char* const names[] = {
+            "break", "header", "flush", "echo", "response", "checksum", "complete",
+            "pdu_request", "pdu_response", "pdu_complete"
+        };
+        static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(LinTraceStage::Count), "name of each stage");
+
+        for (size_t i = 0; i < histograms.size(); ++i)
+        {
+            const LinTraceHistogram &histogram = histograms[i];
+            if (!histogram.getCount()) {
+                continue;
+            }
+            stream.print(names[i]);
+            stream.print(" n=");
+            stream.print(histogram.getCount());
+            stream.print(" min=");
+            stream.print(histogram.getMin());
+            stream.print(" mean=");
+            stream.print(histogram.getMean());
+            stream.print(" max=");
+            stream.print(histogram.getMax());
+            stream.print(" |");
+            for (size_t bucket = 0; bucket < LinTraceHistogram::bucketCount; ++bucket)
+            {
+                if (!histogram.getBuckets()[bucket]) {
+                    continue;
+                }
+                stream.print(" ");
+                stream.print(LinTraceHistogram::getBucketFloor(bucket));
+                stream.print(":");
+                stream.print(histogram.getBuckets()[bucket]);
+            }
+            stream.println();
+        }
+    }
+
+private:
+    std::array<LinTraceHistogram, static_cast<size_t>(LinTraceStage::Count)> histograms {};
+    std::array<uint32_t, 2> last {};
+
+    static Track getTrack(const LinTraceStage stage)
+    {
+        return (stage >= LinTraceStage::PduRequest) ? Track::Pdu : Track::Frame;
+    }
+};
+
+// trace of a bus, empty without tracepoints
+// the tracepoints refer to a member (or reference) named trace
+#ifdef LIN_TRACE
+    using LinBusTrace = LinTrace;
+
+    #define LIN_TRACE_BEGIN(trackName) trace.begin(LinTrace::Track::trackName)
+    #define LIN_TRACE_STAGE(stageName) trace.stage(LinTraceStage::stageName)
+#else
+    struct LinBusTrace {};
+
+    #define LIN_TRACE_BEGIN(trackName) do {} while (0)
+    #define LIN_TRACE_STAGE(stageName) do {} while (0)
+#endif
@@ -15,6 +15,7 @@
     #include <Arduino.h>
 #endif
 
+#include <map>
 #include <optional>
 #include <vector>
 #include <unordered_map>
@@ -22,6 +23,7 @@
 #include "LinPDU.hpp"
 
 // LIN2.2A Spec Table 3.2
+// timeout of the initial response is provided by timingProfile, this one applies to consecutive frames
 constexpr auto timeout_DtlSlaveResponse_per_frame = 50; // ms - Spec has higher timeout: ~1 second
 
 // ------------------------------------
@@ -33,6 +35,8 @@ constexpr auto timeout_DtlSlaveResponse_per_frame = 50; // ms - Spec has higher
 /// @return 
 std::optional<std::vector<uint8_t>> LinTransportLayer::writePDU(uint8_t &NAD, const std::vector<uint8_t>& payload, uint8_t newNAD)
 {
+    LIN_TRACE_BEGIN(Pdu);
+
     // prepare frameset
     std::vector<PDU> frameSet = framesetFromPayload(NAD, payload);
     
@@ -41,19 +45,113 @@ std::optional<std::vector<uint8_t>> LinTransportLayer::writePDU(uint8_t &NAD, co
     {
         writeFrame(FRAME_ID::MASTER_REQUEST, frame.asVector());
     }
+    LIN_TRACE_STAGE(PduRequest);
 
     // read response
     // special case: CONDITINAL_CHANGE of NAD will answer with newNAD
     return readPduResponse(NAD, newNAD);
 }
 
+/// @brief Write a PDU by streaming all frames back-to-back, without readback verification per frame
+/// @details intended for bulk transfer (e.g. TransferData), the integrity of the request is
+/// confirmed by the response of the node only
+/// @param NAD Node Address (wildcard will be replaced by received NAD)
+/// @param payload request
+/// @return response payload
+std::optional<std::vector<uint8_t>> LinTransportLayer::writePDUStreamed(uint8_t &NAD, const std::vector<uint8_t>& payload)
+{
+    LIN_TRACE_BEGIN(Pdu);
+
+    // prepare frameset
+    std::vector<PDU> frameSet = framesetFromPayload(NAD, payload);
+
+    // stream full frameset
+    for (const PDU& frame : frameSet)
+    {
+        writeFrame(FRAME_ID::MASTER_REQUEST, frame.asVector(), ReadbackPolicy::Discard);
+    }
+    LIN_TRACE_STAGE(PduRequest);
+
+    return readPduResponse(NAD);
+}
+
+/// @brief Send a request to all nodes by the functional NAD and collect the responses of every node
+/// @details one MasterRequest, followed by polling the SlaveResponse until no node answers anymore.
+/// Responses are reassembled per NAD, segmented responses of different nodes may interleave.
+/// The collection ends, when no frame was received within the default timeout.
+/// @param payload request, limited to a single frame (LIN 2.2A 3.2.1.2: functional requests are SF only)
+/// @return complete responses, grouped by NAD of responding node
+std::map<uint8_t, std::vector<uint8_t>> LinTransportLayer::writePDUFunctional(const std::vector<uint8_t>& payload)
+{
+    std::map<uint8_t, std::vector<uint8_t>> responses;
+
+    if (payload.empty() || (payload.size() > PDU::dataLenSingle)) {
+        // functional requests shall be single frames
+        return responses;
+    }
+
+    PDU request;
+    fillSingleFrame(request, PDU::NAD_Type::FUNCTIONAL, payload);
+    if (!writeFrame(FRAME_ID::MASTER_REQUEST, request.asVector())) {
+        return responses;
+    }
+
+    // reassembly of each responding node, the latency is measured from the functional request
+    std::map<uint8_t, PduReassembly> receptions;
+
+    const auto requestEnd = millis();
+    auto timeout = requestEnd + timingProfile.timeout_default;
+    while (millis() < timeout)
+    {
+        auto rxFrame = readFrame(FRAME_ID::SLAVE_REQUEST, 8);
+        if (!rxFrame || (rxFrame.value().size() != 8)) {
+            continue;
+        }
+
+        // any valid frame extends the collection
+        timeout = millis() + timingProfile.timeout_default;
+
+        PDU& frame = *reinterpret_cast<PDU*>(rxFrame.value().data());
+        uint8_t NAD = frame.getNAD();
+        auto reception = receptions.try_emplace(NAD, timingProfile, NAD, 0, timingProfile.timeout_default).first;
+        auto step = reception->second.process(frame);
+
+        if (PduReassembly::Step::Abort == step) {
+            // STRICT: sequence of this node broken, the frame may start a new response
+            receptions.erase(reception);
+            reception = receptions.try_emplace(NAD, timingProfile, NAD, 0, timingProfile.timeout_default).first;
+            step = reception->second.process(frame);
+        }
+
+        if (PduReassembly::Step::Ignored == step) {
+            // STRICT: invalid or unexpected frame type
+            receptions.erase(reception);
+            continue;
+        }
+
+        if (1 == reception->second.getFrameCount()) {
+            timingProfile.recordLatency(NAD, millis() - requestEnd);
+        }
+
+        if (PduReassembly::Step::Complete == step) {
+            auto response = reception->second.finish(NAD);
+            if (response) {
+                responses[NAD] = std::move(response.value());
+            }
+            receptions.erase(reception);
+        }
+    }
+
+    return responses;
+}
+
 std::vector<PDU> LinTransportLayer::framesetFromPayload(const uint8_t NAD, const std::vector<uint8_t>& payload)
 {
     // verify max Len 
     // if (payload.size() >= 4096) { return {}; }
 
     // Single Frame
-    if (payload.size() <= sizeof(PDU::dataLenSingle))
+    if (payload.size() <= PDU::dataLenSingle)
     {
         std::vector<PDU> frameset(1);
 
@@ -74,7 +172,7 @@ std::vector<PDU> LinTransportLayer::framesetFromPayload(const uint8_t NAD, const
     auto bytesWritten = 0;
 
     fillFirstFrame(frameset[0], NAD, payload, bytesWritten);
-    for (uint8_t i = 1; i<=CF_count; ++i)
+    for (size_t i = 1; i<=CF_count; ++i)
     {
         fillConsecutiveFrame(frameset[i], NAD, i, payload, bytesWritten);
     }
@@ -116,109 +214,176 @@ void LinTransportLayer::fillConsecutiveFrame(
 
 /// @brief Start a PDU SlaveRequest
 /// @param NAD Node Adress (via pointer), wildcard will be replaced by received NAD
+/// @param fixedTimeout timeout of the initial response [ms], 0: learned per node by timingProfile
 /// @return payload
-std::optional<std::vector<uint8_t>> LinTransportLayer::readPduResponse(uint8_t &NAD, const uint8_t newNAD)
+std::optional<std::vector<uint8_t>> LinTransportLayer::readPduResponse(uint8_t &NAD, const uint8_t newNAD, const uint16_t fixedTimeout)
 {
-    uint8_t acceptedNAD = NAD;
-    uint8_t frameCounter = 0;
-    size_t announcedBytes;
-    std::vector<uint8_t> payload {};
+    // timing of the initial response is learned per node, unless the caller knows better
+    const auto pollInterval = fixedTimeout ? 0 : timingProfile.getPollInterval(NAD);
+    const auto retryInterval = (fixedTimeout || pollInterval) ? pollInterval : timingProfile.pollInterval_default;
+    PduReassembly reassembly(timingProfile, NAD, newNAD, fixedTimeout);
+
+    if (pollInterval) {
+        // node is known to be slow: do not poll before an answer can be expected
+        delay(pollInterval);
+    }
 
-    auto timeout = millis() + timeout_DtlSlaveResponse_per_frame;
-    while (millis() < timeout)
+    while (millis() < reassembly.getTimeout())
     {
         // read first frame and process
         auto rxFrame = readFrame(FRAME_ID::SLAVE_REQUEST, 8);
         
         if (!rxFrame) {
-            debugStream.println("Failed to read initial PDU");
+            logger.logRepeated(LinLogLevel::Error, LinLogEvent::PduFrameMissing, NAD, NAD);
+            if ((0 == reassembly.getFrameCount()) && retryInterval) {
+                if (millis() + retryInterval >= reassembly.getTimeout()) {
+                    // no poll left within the timeout
+                    break;
+                }
+                delay(retryInterval);
+            }
             continue;
         }
 
         if (rxFrame.value().size() != 8)
         {
-            debugStream.println("Invalid frame size for PDU");
+            const uint8_t frameSize = static_cast<uint8_t>(rxFrame.value().size());
+            logger.logRepeated(LinLogLevel::Error, LinLogEvent::PduFrameSize, frameSize, frameSize);
             continue;
         }
 
         PDU& frame = *reinterpret_cast<PDU*>(rxFrame.value().data());
+        const auto step = reassembly.process(frame);
+        if ((PduReassembly::Step::Ignored != step) && (1 == reassembly.getFrameCount())) {
+            LIN_TRACE_STAGE(PduFirstResponse);
+        }
+        if ((PduReassembly::Step::Complete == step) || (PduReassembly::Step::Abort == step)) {
+            break;
+        }
+    }
 
-        if (0 == frameCounter)
-        {
-            /// NAD will be replaced...
-            if ((PDU::NAD_Type::BROADCAST == acceptedNAD) || // on Wildcard
-                (frame.getNAD() == newNAD))             // on NAD Change my config requect
-            {
-                // Boradcast or Cmd "Conditional Change of NAD" was successfull
-                acceptedNAD = frame.getNAD();
-            }
-
-            if (acceptedNAD != frame.getNAD())
-            {
-                // unexpected NAD: ignore Frame
-                continue;
-            }
+    auto payload = reassembly.finish(NAD);
+    if (payload) {
+        LIN_TRACE_STAGE(PduComplete);
+    }
+    return payload;
+}
 
-            if (PDU::PCI_Type::SINGLE == frame.getType()) {
-                if (!readSingleFrame(frame, payload)) {
-                    // STRICT: when announcedBytes is greater than 6 bytes, frame shall be ignored
-                    acceptedNAD = NAD; // revert in case of wildcard
-                    continue;
-                }
-                break; // success
-            }
+/// @param timingProfile timeout of the initial response, learns the latency of the node
+/// @param NAD requested Node Address, on wildcard the response of any node is accepted
+/// @param newNAD in case of SID: CONDITIONAL_CHANGE of NAD node will answer by using new NAD (0: none)
+/// @param fixedTimeout timeout of the initial response [ms], neither read from nor recorded into timingProfile (0: learned)
+LinTransportLayer::PduReassembly::PduReassembly(LinTimingProfile &timingProfile, const uint8_t NAD, const uint8_t newNAD, const uint16_t fixedTimeout) :
+    timingProfile(timingProfile),
+    requestedNAD(NAD),
+    newNAD(newNAD),
+    learning(0 == fixedTimeout),
+    acceptedNAD(NAD),
+    requestEnd(millis()),
+    timeout(requestEnd + (fixedTimeout ? fixedTimeout : timingProfile.getTimeout(NAD)))
+{}
+
+/// @brief Process a received SlaveResponse frame
+/// @param frame frame of 8 bytes
+/// @return the frame was ignored or accepted, the response is complete or aborted
+LinTransportLayer::PduReassembly::Step LinTransportLayer::PduReassembly::process(PDU &frame)
+{
+    if (aborted) {
+        return Step::Abort;
+    }
 
-            if (PDU::PCI_Type::FIRST == frame.getType()) {
-                if (!readFirstFrame(frame, payload, announcedBytes)) {
-                    // STRICT: when announcedBytes is less than 7 bytes, frame shall be ignored
-                    acceptedNAD = NAD; // revert in case of wildcard
-                    continue;
-                }
-                frameCounter++;
-                timeout = millis() + timeout_DtlSlaveResponse_per_frame;
-                continue;
-            }
+    if (0 == frameCounter)
+    {
+        /// NAD will be replaced...
+        if ((PDU::NAD_Type::BROADCAST == acceptedNAD) || // on Wildcard
+            (frame.getNAD() == newNAD))                  // on NAD Change my config requect
+        {
+            // Boradcast or Cmd "Conditional Change of NAD" was successfull
+            acceptedNAD = frame.getNAD();
+        }
 
-            // STRICT: unexpected frame type shall be ignored
-            acceptedNAD = NAD; // revert in case of wildcard
+        if (acceptedNAD != frame.getNAD())
+        {
+            // unexpected NAD: ignore Frame
+            return Step::Ignored;
+        }
 
-        } else {
-            // frameCounter == isConsecutiveFrame
-            // sequence of CF started -> error handling now changed
-            if (acceptedNAD != frame.getNAD()) {
-                // STRICT: mismatch with received NAT of FirstFrame --> abort
-                return {};
+        if (PDU::PCI_Type::SINGLE == frame.getType()) {
+            if (!readSingleFrame(frame, payload)) {
+                // STRICT: when announcedBytes is greater than 6 bytes, frame shall be ignored
+                acceptedNAD = requestedNAD; // revert in case of wildcard
+                return Step::Ignored;
             }
-
-            if (PDU::PCI_Type::CONSECUTIVE != frame.getType()) {
-                // STRICT: unexpected frame type --> abort
-                return {};
+            if (learning) {
+                timingProfile.recordLatency(acceptedNAD, millis() - requestEnd);
             }
+            announcedBytes = payload.size();
+            frameCounter++;
+            return Step::Complete; // success
+        }
 
-            if (!readConsecutiveFrame(frame, payload, announcedBytes, frameCounter)) {
-                // STRICT: unexpected sequence number received --> abort
-                return {};
+        if (PDU::PCI_Type::FIRST == frame.getType()) {
+            if (!readFirstFrame(frame, payload, announcedBytes)) {
+                // STRICT: when announcedBytes is less than 7 bytes, frame shall be ignored
+                acceptedNAD = requestedNAD; // revert in case of wildcard
+                return Step::Ignored;
             }
-
-            frameCounter++;
-            timeout += timeout_DtlSlaveResponse_per_frame;
-            if (announcedBytes == payload.size()) {
-                break; // success
+            if (learning) {
+                timingProfile.recordLatency(acceptedNAD, millis() - requestEnd);
             }
+            frameCounter++;
+            timeout = millis() + timeout_DtlSlaveResponse_per_frame;
+            return Step::Accepted;
         }
+
+        // STRICT: unexpected frame type shall be ignored
+        acceptedNAD = requestedNAD; // revert in case of wildcard
+        return Step::Ignored;
+    }
+
+    // frameCounter == isConsecutiveFrame
+    // sequence of CF started -> error handling now changed
+    if ((acceptedNAD != frame.getNAD()) ||                       // STRICT: mismatch with received NAD of FirstFrame --> abort
+        (PDU::PCI_Type::CONSECUTIVE != frame.getType()) ||       // STRICT: unexpected frame type --> abort
+        !readConsecutiveFrame(frame, payload, announcedBytes, frameCounter)) { // STRICT: unexpected sequence number --> abort
+        aborted = true;
+        return Step::Abort;
+    }
+
+    frameCounter++;
+    timeout += timeout_DtlSlaveResponse_per_frame;
+    return (announcedBytes == payload.size()) ? Step::Complete : Step::Accepted;
+}
+
+/// @brief Result of the reassembly, after completion or timeout
+/// @param NAD requested Node Address, replaced by the responding one on wildcard or NAD change
+/// @return payload, std::nullopt on timeout or protocol error
+std::optional<std::vector<uint8_t>> LinTransportLayer::PduReassembly::finish(uint8_t &NAD)
+{
+    if (aborted) {
+        return {};
     }
 
     if (payload.empty()) {
         // payload must not be empty!
+        if ((0 == frameCounter) && learning) {
+            // no initial response within timeout
+            timingProfile.recordTimeout(requestedNAD);
+        }
+        return {};
+    }
+
+    if (announcedBytes != payload.size()) {
+        // timeout within sequence of consecutive frames
         return {};
     }
 
     // success
     // may return new NAT
-    if ((PDU::NAD_Type::BROADCAST == NAD) || (0 != newNAD)) {
+    if ((PDU::NAD_Type::BROADCAST == requestedNAD) || (0 != newNAD)) {
         NAD = acceptedNAD;
     }
-    return payload;
+    return std::move(payload);
 }
 
 bool LinTransportLayer::readSingleFrame(PDU &frame, std::vector<uint8_t> &payload)
@@ -14,27 +14,74 @@
     #include <Arduino.h>
 #endif
 
+#include <map>
 #include <optional>
 #include <vector>
 
 #include "LinFrameTransfer.hpp"
 #include "LinPDU.hpp"
+#include "LinTimingProfile.hpp"
 
 class LinTransportLayer : protected LinFrameTransfer{
 public:
     using LinFrameTransfer::LinFrameTransfer;
+    using LinFrameTransfer::frameStats;
+    using LinFrameTransfer::logger;
+    using LinFrameTransfer::trace;
+    using LinFrameTransfer::drainLog;
 
     std::optional<std::vector<uint8_t>> writePDU(uint8_t &NAD, const std::vector<uint8_t>& payload, const uint8_t newNAD = 0);
+    std::optional<std::vector<uint8_t>> writePDUStreamed(uint8_t &NAD, const std::vector<uint8_t>& payload);
+    std::map<uint8_t, std::vector<uint8_t>> writePDUFunctional(const std::vector<uint8_t>& payload);
+
+    // learned response timing of each node, used to size timeout and polling of the SlaveResponse
+    LinTimingProfile timingProfile;
 
 protected:
-    inline std::vector<PDU> framesetFromPayload(const uint8_t NAD, const std::vector<uint8_t> &payload);
+    // reassembly of the response of a node (SF, or FF + CF) by the STRICT rules, frame by frame
+    // shared by the blocking readPduResponse(), writePDUFunctional() (one per node) and the coroutine API
+    class PduReassembly {
+    public:
+        enum class Step : uint8_t {
+            Ignored,    // frame is not part of the response (e.g. other NAD), keep on reading
+            Accepted,   // frame is part of the response, more frames expected
+            Complete,   // response complete
+            Abort       // sequence of consecutive frames broken
+        };
+
+        PduReassembly(LinTimingProfile &timingProfile, const uint8_t NAD, const uint8_t newNAD = 0, const uint16_t fixedTimeout = 0);
+
+        Step process(PDU &frame);
+        std::optional<std::vector<uint8_t>> finish(uint8_t &NAD);
+
+        // end of the response, extended by every accepted frame
+        unsigned long getTimeout() const { return timeout; }
+        // count of accepted frames
+        int getFrameCount() const { return frameCounter; }
+
+    private:
+        LinTimingProfile &timingProfile;
+        const uint8_t requestedNAD;
+        const uint8_t newNAD;
+        const bool learning; // latency and timeout are recorded into timingProfile
+        uint8_t acceptedNAD;
+        bool aborted = false;
+        int frameCounter = 0; // must not wrap around: up to 683 frames per PDU
+        size_t announcedBytes = 0;
+        std::vector<uint8_t> payload {};
+        const unsigned long requestEnd;
+        unsigned long timeout;
+    };
+
+    std::optional<std::vector<uint8_t>> readPduResponse(uint8_t &NAD, const uint8_t newNAD = 0, const uint16_t fixedTimeout = 0);
+
+    std::vector<PDU> framesetFromPayload(const uint8_t NAD, const std::vector<uint8_t> &payload);
     inline void fillSingleFrame(PDU &frame, const uint8_t NAD, const std::vector<uint8_t> &payload);
     inline void fillFirstFrame(PDU &frame, const uint8_t NAD, const std::vector<uint8_t> &payload, int &bytesWritten);
     inline void fillConsecutiveFrame(PDU &frame, const uint8_t NAD, const uint8_t sequenceNumber, const std::vector<uint8_t> &payload, int &bytesWritten);
 
 private:
-    inline std::optional<std::vector<uint8_t>> readPduResponse(uint8_t &NAD, const uint8_t newNAD = 0);
-    inline bool readSingleFrame(PDU &frame, std::vector<uint8_t> &payload);
-    inline bool readFirstFrame(PDU &frame, std::vector<uint8_t> &payload, size_t &announcedBytes);
-    inline bool readConsecutiveFrame(PDU &frame, std::vector<uint8_t> &payload, const size_t &announcedBytes, int frameCounter);
+    static bool readSingleFrame(PDU &frame, std::vector<uint8_t> &payload);
+    static bool readFirstFrame(PDU &frame, std::vector<uint8_t> &payload, size_t &announcedBytes);
+    static bool readConsecutiveFrame(PDU &frame, std::vector<uint8_t> &payload, const size_t &announcedBytes, int frameCounter);
 };
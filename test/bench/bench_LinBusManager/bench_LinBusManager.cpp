@@ -0,0 +1,200 @@
+// Throughput benchmark of LinBusManager on simulated buses
+// - every channel is a mock_LinBus which takes the real bus time of its frames (19200 Baud)
+// - READ_BY_ID transactions on 1..4 channels, sequential (single caller) and by the workers
+// - reports one JSON object per line:
+//   transactions per second, scaling compared to a single channel
+
+#include <unity.h>
+#include "LinBusManager.hpp"
+#include "LinNodeConfig.hpp"
+#include "mock_LinBus.h"
+#include "mock_DebugStream.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+constexpr uint32_t baud = 19200;
+constexpr uint8_t NAD_node = 0x0A;
+constexpr int transactionsPerChannel = 25;
+constexpr size_t channelsMax = 4;
+
+// simulated bus, the caller is blocked for the bus time of all bits sent and received
+class PacedLinBus : public mock_LinBus {
+public:
+    using mock_LinBus::mock_LinBus;
+
+    void flush() override
+    {
+        mock_LinBus::flush();
+        const uint64_t bits = mock_busBits - pacedBits;
+        pacedBits = mock_busBits;
+        std::this_thread::sleep_for(std::chrono::microseconds(bits * 1000000 / baud));
+    }
+
+private:
+    uint64_t pacedBits = 0;
+};
+
+struct Channel {
+    std::unique_ptr<PacedLinBus> bus;
+    std::unique_ptr<mock_DebugStream> debug;
+};
+
+struct BenchResult {
+    size_t channels;
+    int transactions;
+    int failures;
+    double transactionsPerSecond;
+    double scaling;
+};
+
+static std::array<Channel, channelsMax> createChannels()
+{
+    std::array<Channel, channelsMax> channels;
+    for (size_t i = 0; i < channelsMax; ++i)
+    {
+        channels[i].bus = std::make_unique<PacedLinBus>(i, baud);
+        channels[i].bus->mock_verbose = false;
+        channels[i].bus->begin(baud, SERIAL_8N1);
+        channels[i].bus->addNode(NAD_node, 0x1234, 0x5678, 0x01, 0x0);
+        channels[i].debug = std::make_unique<mock_DebugStream>();
+        channels[i].debug->mock_verbose = false;
+    }
+    return channels;
+}
+
+static bool transaction(LinNodeConfig &bus)
+{
+    uint8_t NAD = NAD_node;
+    uint16_t supplierId = 0x7FFF;
+    uint16_t functionId = 0x3FFF;
+    uint8_t variantId = 0;
+    return static_cast<bool>(bus.readProductId(NAD, supplierId, functionId, variantId));
+}
+
+static double perSecond(int count, std::chrono::steady_clock::duration elapsed)
+{
+    return count / std::chrono::duration<double>(elapsed).count();
+}
+
+/// @brief all channels are driven by the calling thread, one after another
+static BenchResult benchSequential(size_t channelCount)
+{
+    auto channels = createChannels();
+    std::vector<std::unique_ptr<LinNodeConfig>> buses;
+    for (size_t i = 0; i < channelCount; ++i) {
+        buses.push_back(std::make_unique<LinNodeConfig>(*channels[i].bus, *channels[i].debug));
+    }
+
+    int failures = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < transactionsPerChannel; ++t) {
+        for (auto &bus : buses) {
+            failures += transaction(*bus) ? 0 : 1;
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    for (size_t i = 0; i < channelsMax; ++i) {
+        channels[i].bus->end();
+    }
+
+    BenchResult r {};
+    r.channels = channelCount;
+    r.transactions = transactionsPerChannel * static_cast<int>(channelCount);
+    r.failures = failures;
+    r.transactionsPerSecond = perSecond(r.transactions, elapsed);
+    return r;
+}
+
+/// @brief every channel is driven by its worker of LinBusManager
+static BenchResult benchManager(size_t channelCount)
+{
+    auto channels = createChannels();
+    LinBusManager<LinNodeConfig> manager;
+    for (size_t i = 0; i < channelCount; ++i) {
+        manager.addBus(*channels[i].bus, *channels[i].debug);
+    }
+
+    std::atomic<int> failures {0};
+    manager.start();
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < transactionsPerChannel; ++t) {
+        for (size_t i = 0; i < channelCount; ++i) {
+            manager.submit(i, [&failures](LinNodeConfig &bus) {
+                if (!transaction(bus)) {
+                    failures++;
+                }
+            });
+        }
+    }
+    manager.waitIdle();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    manager.stop();
+
+    for (size_t i = 0; i < channelsMax; ++i) {
+        channels[i].bus->end();
+    }
+
+    BenchResult r {};
+    r.channels = channelCount;
+    r.transactions = transactionsPerChannel * static_cast<int>(channelCount);
+    r.failures = failures;
+    r.transactionsPerSecond = perSecond(r.transactions, elapsed);
+    return r;
+}
+
+static void printResult(const char* name, const BenchResult& r)
+{
+    std::printf("{\"bench\":\"%s\",\"channels\":%zu,\"transactions\":%d,\"failures\":%d,"
+                "\"transactions_per_s\":%.1f,\"scaling\":%.2f}\n",
+                name, r.channels, r.transactions, r.failures, r.transactionsPerSecond, r.scaling);
+}
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+void bench_multibus_sequential()
+{
+    BenchResult single = benchSequential(1);
+    for (size_t n = 1; n <= channelsMax; ++n) {
+        BenchResult r = (1 == n) ? single : benchSequential(n);
+        r.scaling = r.transactionsPerSecond / single.transactionsPerSecond;
+        printResult("multibus_sequential", r);
+
+        TEST_ASSERT_EQUAL(0, r.failures);
+    }
+}
+
+void bench_multibus_manager()
+{
+    BenchResult single = benchManager(1);
+    for (size_t n = 1; n <= channelsMax; ++n) {
+        BenchResult r = (1 == n) ? single : benchManager(n);
+        r.scaling = r.transactionsPerSecond / single.transactionsPerSecond;
+        printResult("multibus_manager", r);
+
+        TEST_ASSERT_EQUAL(0, r.failures);
+        // the bus time of the channels overlaps: (nearly) linear
+        TEST_ASSERT_GREATER_THAN(0.8 * n, r.scaling);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(bench_multibus_sequential);
+    RUN_TEST(bench_multibus_manager);
+
+    return UNITY_END();
+}
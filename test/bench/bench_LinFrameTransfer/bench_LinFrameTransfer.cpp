@@ -0,0 +1,327 @@
+// CPU cost of the UART driver calls per frame, bulk path compared to the per-byte path
+// - simulated bus, every driver call takes a lock (like the UART HAL of the ESP32 core)
+// - bulk: the frame layer writes head + data + checksum and reads the bytes of a frame by single calls
+// - per byte: the same traffic split into write(byte) and available() + read() per byte (former driver usage)
+// - reports one JSON object per line:
+//   driver calls per frame, ns per frame, CPU saving of the bulk path
+// - reading a sensor (several frames): readFrame() per frame compared to readFrames() into a result arena,
+//   heap allocations of the library (the simulated bus is not counted) and ns per sensor read
+
+#include <unity.h>
+#include "LinFrameTransfer.hpp"
+#include "mock_LinBus.h"
+#include "mock_DebugStream.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <vector>
+
+// count heap allocations while the library is running (the simulated bus is excluded)
+static std::atomic<size_t> allocations {0};
+static std::atomic<bool> counting {false};
+
+void* operator new(size_t size)
+{
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+mock_DebugStream debugStream;
+
+constexpr uint8_t FID_published = 0x10;
+constexpr uint8_t FID_written = 0x20;
+const std::vector<uint8_t> frameData = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+
+// simulated bus, every call of the driver API is serialized by a lock
+class LockedLinBus : public mock_LinBus {
+public:
+    using mock_LinBus::mock_LinBus;
+
+    bool perByte = false;   // split bulk calls into byte calls
+
+    int available() override
+    {
+        Lock lock(*this);
+        return mock_LinBus::available();
+    }
+
+    int read() override
+    {
+        Lock lock(*this);
+        return mock_LinBus::read();
+    }
+
+    size_t write(uint8_t byte) override
+    {
+        Lock lock(*this);
+        return mock_LinBus::write(byte);
+    }
+
+    size_t write(const uint8_t* buffer, size_t size) override
+    {
+        if (perByte) {
+            size_t written = 0;
+            for (size_t i = 0; i < size; ++i) {
+                written += write(buffer[i]);
+            }
+            return written;
+        }
+        Lock lock(*this);
+        return mock_HardwareSerial::write(buffer, size);
+    }
+
+    size_t readBytes(uint8_t* buffer, size_t length) override
+    {
+        if (perByte) {
+            size_t count = 0;
+            while ((count < length) && (available() > 0)) {
+                buffer[count++] = static_cast<uint8_t>(read());
+            }
+            return count;
+        }
+        Lock lock(*this);
+        return mock_LinBus::readBytes(buffer, length);
+    }
+
+private:
+    // the byte path of the mock is used by its bulk calls: lock once per driver call
+    struct Lock {
+        explicit Lock(LockedLinBus &bus) : bus(bus), owner(!bus.locked)
+        {
+            if (owner) {
+                bus.uartMutex.lock();
+                bus.locked = true;
+            }
+        }
+        ~Lock()
+        {
+            if (owner) {
+                bus.locked = false;
+                bus.uartMutex.unlock();
+            }
+        }
+        LockedLinBus &bus;
+        const bool owner;
+    };
+
+    std::mutex uartMutex;
+    bool locked = false;
+};
+
+class BenchFrameTransfer : public LinFrameTransfer {
+public:
+    using LinFrameTransfer::LinFrameTransfer;
+};
+
+struct BenchResult {
+    const char* frame;
+    int iterations;
+    int failures;
+    double callsPerFrame;
+    double nsPerFrame;
+};
+
+template <typename Transfer>
+static BenchResult benchFrames(const char* frame, const bool perByte, Transfer transfer)
+{
+    LockedLinBus bus(0);
+    bus.mock_verbose = false;
+    bus.perByte = perByte;
+    bus.begin(19200, SERIAL_8N1);
+    bus.published[FID_published] = frameData;
+
+    BenchFrameTransfer frameTransfer(bus, debugStream);
+
+    constexpr int iterations = 20000;
+    int failures = 0;
+    auto calls = bus.mock_driverCalls;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        failures += transfer(frameTransfer) ? 0 : 1;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    calls = bus.mock_driverCalls - calls;
+    bus.end();
+
+    BenchResult r {};
+    r.frame = frame;
+    r.iterations = iterations;
+    r.failures = failures;
+    r.callsPerFrame = static_cast<double>(calls) / iterations;
+    r.nsPerFrame = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / iterations;
+    return r;
+}
+
+static void printResult(const BenchResult& perByte, const BenchResult& bulk)
+{
+    std::printf("{\"bench\":\"frame_driver_calls\",\"frame\":\"%s\",\"iterations\":%d,\"failures\":%d,"
+                "\"calls_per_frame_per_byte\":%.1f,\"calls_per_frame_bulk\":%.1f,"
+                "\"ns_per_frame_per_byte\":%.0f,\"ns_per_frame_bulk\":%.0f,\"cpu_saving\":%.3f}\n",
+                bulk.frame, bulk.iterations, perByte.failures + bulk.failures,
+                perByte.callsPerFrame, bulk.callsPerFrame,
+                perByte.nsPerFrame, bulk.nsPerFrame, 1.0 - bulk.nsPerFrame / perByte.nsPerFrame);
+}
+
+void setUp()
+{
+    debugStream.mock_verbose = false;
+}
+
+void tearDown()
+{
+}
+
+void bench_frame_write()
+{
+    auto write = [](BenchFrameTransfer &frameTransfer) {
+        return frameTransfer.writeFrame(FID_written, frameData);
+    };
+    BenchResult perByte = benchFrames("write_8", true, write);
+    BenchResult bulk = benchFrames("write_8", false, write);
+    printResult(perByte, bulk);
+
+    TEST_ASSERT_EQUAL(0, perByte.failures + bulk.failures);
+    TEST_ASSERT_LESS_THAN(perByte.callsPerFrame, bulk.callsPerFrame);
+}
+
+void bench_frame_read()
+{
+    auto read = [](BenchFrameTransfer &frameTransfer) {
+        auto data = frameTransfer.readFrame(FID_published, frameData.size());
+        return data && (frameData == *data);
+    };
+    BenchResult perByte = benchFrames("read_8", true, read);
+    BenchResult bulk = benchFrames("read_8", false, read);
+    printResult(perByte, bulk);
+
+    TEST_ASSERT_EQUAL(0, perByte.failures + bulk.failures);
+    TEST_ASSERT_LESS_THAN(perByte.callsPerFrame, bulk.callsPerFrame);
+}
+
+void bench_frame_empty()
+{
+    auto empty = [](BenchFrameTransfer &frameTransfer) {
+        return frameTransfer.writeEmptyFrame(FID_written);
+    };
+    BenchResult perByte = benchFrames("header_only", true, empty);
+    BenchResult bulk = benchFrames("header_only", false, empty);
+    printResult(perByte, bulk);
+
+    TEST_ASSERT_EQUAL(0, perByte.failures + bulk.failures);
+    TEST_ASSERT_LESS_OR_EQUAL(perByte.callsPerFrame, bulk.callsPerFrame);
+}
+
+// simulated bus: allocations of the queues (readback, response) are not counted
+class SensorBus : public mock_LinBus {
+public:
+    using mock_LinBus::mock_LinBus;
+    using mock_LinBus::write;
+
+    size_t write(uint8_t byte) override
+    {
+        const bool resume = counting.exchange(false, std::memory_order_relaxed);
+        const size_t result = mock_LinBus::write(byte);
+        counting.store(resume, std::memory_order_relaxed);
+        return result;
+    }
+};
+
+struct SensorResult {
+    int failures;
+    double allocationsPerRead;
+    double nsPerRead;
+};
+
+template <typename Read>
+static SensorResult benchSensor(Read read)
+{
+    SensorBus bus(0);
+    bus.mock_verbose = false;
+    bus.begin(19200, SERIAL_8N1);
+    for (uint8_t frameID = 0x10; frameID < 0x14; ++frameID) {
+        bus.published[frameID] = frameData;
+    }
+
+    BenchFrameTransfer frameTransfer(bus, debugStream);
+
+    constexpr int iterations = 5000;
+    int failures = 0;
+    size_t allocationCount = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        bus.txBuffer.clear();
+        auto alloc = allocations.load(std::memory_order_relaxed);
+        counting.store(true, std::memory_order_relaxed);
+        failures += read(frameTransfer) ? 0 : 1;
+        counting.store(false, std::memory_order_relaxed);
+        allocationCount += allocations.load(std::memory_order_relaxed) - alloc;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    bus.end();
+
+    return {failures,
+            static_cast<double>(allocationCount) / iterations,
+            static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / iterations};
+}
+
+void bench_frame_readFrames()
+{
+    // 4 frames of a sensor
+    SensorResult single = benchSensor([](BenchFrameTransfer &frameTransfer) {
+        bool success = true;
+        for (uint8_t frameID = 0x10; frameID < 0x14; ++frameID) {
+            auto data = frameTransfer.readFrame(frameID, frameData.size());
+            success &= data && (frameData == *data);
+        }
+        return success;
+    });
+
+    static const std::array<LinFrameTransfer::FrameRequest, 4> requests {{{0x10, 8}, {0x11, 8}, {0x12, 8}, {0x13, 8}}};
+    static LinFrameTransfer::ResultArena arena(requests.size());
+    SensorResult arenaRead = benchSensor([](BenchFrameTransfer &frameTransfer) {
+        return frameTransfer.readFrames(requests, arena) == requests.size();
+    });
+
+    std::printf("{\"bench\":\"sensor_read\",\"frames\":4,\"failures\":%d,"
+                "\"allocations_per_read_readFrame\":%.2f,\"allocations_per_read_readFrames\":%.2f,"
+                "\"ns_per_read_readFrame\":%.0f,\"ns_per_read_readFrames\":%.0f}\n",
+                single.failures + arenaRead.failures,
+                single.allocationsPerRead, arenaRead.allocationsPerRead,
+                single.nsPerRead, arenaRead.nsPerRead);
+
+    TEST_ASSERT_EQUAL(0, single.failures + arenaRead.failures);
+    TEST_ASSERT_LESS_THAN(single.allocationsPerRead, arenaRead.allocationsPerRead);
+    TEST_ASSERT_EQUAL(0, arenaRead.allocationsPerRead);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(bench_frame_write);
+    RUN_TEST(bench_frame_read);
+    RUN_TEST(bench_frame_empty);
+    RUN_TEST(bench_frame_readFrames);
+
+    return UNITY_END();
+}
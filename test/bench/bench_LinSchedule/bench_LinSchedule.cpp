@@ -0,0 +1,202 @@
+// Frames per second of a schedule table, pipelined compared to a loop of readFrame()
+// - bus emulated in real time: every byte takes 10 bit times at the bus baud rate,
+//   the readback and the response of a node are available once their bytes are on the bus
+// - the application processes every result (busy, e.g. decoding and rescaling of signals)
+// - serial: readFrame() waits for the header to be sent, the next header follows the processing
+// - pipelined: LinSchedule sends the next header first and processes the result meanwhile
+// - reports one JSON object per line: frames per second of both and the gain
+
+#include <unity.h>
+#include "LinSchedule.hpp"
+#include "mock_LinBus.h"
+#include "mock_DebugStream.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+mock_DebugStream debugStream;
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t benchBaud = 19200;
+const std::vector<uint8_t> frameIDs = {0x10, 0x11, 0x12, 0x13};
+const std::vector<uint8_t> frameData = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+
+// simulated bus in real time
+class TimedLinBus : public mock_LinBus {
+public:
+    using mock_LinBus::mock_LinBus;
+
+    int available() override
+    {
+        // the caller polls until the next byte arrives
+        while (!arrival.empty() && (Clock::now() < arrival.front())) {}
+        return static_cast<int>(getArrived());
+    }
+
+    int read() override
+    {
+        if (getArrived() == 0) {
+            return -1;
+        }
+        arrival.pop_front();
+        return mock_LinBus::read();
+    }
+
+    size_t readBytes(uint8_t* buffer, size_t length) override
+    {
+        // the bulk read of the mock passes read()
+        return mock_LinBus::readBytes(buffer, std::min(length, getArrived()));
+    }
+
+    size_t write(uint8_t byte) override
+    {
+        // a break is sent at half baud rate
+        const auto bitTime = std::chrono::nanoseconds(1000000000ull / baudRate());
+        txDone = std::max(Clock::now(), busIdle) + 10 * bitTime;
+        busIdle = txDone;
+
+        const int before = mock_LinBus::available();
+        const size_t result = mock_LinBus::write(byte);
+        const int received = mock_LinBus::available() - before;
+
+        // readback first, then the response of a node
+        const auto byteTime = std::chrono::nanoseconds(10 * 1000000000ull / benchBaud);
+        for (int i = 0; i < received; ++i) {
+            busIdle = (0 == i) ? txDone : busIdle + byteTime;
+            arrival.push_back(busIdle);
+        }
+        return result;
+    }
+
+    void flush() override
+    {
+        while (Clock::now() < txDone) {}
+        mock_LinBus::flush();
+    }
+
+private:
+    std::deque<Clock::time_point> arrival;
+    Clock::time_point txDone {};
+    Clock::time_point busIdle {};
+
+    size_t getArrived() const
+    {
+        const auto now = Clock::now();
+        size_t count = 0;
+        while ((count < arrival.size()) && (arrival[count] <= now)) {
+            count++;
+        }
+        return count;
+    }
+};
+
+// application work per result
+static void process(const std::chrono::microseconds duration)
+{
+    const auto end = Clock::now() + duration;
+    while (Clock::now() < end) {}
+}
+
+struct BenchResult {
+    int frames;
+    int failures;
+    double framesPerSecond;
+};
+
+template <typename Run>
+static BenchResult benchSchedule(const int frames, Run run)
+{
+    TimedLinBus bus(0, benchBaud);
+    bus.mock_verbose = false;
+    bus.begin(benchBaud, SERIAL_8N1);
+    for (uint8_t frameID : frameIDs) {
+        bus.published[frameID] = frameData;
+    }
+
+    LinFrameTransfer frameTransfer(bus, debugStream);
+    frameTransfer.baud = benchBaud;
+
+    auto start = Clock::now();
+    const int succeeded = run(frameTransfer);
+    auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    bus.end();
+
+    return {frames, frames - succeeded, frames / elapsed};
+}
+
+static void benchPipelining(const std::chrono::microseconds work)
+{
+    constexpr int rounds = 40;
+    const int frames = rounds * frameIDs.size();
+
+    BenchResult serial = benchSchedule(frames, [work](LinFrameTransfer &frameTransfer) {
+        int succeeded = 0;
+        for (int round = 0; round < rounds; ++round) {
+            for (uint8_t frameID : frameIDs) {
+                auto data = frameTransfer.readFrame(frameID, frameData.size());
+                succeeded += (data && (frameData == *data)) ? 1 : 0;
+                process(work);
+            }
+        }
+        return succeeded;
+    });
+
+    BenchResult pipelined = benchSchedule(frames, [work](LinFrameTransfer &frameTransfer) {
+        LinSchedule schedule(frameTransfer);
+        for (uint8_t frameID : frameIDs) {
+            schedule.add(frameID, frameData.size());
+        }
+        int succeeded = 0;
+        schedule.run([work, &succeeded](const uint8_t frameID, const std::optional<std::vector<uint8_t>>& data) {
+            succeeded += (data && (frameData == *data)) ? 1 : 0;
+            process(work);
+        }, rounds);
+        return succeeded;
+    });
+
+    // limit of the bus: break (0x00 at half baud rate) + sync + PID + data + checksum, no inter-frame space
+    const double busFramesPerSecond = static_cast<double>(benchBaud) / (20 + 10 * (2 + frameData.size() + 1));
+
+    std::printf("{\"bench\":\"schedule_pipelining\",\"baud\":%u,\"work_us\":%lld,\"frames\":%d,\"failures\":%d,"
+                "\"frames_per_s_bus\":%.1f,\"frames_per_s_serial\":%.1f,\"frames_per_s_pipelined\":%.1f,\"gain\":%.3f}\n",
+                benchBaud, static_cast<long long>(work.count()), frames, serial.failures + pipelined.failures,
+                busFramesPerSecond, serial.framesPerSecond, pipelined.framesPerSecond,
+                pipelined.framesPerSecond / serial.framesPerSecond - 1.0);
+
+    TEST_ASSERT_EQUAL(0, serial.failures + pipelined.failures);
+    if (work.count()) {
+        TEST_ASSERT_TRUE(pipelined.framesPerSecond > serial.framesPerSecond);
+    }
+}
+
+void setUp()
+{
+    debugStream.mock_verbose = false;
+}
+
+void tearDown()
+{
+}
+
+void bench_schedule_NoWork()
+{
+    benchPipelining(std::chrono::microseconds(0));
+}
+
+void bench_schedule_Work()
+{
+    benchPipelining(std::chrono::microseconds(1500));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(bench_schedule_NoWork);
+    RUN_TEST(bench_schedule_Work);
+
+    return UNITY_END();
+}
@@ -0,0 +1,220 @@
+// Throughput benchmark of the transport layer on a simulated bus
+// - master request / slave response exchange for payload sizes 1..4095 bytes
+// - reports one JSON object per line:
+//   ns per PDU exchange, heap allocations of the library per exchange, bus utilization (payload bits / bus bits)
+
+#include <unity.h>
+#include "LinTransportLayer.hpp"
+#include "mock_LinBus.h"
+#include "mock_DebugStream.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// count heap allocations while the library is running (the simulated bus is excluded)
+static std::atomic<size_t> allocations {0};
+static std::atomic<bool> counting {false};
+
+void* operator new(size_t size)
+{
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+mock_DebugStream debugStream;
+
+class BenchTransportLayer : public LinTransportLayer {
+public:
+    using LinTransportLayer::LinTransportLayer;
+    using LinTransportLayer::framesetFromPayload;
+};
+
+// simulated bus: allocations of the nodes and queues are not counted
+class BenchBus : public mock_LinBus {
+public:
+    using mock_LinBus::mock_LinBus;
+    using mock_LinBus::write;
+
+    size_t write(uint8_t byte) override
+    {
+        const bool resume = counting.exchange(false, std::memory_order_relaxed);
+        const size_t result = mock_LinBus::write(byte);
+        counting.store(resume, std::memory_order_relaxed);
+        return result;
+    }
+};
+
+constexpr uint8_t NAD_node = 0x0A;
+
+struct BenchResult {
+    size_t payload;
+    int iterations;
+    int failures;
+    double nsPerPdu;
+    double allocationsPerExchange;
+    double busBitsPerExchange;
+    double busUtilization;
+};
+
+/// @brief echo node: positive response (RSID) with the same length as the request
+static std::optional<std::vector<uint8_t>> echo(mock_LinNode&, const std::vector<uint8_t>& request)
+{
+    std::vector<uint8_t> response(request);
+    response[0] += 0x40;
+    return response;
+}
+
+static BenchResult benchExchange(size_t payloadSize)
+{
+    BenchBus bus(0);
+    bus.mock_verbose = false;
+    bus.begin(19200, SERIAL_8N1);
+    bus.addNode(NAD_node, 0x1234, 0x5678, 0x01, 0x0).onDiagnostic = echo;
+
+    BenchTransportLayer transportLayer(bus, debugStream);
+
+    std::vector<uint8_t> payload(payloadSize);
+    for (size_t i = 0; i < payloadSize; ++i) {
+        payload[i] = static_cast<uint8_t>(i);
+    }
+    payload[0] = 0x22; // SID
+
+    // warm up: timing profile of node, buffers of the mock
+    uint8_t NAD = NAD_node;
+    transportLayer.writePDU(NAD, payload);
+
+    const int iterations = static_cast<int>(std::max<size_t>(5, 20000 / payloadSize));
+    size_t received = 0;
+    int failures = 0;
+    size_t allocationCount = 0;
+    uint64_t busBits = 0;
+    std::chrono::nanoseconds elapsed {0};
+
+    for (int i = 0; i < iterations; ++i) {
+        bus.txBuffer.clear();
+        auto bits = bus.mock_busBits;
+        auto alloc = allocations.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+
+        counting.store(true, std::memory_order_relaxed);
+        auto response = transportLayer.writePDU(NAD, payload);
+        counting.store(false, std::memory_order_relaxed);
+
+        elapsed += std::chrono::steady_clock::now() - start;
+        allocationCount += allocations.load(std::memory_order_relaxed) - alloc;
+        busBits += bus.mock_busBits - bits;
+        received += response ? response.value().size() : 0;
+        failures += (response && (response.value().size() == payloadSize)) ? 0 : 1;
+    }
+
+    bus.end();
+
+    BenchResult result;
+    result.payload = payloadSize;
+    result.iterations = iterations;
+    result.failures = failures;
+    result.nsPerPdu = static_cast<double>(elapsed.count()) / iterations;
+    result.allocationsPerExchange = static_cast<double>(allocationCount) / iterations;
+    result.busBitsPerExchange = static_cast<double>(busBits) / iterations;
+    // payload (request + response) in bits of UART (start + 8 data + stop)
+    result.busUtilization = 10.0 * (payloadSize * iterations + received) / busBits;
+    return result;
+}
+
+static void printResult(const char* name, const BenchResult& r)
+{
+    std::printf("{\"bench\":\"%s\",\"payload\":%zu,\"iterations\":%d,\"failures\":%d,\"ns_per_pdu\":%.0f,"
+                "\"allocations_per_exchange\":%.1f,\"bus_bits_per_exchange\":%.0f,\"bus_utilization\":%.3f}\n",
+                name, r.payload, r.iterations, r.failures, r.nsPerPdu, r.allocationsPerExchange, r.busBitsPerExchange, r.busUtilization);
+}
+
+// without bus: time and allocations only
+static void printEncoding(const char* name, const BenchResult& r)
+{
+    std::printf("{\"bench\":\"%s\",\"payload\":%zu,\"iterations\":%d,\"ns_per_pdu\":%.0f,\"allocations_per_exchange\":%.1f}\n",
+                name, r.payload, r.iterations, r.nsPerPdu, r.allocationsPerExchange);
+}
+
+void setUp()
+{
+    debugStream.mock_verbose = false;
+}
+
+void tearDown()
+{
+}
+
+void bench_pdu_exchange()
+{
+    // boundaries: SF (1..6), FF + CF (7..), max. DTL length (4095)
+    const size_t sizes[] {1, 6, 7, 12, 13, 62, 63, 255, 1023, 4095};
+
+    for (size_t size : sizes) {
+        BenchResult r = benchExchange(size);
+        printResult("pdu_exchange", r);
+
+        TEST_ASSERT_EQUAL(0, r.failures);
+        TEST_ASSERT_GREATER_THAN(0.0, r.busUtilization);
+        TEST_ASSERT_LESS_OR_EQUAL(1.0, r.busUtilization);
+    }
+}
+
+void bench_frameset_encoding()
+{
+    mock_LinBus bus(0);
+    bus.mock_verbose = false;
+    BenchTransportLayer transportLayer(bus, debugStream);
+
+    const size_t sizes[] {1, 7, 255, 4095};
+    for (size_t size : sizes) {
+        std::vector<uint8_t> payload(size, 0xA5);
+        const int iterations = static_cast<int>(std::max<size_t>(100, 200000 / size));
+
+        auto alloc = allocations.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        size_t frames = 0;
+        counting.store(true, std::memory_order_relaxed);
+        for (int i = 0; i < iterations; ++i) {
+            frames += transportLayer.framesetFromPayload(NAD_node, payload).size();
+        }
+        counting.store(false, std::memory_order_relaxed);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        BenchResult r {};
+        r.payload = size;
+        r.iterations = iterations;
+        r.nsPerPdu = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / iterations;
+        r.allocationsPerExchange = static_cast<double>(allocations.load(std::memory_order_relaxed) - alloc) / iterations;
+        printEncoding("frameset_encoding", r);
+
+        TEST_ASSERT_GREATER_THAN(0, frames);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(bench_pdu_exchange);
+    RUN_TEST(bench_frameset_encoding);
+
+    return UNITY_END();
+}
@@ -2,8 +2,12 @@
 
 class mock_DebugStream : public Stream {
 public:
+    bool mock_verbose = true; // forward debug output to std::cout
+
     size_t write(uint8_t c) override {
-        std::cout.put(c);
+        if (mock_verbose) {
+            std::cout.put(c);
+        }
         return 1;
     }
 
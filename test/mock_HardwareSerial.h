@@ -2,6 +2,7 @@
 #define MOCK_HARDWARE_SERIAL_H
 
 #include "mock_Stream.h"
+#include "mock_micros.h"
 
 #include "unity.h"
 
@@ -39,6 +40,9 @@ enum SerialConfig {
 class mock_HardwareSerial : public mock_Stream {
 public:
     bool mock_loopback = false;
+    bool mock_verbose = true; // trace every byte on std::cout
+    uint64_t mock_driverCalls = 0; // calls of write(), read(), available() and their bulk variants
+    uint32_t mock_updateBaudRate_us = 0; // simulated cost of a reconfiguration of the UART
 
     mock_HardwareSerial(uint8_t uart_nr) : mock_Stream() {
         std::cout << "mock_HardwareSerial() created with UART number: " << (int)uart_nr << std::endl;
@@ -62,6 +66,7 @@ public:
     }
 
     int available() override {
+        mock_driverCalls++;
         auto len = 0;
         if (mock_loopback)
         {
@@ -73,44 +78,84 @@ public:
 
     int read() override {
         TEST_ASSERT_TRUE_MESSAGE(begin_used, "missing call of HardwareSerial::begin()");
+        if (!bulkCall) {
+            mock_driverCalls++;
+        }
 
         // priorize loopback
         if (mock_loopback && !loopbackBuffer.empty()) {
             int byte = loopbackBuffer.front();
             loopbackBuffer.pop();
             rxCnt++;
-            std::cout << "\t#" << rxCnt << "\t\t\t< 0x" << std::hex << byte << std::dec  << "\t(loopback)" << std::endl;
+            if (mock_verbose) {
+                std::cout << "\t#" << rxCnt << "\t\t\t< 0x" << std::hex << byte << std::dec  << "\t(loopback)" << std::endl;
+            }
             return byte;
         }
 
         // rx data from mock
         if (rxBuffer.empty()) {
-            std::cout << "--> HardwareSerial::read(): no Data available" << std::endl;
+            if (mock_verbose) {
+                std::cout << "--> HardwareSerial::read(): no Data available" << std::endl;
+            }
             return -1;
         }
         int byte = rxBuffer.front();
         rxBuffer.pop();
         rxCnt++;
-        std::cout << "\t#" << rxCnt << "\t\t\t< 0x" << std::hex << byte << std::dec << std::endl;
+        if (mock_verbose) {
+            std::cout << "\t#" << rxCnt << "\t\t\t< 0x" << std::hex << byte << std::dec << std::endl;
+        }
         return byte;
     }
 
     size_t write(uint8_t byte) override {
         TEST_ASSERT_TRUE_MESSAGE(begin_used, "missing call of HardwareSerial::begin()");
+        if (!bulkCall) {
+            mock_driverCalls++;
+        }
 
         if (mock_loopback)
         {
             loopbackBuffer.push(byte);
         }
         txCnt++;
-        std::cout << "#" << txCnt << "\t\t\t0x" << std::hex << (int)byte << std::dec << " >"<< std::endl;
+        if (mock_verbose) {
+            std::cout << "#" << txCnt << "\t\t\t0x" << std::hex << (int)byte << std::dec << " >"<< std::endl;
+        }
         flush_done = false;
         return mock_Stream::write(byte); // Call the base class write method to handle output
     }
 
+    // bulk write: a single driver call, every byte passes the byte path (loopback, bus simulation)
+    size_t write(const uint8_t* buffer, size_t size) override {
+        mock_driverCalls++;
+        bulkCall = true;
+        size_t written = 0;
+        for (size_t i = 0; i < size; ++i) {
+            written += write(buffer[i]);
+        }
+        bulkCall = false;
+        return written;
+    }
+
+    // bulk read: a single driver call, returns what is available (up to length)
+    virtual size_t readBytes(uint8_t* buffer, size_t length) {
+        mock_driverCalls++;
+        bulkCall = true;
+        size_t count = 0;
+        while ((count < length) && ((mock_loopback && !loopbackBuffer.empty()) || !rxBuffer.empty())) {
+            buffer[count++] = static_cast<uint8_t>(read());
+        }
+        bulkCall = false;
+        return count;
+    }
+
     void flush() override {
         TEST_ASSERT_TRUE_MESSAGE(begin_used, "missing call of HardwareSerial::begin()");
-        std::cout << "HardwareSerial::flush() called - TX: " << txBuffer.size() << " Byte(s); RX: " << available() << " Byte(s)" << std::endl;
+        if (mock_verbose) {
+            std::cout << "HardwareSerial::flush() called - TX: " << txBuffer.size() << " Byte(s); RX: " << available() << " Byte(s)" << std::endl;
+        }
         flush_done = true;
     }
 
@@ -121,8 +166,23 @@ public:
     void updateBaudRate(unsigned long value) {
         TEST_ASSERT_TRUE_MESSAGE(begin_used, "missing call of HardwareSerial::begin()");
         TEST_ASSERT_TRUE_MESSAGE(flush_done, "expect HardwareSerial::flush() before BaudRate is changed");
-        std::cout << "HardwareSerial::updateBaudRate() to " << value << " Baud" << std::endl;
+        if (mock_verbose) {
+            std::cout << "HardwareSerial::updateBaudRate() to " << value << " Baud" << std::endl;
+        }
         mock_baud = value;
+        mock_micros_value += mock_updateBaudRate_us;
+    }
+
+    // break generated by the UART (or the TX line) without reconfiguration: appears as 0x00 on the bus
+    virtual void mock_Break() {
+        TEST_ASSERT_TRUE_MESSAGE(begin_used, "missing call of HardwareSerial::begin()");
+        if (mock_loopback) {
+            loopbackBuffer.push(0x00);
+        }
+        if (mock_verbose) {
+            std::cout << "HardwareSerial::mock_Break()" << std::endl;
+        }
+        mock_Stream::write(static_cast<uint8_t>(0x00));
     }
 
     void mock_Input(const uint8_t data) {
@@ -142,6 +202,7 @@ private:
     std::queue<uint8_t> loopbackBuffer;
     std::queue<uint8_t> rxBuffer; // Mock RX buffer for incoming data
 
+    bool bulkCall = false;
     bool begin_used = false;
     bool flush_done = true;
 };
@@ -0,0 +1,466 @@
+#ifndef MOCK_LIN_BUS_H
+#define MOCK_LIN_BUS_H
+
+// Simulated LIN cluster behind the mock UART
+// - frames written by the master are decoded (break is recognized by the reduced baud rate)
+// - master requests (0x3C) are reassembled (DTL) and passed to the simulated nodes
+// - responses of the nodes are segmented and sent on the slave response header (0x3D)
+// - unconditional frames can be published by the bus for any other frame ID
+
+#include "mock_HardwareSerial.h"
+#include "mock_millis.h"
+
+#include <stdint.h>
+#include <array>
+#include <deque>
+#include <functional>
+#include <map>
+#include <optional>
+#include <vector>
+
+class mock_LinNode {
+public:
+    using Frame = std::array<uint8_t, 8>;
+    using DiagnosticHandler = std::function<std::optional<std::vector<uint8_t>>(mock_LinNode& node, const std::vector<uint8_t>& request)>;
+
+    uint8_t NAD;
+    uint16_t supplierId;
+    uint16_t functionId;
+    uint8_t variantId;
+    uint32_t serialNumber;
+
+    std::array<uint8_t, 4> PIDs {0xFF, 0xFF, 0xFF, 0xFF}; // assigned by ASSIGN_FRAME_IDENTIFIER_RANGE
+    std::array<uint8_t, 5> dataDump {0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    std::map<uint8_t, std::vector<uint8_t>> userIdentifiers; // READ_BY_ID 32-63
+    uint8_t savedNAD = 0;
+    bool silent = false;        // node does not respond at all
+    uint8_t responseDelay = 0;  // count of SlaveResponse headers ignored, before the response is sent
+    uint16_t responseTime = 0;  // time after the request, before the response is sent [ms]
+    uint8_t responsePending = 0; // count of "response pending" (NRC 0x78) sent ahead of the response
+    uint8_t pendingDelay = 0;   // count of SlaveResponse headers ignored after each "response pending"
+    int requestCount = 0;       // count of master requests addressed to this node
+
+    // node position detection (SID 0xB5)
+    bool snpdActive = false;    // detection is running
+    bool snpdSelected = false;  // selected by the position (e.g. bus shunt current, daisy chain input)
+    bool snpdAddressed = false; // NAD was assigned during this detection
+
+    // services beside node configuration (e.g. UDS), no response by default
+    DiagnosticHandler onDiagnostic;
+
+    std::deque<Frame> pending;  // response frames, waiting for SlaveResponse header
+    uint8_t delayCount = 0;
+    uint32_t requestTime = 0;
+
+    mock_LinNode(uint8_t nad, uint16_t supplier, uint16_t function, uint8_t variant, uint32_t serial) :
+        NAD(nad),
+        supplierId(supplier),
+        functionId(function),
+        variantId(variant),
+        serialNumber(serial)
+    {}
+
+    /// @brief Node configuration services, others are passed to onDiagnostic
+    /// @param request payload (SID + data)
+    /// @return response payload, or no response
+    std::optional<std::vector<uint8_t>> onRequest(const std::vector<uint8_t>& request)
+    {
+        requestCount++;
+        const uint8_t SID = request[0];
+        auto arg = [&request](size_t i) -> uint8_t { return (i < request.size()) ? request[i] : 0xFF; };
+
+        switch (SID) {
+        case 0xB0: // ASSIGN_NAD
+            if (!matchIds(arg(1) | arg(2) << 8, arg(3) | arg(4) << 8)) {
+                return {};
+            }
+            NAD = arg(5);
+            return std::vector<uint8_t>{0xF0};
+
+        case 0xB2: { // READ_BY_ID
+            if (!matchIds(arg(2) | arg(3) << 8, arg(4) | arg(5) << 8)) {
+                return {};
+            }
+            auto id = getIdentifier(arg(1));
+            if (!id) {
+                return std::vector<uint8_t>{0x7F, SID, 0x12};
+            }
+            std::vector<uint8_t> response {0xF2};
+            response.insert(response.end(), id->begin(), id->end());
+            return response;
+        }
+
+        case 0xB3: { // CONDITIONAL_CHANGE: Id, Byte, Mask, Invert, NewNAD
+            auto id = getIdentifier(arg(1));
+            uint8_t byte = arg(2);
+            if (!id || (byte < 1) || (byte > id->size())) {
+                return {};
+            }
+            if (((*id)[byte - 1] ^ arg(4)) & arg(3)) {
+                return {};
+            }
+            NAD = arg(5);
+            return std::vector<uint8_t>{0xF3};
+        }
+
+        case 0xB4: // DATA_DUMP
+            if (request.size() > 1) {
+                std::copy_n(request.begin() + 1, std::min<size_t>(request.size() - 1, dataDump.size()), dataDump.begin());
+            }
+            return std::vector<uint8_t>{0xF4, dataDump[0], dataDump[1], dataDump[2], dataDump[3], dataDump[4]};
+
+        case 0xB5: // SNPD: Supplier, Subfunction, NAD (broadcast, no response)
+            if (!matchIds(arg(1) | arg(2) << 8, 0x3FFF)) {
+                return {};
+            }
+            switch (arg(3)) {
+            case 0x01: // INITIALIZE
+                snpdActive = true;
+                snpdAddressed = false;
+                break;
+            case 0x02: // ASSIGN_NAD
+                if (snpdActive && snpdSelected && !snpdAddressed) {
+                    NAD = arg(4);
+                    snpdAddressed = true;
+                }
+                break;
+            case 0x03: // STORE_NAD
+                if (snpdAddressed) {
+                    savedNAD = NAD;
+                }
+                break;
+            case 0x04: // FINISH
+                snpdActive = false;
+                break;
+            }
+            return {};
+
+        case 0xB6: // SAVE_CONFIG
+            savedNAD = NAD;
+            return std::vector<uint8_t>{0xF6};
+
+        case 0xB7: { // ASSIGN_FRAME_IDENTIFIER_RANGE
+            uint8_t start = arg(1);
+            for (size_t i = 0; i < 4; ++i) {
+                uint8_t PID = arg(2 + i);
+                if ((start + i < PIDs.size()) && (PID != 0xFF)) {
+                    PIDs[start + i] = PID;
+                }
+            }
+            return std::vector<uint8_t>{0xF7};
+        }
+
+        default:
+            if (onDiagnostic) {
+                return onDiagnostic(*this, request);
+            }
+            return std::vector<uint8_t>{0x7F, SID, 0x11};
+        }
+    }
+
+    /// @brief LIN Product Identification (Id = 0), serial number (Id = 1) and user defined (Id = 32-63)
+    std::optional<std::vector<uint8_t>> getIdentifier(const uint8_t id) const
+    {
+        if (0 == id) {
+            return std::vector<uint8_t>{
+                lo(supplierId), hi(supplierId), lo(functionId), hi(functionId), variantId
+            };
+        }
+        if (1 == id) {
+            return std::vector<uint8_t>{
+                static_cast<uint8_t>(serialNumber), static_cast<uint8_t>(serialNumber >> 8),
+                static_cast<uint8_t>(serialNumber >> 16), static_cast<uint8_t>(serialNumber >> 24)
+            };
+        }
+        auto it = userIdentifiers.find(id);
+        if (it != userIdentifiers.end()) {
+            return it->second;
+        }
+        return {};
+    }
+
+private:
+    bool matchIds(const uint16_t supplier, const uint16_t function) const
+    {
+        return ((0x7FFF == supplier) || (supplierId == supplier)) &&
+               ((0x3FFF == function) || (functionId == function));
+    }
+
+    static uint8_t lo(uint16_t value) { return static_cast<uint8_t>(value); }
+    static uint8_t hi(uint16_t value) { return static_cast<uint8_t>(value >> 8); }
+};
+
+class mock_LinBus : public mock_HardwareSerial {
+public:
+    // behaviour when several nodes respond to the same SlaveResponse header
+    enum class Arbitration {
+        WIRED_AND, // physical bus: dominant bits win, checksum will fail
+        ORDERED    // nodes take turns, one node per header (order of registration)
+    };
+
+    Arbitration arbitration = Arbitration::WIRED_AND;
+
+    // unconditional frames published on the bus (frame ID --> data)
+    std::map<uint8_t, std::vector<uint8_t>> published;
+
+    // bus time of all frames (nominal bits, LIN 2.2A Spec 2.3.2)
+    uint64_t mock_busBits = 0;
+    int mock_frameCount = 0;
+
+    mock_LinBus(uint8_t uart_nr, uint32_t busBaud = 19200) :
+        mock_HardwareSerial(uart_nr),
+        busBaud(busBaud)
+    {
+        mock_loopback = true;
+    }
+
+    mock_LinNode& addNode(uint8_t NAD, uint16_t supplierId, uint16_t functionId, uint8_t variantId, uint32_t serialNumber)
+    {
+        nodes.emplace_back(NAD, supplierId, functionId, variantId, serialNumber);
+        return nodes.back();
+    }
+
+    std::deque<mock_LinNode>& getNodes()
+    {
+        return nodes;
+    }
+
+    size_t write(uint8_t byte) override {
+        size_t result = mock_HardwareSerial::write(byte);
+        decode(byte);
+        return result;
+    }
+
+    void mock_Break() override {
+        mock_HardwareSerial::mock_Break();
+        state = State::Sync;
+    }
+
+    static uint8_t checksum(const uint8_t initial, const uint8_t* data, size_t len)
+    {
+        uint16_t sum = initial;
+        for (size_t i = 0; i < len; ++i) {
+            sum += data[i];
+            sum = (sum >= 256) ? sum - 255 : sum;
+        }
+        return static_cast<uint8_t>(~sum);
+    }
+
+private:
+    enum class State {
+        Idle,
+        Sync,
+        PID,
+        MasterRequest
+    };
+
+    struct Reassembly {
+        size_t announced = 0;
+        uint8_t sequenceNumber = 0;
+        std::vector<uint8_t> data;
+    };
+
+    uint32_t busBaud;
+    State state = State::Idle;
+    std::vector<uint8_t> frame;
+    std::map<uint8_t, Reassembly> reassembly;
+    std::deque<mock_LinNode> nodes;
+
+    void decode(const uint8_t byte)
+    {
+        if ((0x00 == byte) && (baudRate() < busBaud)) {
+            state = State::Sync;
+            return;
+        }
+
+        switch (state) {
+        case State::Idle:
+            break;
+
+        case State::Sync:
+            state = (0x55 == byte) ? State::PID : State::Idle;
+            break;
+
+        case State::PID:
+            mock_busBits += 34;
+            mock_frameCount++;
+            state = State::Idle;
+            if (0x3C == (byte & 0x3F)) {
+                frame.clear();
+                state = State::MasterRequest;
+            } else if (0x3D == (byte & 0x3F)) {
+                respondSlave();
+            } else {
+                respondPublished(byte);
+            }
+            break;
+
+        case State::MasterRequest:
+            frame.push_back(byte);
+            mock_busBits += 10;
+            if (frame.size() == 9) {
+                state = State::Idle;
+                if (frame[8] == checksum(0, frame.data(), 8)) {
+                    onMasterRequest();
+                }
+            }
+            break;
+        }
+    }
+
+    void onMasterRequest()
+    {
+        const uint8_t NAD = frame[0];
+        if (0x00 == NAD) {
+            // go to sleep command
+            return;
+        }
+
+        Reassembly& r = reassembly[NAD];
+        const uint8_t PCI = frame[1];
+        switch (PCI & 0xF0) {
+        case 0x00: // SF
+            r = {};
+            r.announced = PCI & 0x0F;
+            r.data.assign(frame.begin() + 2, frame.begin() + 2 + std::min<size_t>(r.announced, 6));
+            break;
+        case 0x10: // FF
+            r = {};
+            r.announced = (PCI & 0x0F) << 8 | frame[2];
+            r.data.assign(frame.begin() + 3, frame.begin() + 8);
+            r.sequenceNumber = 1;
+            return;
+        case 0x20: // CF
+            if ((0 == r.announced) || ((PCI & 0x0F) != (r.sequenceNumber & 0x0F))) {
+                r = {};
+                return;
+            }
+            r.sequenceNumber++;
+            r.data.insert(r.data.end(), frame.begin() + 2, frame.begin() + 2 + std::min<size_t>(r.announced - r.data.size(), 6));
+            if (r.data.size() < r.announced) {
+                return;
+            }
+            break;
+        default:
+            return;
+        }
+
+        std::vector<uint8_t> request = std::move(r.data);
+        reassembly.erase(NAD);
+        if (request.empty()) {
+            return;
+        }
+
+        for (mock_LinNode& node : nodes) {
+            if ((node.NAD != NAD) && (0x7F != NAD) && (0x7E != NAD)) {
+                continue;
+            }
+            // a new request aborts a pending response
+            node.pending.clear();
+            node.delayCount = node.responseDelay;
+            node.requestTime = mock_millis_value;
+
+            // ASSIGN_NAD is answered by the initial NAD, any other service by the current one
+            const uint8_t initialNAD = node.NAD;
+            auto response = node.onRequest(request);
+            if (!response || node.silent) {
+                continue;
+            }
+            for (uint8_t i = 0; i < node.responsePending; ++i) {
+                segment(node, node.NAD, {0x7F, request[0], 0x78});
+            }
+            segment(node, (0xB0 == request[0]) ? initialNAD : node.NAD, *response);
+        }
+    }
+
+    static void segment(mock_LinNode& node, const uint8_t NAD, const std::vector<uint8_t>& payload)
+    {
+        mock_LinNode::Frame f;
+        f.fill(0xFF);
+        f[0] = NAD;
+        if (payload.size() <= 6) {
+            f[1] = static_cast<uint8_t>(payload.size());
+            std::copy(payload.begin(), payload.end(), f.begin() + 2);
+            node.pending.push_back(f);
+            return;
+        }
+
+        f[1] = 0x10 | static_cast<uint8_t>(payload.size() >> 8);
+        f[2] = static_cast<uint8_t>(payload.size());
+        std::copy_n(payload.begin(), 5, f.begin() + 3);
+        node.pending.push_back(f);
+
+        uint8_t sequenceNumber = 1;
+        for (size_t pos = 5; pos < payload.size(); pos += 6) {
+            f.fill(0xFF);
+            f[0] = NAD;
+            f[1] = 0x20 | (sequenceNumber++ & 0x0F);
+            std::copy_n(payload.begin() + pos, std::min<size_t>(6, payload.size() - pos), f.begin() + 2);
+            node.pending.push_back(f);
+        }
+    }
+
+    void respondSlave()
+    {
+        std::array<uint8_t, 9> bus;
+        bool responded = false;
+
+        for (mock_LinNode& node : nodes) {
+            if (node.pending.empty() || (mock_millis_value - node.requestTime < node.responseTime)) {
+                continue;
+            }
+            if (node.delayCount) {
+                node.delayCount--;
+                continue;
+            }
+
+            std::array<uint8_t, 9> own;
+            std::copy(node.pending.front().begin(), node.pending.front().end(), own.begin());
+            own[8] = checksum(0, own.data(), 8);
+            node.pending.pop_front();
+            if ((0x7F == own[2]) && (0x78 == own[4])) {
+                // still busy: the next frame follows later
+                node.delayCount = node.pendingDelay;
+            }
+
+            if (!responded) {
+                bus = own;
+                responded = true;
+            } else {
+                // collision: dominant bits win
+                for (size_t i = 0; i < bus.size(); ++i) {
+                    bus[i] &= own[i];
+                }
+            }
+
+            if (Arbitration::ORDERED == arbitration) {
+                break;
+            }
+        }
+
+        if (responded) {
+            transmit(bus.data(), bus.size());
+        }
+    }
+
+    void respondPublished(const uint8_t PID)
+    {
+        auto it = published.find(PID & 0x3F);
+        if (it == published.end()) {
+            return;
+        }
+        const uint8_t chksum = checksum(PID, it->second.data(), it->second.size());
+        transmit(it->second.data(), it->second.size());
+        transmit(&chksum, 1);
+    }
+
+    void transmit(const uint8_t* data, size_t len)
+    {
+        for (size_t i = 0; i < len; ++i) {
+            mock_Input(data[i]);
+        }
+        mock_busBits += 10 * len;
+    }
+};
+
+#endif // MOCK_LIN_BUS_H
@@ -1,10 +1,13 @@
 #include "mock_delay.h"
+#include "mock_millis.h"
 
 // Initialisiere die Variable
-uint32_t mock_delay_value = 0;
+std::atomic<uint32_t> mock_delay_value {0};
 
 // Mock-Implementierung von delay()
 void delay(uint32_t ms) {
     // Speichere den übergebenen Wert
     mock_delay_value = ms;
+    // time passes
+    mock_millis_value += ms;
 }
@@ -2,9 +2,10 @@
 #define MOCK_DELAY_H
 
 #include <stdint.h>
+#include <atomic>
 
 // Variable zum Speichern des letzten Delay-Werts
-extern uint32_t mock_delay_value;
+extern std::atomic<uint32_t> mock_delay_value;
 
 // Deklaration der Mock-Funktion für delay
 void delay(uint32_t ms);
@@ -0,0 +1,11 @@
+#include "mock_micros.h"
+
+std::atomic<uint32_t> mock_micros_value {0};
+
+uint32_t micros(void) {
+    return mock_micros_value;
+}
+
+void delayMicroseconds(uint32_t us) {
+    mock_micros_value += us;
+}
@@ -0,0 +1,13 @@
+#ifndef MOCK_MICROS_H
+#define MOCK_MICROS_H
+
+#include <stdint.h>
+#include <atomic>
+
+// microsecond clock, advanced by delayMicroseconds() and by the simulated cost of driver calls only
+extern std::atomic<uint32_t> mock_micros_value;
+
+uint32_t micros(void);
+void delayMicroseconds(uint32_t us);
+
+#endif // MOCK_MICROS_H
@@ -2,8 +2,10 @@
 #define MOCK_MILLIS_H
 
 #include <stdint.h>
+#include <atomic>
 
-extern uint32_t mock_millis_value;
+// shared by all threads (e.g. workers of LinBusManager)
+extern std::atomic<uint32_t> mock_millis_value;
 
 uint32_t millis(void);
 
@@ -0,0 +1,203 @@
+#include <unity.h>
+#include "LinAsyncTransportLayer.hpp"
+#include "mock_DebugStream.hpp"
+#include "mock_LinBus.h"
+
+#include <optional>
+#include <vector>
+
+mock_DebugStream debugStream;
+
+// coroutine API requires -std=gnu++20 (see env:test-native-coroutine)
+#if defined(__cpp_impl_coroutine)
+
+mock_LinBus* linBus;
+LinAsyncTransportLayer* linAsync;
+
+constexpr uint8_t FID_signal = 0x10;
+const std::vector<uint8_t> signalData = {0x01, 0x02, 0x03, 0x04};
+
+void setUp()
+{
+    linBus = new mock_LinBus(0);
+    linBus->mock_verbose = false;
+    linBus->begin(19200, SERIAL_8N1);
+    linBus->published[FID_signal] = signalData;
+    debugStream.mock_verbose = false;
+    linAsync = new LinAsyncTransportLayer(*linBus, debugStream, 1);
+}
+
+void tearDown()
+{
+    delete linAsync;
+    linBus->end();
+    delete linBus;
+}
+
+static const std::vector<uint8_t> readProductId = {0xB2, 0x00, 0xFF, 0x7F, 0xFF, 0x3F};
+
+static LinTask<int> signalFlow(LinAsyncTransportLayer &bus, int count)
+{
+    int valid = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        auto data = co_await bus.readFrame(FID_signal, signalData.size());
+        if (data && (signalData == *data)) {
+            valid++;
+        }
+    }
+    co_return valid;
+}
+
+static LinTask<std::optional<std::vector<uint8_t>>> diagnosticFlow(LinAsyncTransportLayer &bus, uint8_t NAD, uint8_t id)
+{
+    std::vector<uint8_t> payload = readProductId;
+    payload[1] = id;
+    co_return co_await bus.request(NAD, payload);
+}
+
+
+void test_async_frames()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    auto reader1 = signalFlow(*linAsync, 3);
+    auto reader2 = signalFlow(*linAsync, 2);
+    auto silent = [](LinAsyncTransportLayer &bus) -> LinTask<bool> {
+        // no node publishes this frame
+        auto data = co_await bus.readFrame(0x11, 2);
+        co_return data.has_value();
+    }(*linAsync);
+    auto writer = [](LinAsyncTransportLayer &bus) -> LinTask<bool> {
+        const std::vector<uint8_t> data = {0xAA, 0x55};
+        auto result = co_await bus.writeFrame(0x20, data);
+        co_return result.has_value();
+    }(*linAsync);
+
+    reader1.start();
+    reader2.start();
+    silent.start();
+    writer.start();
+    // nothing is sent before poll()
+    TEST_ASSERT_EQUAL(0, linBus->mock_frameCount);
+
+    int polls = 0;
+    while (linAsync->poll()) {
+        polls++;
+    }
+
+    TEST_ASSERT_TRUE(reader1.done() && reader2.done() && silent.done() && writer.done());
+    TEST_ASSERT_EQUAL(3, reader1.result());
+    TEST_ASSERT_EQUAL(2, reader2.result());
+    TEST_ASSERT_FALSE(silent.result());
+    TEST_ASSERT_TRUE(writer.result());
+    TEST_ASSERT_EQUAL(7, linBus->mock_frameCount);
+    TEST_ASSERT_EQUAL(0, linAsync->frameErrors);
+    // one frame per poll, only the silent frame waits for its timeout
+    TEST_ASSERT_GREATER_THAN(7, polls);
+}
+
+void test_async_requests()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    constexpr size_t nodeCount = 3;
+    const std::vector<uint8_t> longIdentifier = {
+        0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0x20
+    };
+    for (uint8_t i = 0; i < nodeCount; ++i) {
+        auto &node = linBus->addNode(0x10 + i, 0x1000 + i, 0x0001, 0x01, 0x0);
+        node.userIdentifiers[32] = longIdentifier;
+    }
+    linBus->getNodes()[1].responseDelay = 3;
+
+    std::vector<LinTask<std::optional<std::vector<uint8_t>>>> flows;
+    for (uint8_t i = 0; i < nodeCount; ++i) {
+        flows.push_back(diagnosticFlow(*linAsync, 0x10 + i, 0));
+        flows.push_back(diagnosticFlow(*linAsync, 0x10 + i, 32));
+    }
+    // no node with this NAD
+    flows.push_back(diagnosticFlow(*linAsync, 0x20, 0));
+    auto signals = signalFlow(*linAsync, 10);
+
+    for (auto &flow : flows) {
+        flow.start();
+    }
+    signals.start();
+    while (linAsync->poll()) {}
+
+    for (uint8_t i = 0; i < nodeCount; ++i)
+    {
+        auto &productId = flows[2 * i];
+        TEST_ASSERT_TRUE(productId.done());
+        TEST_ASSERT_TRUE(productId.result().has_value());
+        const std::vector<uint8_t> expected = {0xF2, static_cast<uint8_t>(0x00 + i), 0x10, 0x01, 0x00, 0x01};
+        TEST_ASSERT_TRUE(expected == *productId.result());
+
+        // segmented response
+        auto &userId = flows[2 * i + 1];
+        TEST_ASSERT_TRUE(userId.done());
+        TEST_ASSERT_TRUE(userId.result().has_value());
+        TEST_ASSERT_EQUAL(1 + longIdentifier.size(), userId.result()->size());
+        TEST_ASSERT_EQUAL_MEMORY(longIdentifier.data(), userId.result()->data() + 1, longIdentifier.size());
+
+        TEST_ASSERT_EQUAL(2, linBus->getNodes()[i].requestCount);
+    }
+    TEST_ASSERT_TRUE(flows.back().done());
+    TEST_ASSERT_FALSE(flows.back().result().has_value());
+
+    // signal frames are interleaved, requests are exclusive (no collision)
+    TEST_ASSERT_EQUAL(10, signals.result());
+    TEST_ASSERT_EQUAL(0, linAsync->frameErrors);
+}
+
+void test_async_pool()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    linBus->addNode(0x0A, 0x1234, 0x0001, 0x01, 0x0);
+    const size_t fallbacks = linCoroutinePool.getFallbacks();
+
+    {
+        std::vector<LinTask<std::optional<std::vector<uint8_t>>>> flows;
+        for (int i = 0; i < 4; ++i) {
+            flows.push_back(diagnosticFlow(*linAsync, 0x0A, 0));
+            flows.back().start();
+        }
+        // flow, request and transaction of every flow
+        TEST_ASSERT_GREATER_OR_EQUAL(4 * 2, linCoroutinePool.getUsed());
+        while (linAsync->poll()) {}
+        for (auto &flow : flows) {
+            TEST_ASSERT_TRUE(flow.result().has_value());
+        }
+    }
+
+    // all frames returned, none allocated from the heap
+    TEST_ASSERT_EQUAL(0, linCoroutinePool.getUsed());
+    TEST_ASSERT_EQUAL(fallbacks, linCoroutinePool.getFallbacks());
+}
+
+#else
+
+void setUp()
+{
+}
+
+void tearDown()
+{
+}
+
+#endif // __cpp_impl_coroutine
+
+int main()
+{
+    UNITY_BEGIN();
+
+#if defined(__cpp_impl_coroutine)
+    RUN_TEST(test_async_frames);
+    RUN_TEST(test_async_requests);
+    RUN_TEST(test_async_pool);
+#endif
+
+    return UNITY_END();
+}
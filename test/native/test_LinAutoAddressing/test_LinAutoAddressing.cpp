@@ -0,0 +1,185 @@
+#include <unity.h>
+#include "LinAutoAddressing.hpp"
+#include "mock_DebugStream.hpp"
+#include "mock_LinBus.h"
+
+#include <set>
+
+mock_DebugStream debugStream;
+
+mock_LinBus* linBus;
+LinAutoAddressing* linAutoAddressing;
+
+constexpr uint8_t factoryNAD = 0x7D;
+
+// daisy chain: every node passes the selection to its successor, once it got its NAD
+class DaisyChain : public LinSnpdMethod {
+public:
+    std::vector<uint8_t> begins;
+    std::vector<uint8_t> ends;
+
+    void beginAssignment(const uint8_t newNAD) override
+    {
+        begins.push_back(newNAD);
+        for (mock_LinNode& node : linBus->getNodes())
+        {
+            if (node.snpdActive && !node.snpdAddressed) {
+                node.snpdSelected = true;
+                return;
+            }
+        }
+    }
+
+    void endAssignment(const uint8_t newNAD) override
+    {
+        ends.push_back(newNAD);
+        for (mock_LinNode& node : linBus->getNodes()) {
+            node.snpdSelected = false;
+        }
+    }
+};
+
+void setUp()
+{
+    linBus = new mock_LinBus(0);
+    linBus->mock_verbose = false;
+    linBus->begin(19200, SERIAL_8N1);
+    // responses of several nodes overlay (dominant bits win)
+    linBus->arbitration = mock_LinBus::Arbitration::WIRED_AND;
+
+    linAutoAddressing = new LinAutoAddressing(*linBus, debugStream, 2);
+}
+
+void tearDown()
+{
+    delete linAutoAddressing;
+
+    linBus->end();
+    delete linBus;
+}
+
+void test_autoAddressing_serialNumber_uniqueNADs()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    // identical products, all delivered with the same NAD
+    const std::vector<uint32_t> serialNumbers = {
+        0x00010000, 0x00010001, 0x00010002, 0x00010003,
+        0x00010010, 0x00A5F00C, 0x12345678, 0x80000000
+    };
+    for (uint32_t serialNumber : serialNumbers) {
+        linBus->addNode(factoryNAD, 0x1234, 0x0001, 0x01, serialNumber);
+    }
+
+    auto report = linAutoAddressing->assignBySerialNumber(factoryNAD);
+
+    TEST_ASSERT_TRUE(report.complete);
+    TEST_ASSERT_EQUAL(serialNumbers.size(), report.assignments.size());
+
+    // every node has its own NAD, as reported
+    std::set<uint8_t> assigned;
+    for (const auto& assignment : report.assignments) {
+        TEST_ASSERT_TRUE(assigned.insert(assignment.NAD).second);
+    }
+    for (const mock_LinNode& node : linBus->getNodes())
+    {
+        TEST_ASSERT_NOT_EQUAL(factoryNAD, node.NAD);
+        TEST_ASSERT_EQUAL(1, assigned.count(node.NAD));
+        for (const auto& assignment : report.assignments) {
+            if ((assignment.NAD == node.NAD) && assignment.serialNumber) {
+                TEST_ASSERT_EQUAL_HEX32(node.serialNumber, assignment.serialNumber.value());
+            }
+        }
+    }
+    // NADs are taken from the begin of the range
+    TEST_ASSERT_EQUAL(0x01, *assigned.begin());
+    TEST_ASSERT_EQUAL(serialNumbers.size(), *assigned.rbegin());
+
+    // separation of a node: split + count of both parts, a bit without separation: split (+ count)
+    // a search bit by bit (32 splits per node) is far more expensive
+    TEST_ASSERT_LESS_OR_EQUAL(6 * serialNumbers.size(), report.transactions);
+}
+
+void test_autoAddressing_serialNumber_limits()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    // nobody there: nothing to do
+    auto report = linAutoAddressing->assignBySerialNumber(factoryNAD);
+    TEST_ASSERT_TRUE(report.complete);
+    TEST_ASSERT_EQUAL(0, report.assignments.size());
+    TEST_ASSERT_EQUAL(1, report.transactions);
+
+    // a single node is moved right away
+    linBus->addNode(factoryNAD, 0x1234, 0x0001, 0x01, 0x00000042);
+    report = linAutoAddressing->assignBySerialNumber(factoryNAD, 0x20, 0x2F);
+    TEST_ASSERT_TRUE(report.complete);
+    TEST_ASSERT_EQUAL(1, report.assignments.size());
+    TEST_ASSERT_EQUAL_HEX8(0x20, report.assignments[0].NAD);
+    TEST_ASSERT_EQUAL_HEX32(0x00000042, report.assignments[0].serialNumber.value());
+    TEST_ASSERT_EQUAL_HEX8(0x20, linBus->getNodes()[0].NAD);
+    TEST_ASSERT_EQUAL(2, report.transactions);
+
+    // range is exhausted
+    linBus->addNode(factoryNAD, 0x1234, 0x0001, 0x01, 0x00000006);
+    linBus->addNode(factoryNAD, 0x1234, 0x0001, 0x01, 0x00000007);
+    for (mock_LinNode& node : linBus->getNodes()) {
+        node.NAD = factoryNAD;
+    }
+    report = linAutoAddressing->assignBySerialNumber(factoryNAD, 0x40, 0x41);
+    TEST_ASSERT_FALSE(report.complete);
+}
+
+void test_autoAddressing_snpd_positionOrder()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    // identical nodes, without serial number: only the position distinguishes them
+    for (int i = 0; i < 4; ++i) {
+        linBus->addNode(factoryNAD, 0x1234, 0x0001, 0x01, 0x00000000);
+    }
+
+    DaisyChain chain;
+    auto report = linAutoAddressing->assignBySnpd(chain, 0x10);
+
+    TEST_ASSERT_TRUE(report.complete);
+    TEST_ASSERT_EQUAL(4, report.assignments.size());
+
+    // NADs follow the position within the chain, and are stored by the nodes
+    uint8_t expectedNAD = 0x10;
+    for (const mock_LinNode& node : linBus->getNodes())
+    {
+        TEST_ASSERT_EQUAL_HEX8(expectedNAD, node.NAD);
+        TEST_ASSERT_EQUAL_HEX8(expectedNAD, node.savedNAD);
+        TEST_ASSERT_FALSE(node.snpdActive);
+        expectedNAD++;
+    }
+
+    // the hook is called once per NAD, the last NAD is not taken by any node
+    const std::vector<uint8_t> expectedCalls = {0x10, 0x11, 0x12, 0x13, 0x14};
+    TEST_ASSERT_TRUE(expectedCalls == chain.begins);
+    TEST_ASSERT_TRUE(expectedCalls == chain.ends);
+
+    // INITIALIZE + 5 * (ASSIGN_NAD + READ_BY_ID) + STORE_NAD + FINISH
+    TEST_ASSERT_EQUAL(13, report.transactions);
+
+    // limited count of nodes
+    DaisyChain limited;
+    report = linAutoAddressing->assignBySnpd(limited, 0x20, 2);
+    TEST_ASSERT_TRUE(report.complete);
+    TEST_ASSERT_EQUAL(2, report.assignments.size());
+    TEST_ASSERT_EQUAL_HEX8(0x20, linBus->getNodes()[0].NAD);
+    TEST_ASSERT_EQUAL_HEX8(0x21, linBus->getNodes()[1].NAD);
+    TEST_ASSERT_EQUAL_HEX8(0x12, linBus->getNodes()[2].NAD);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_autoAddressing_serialNumber_uniqueNADs);
+    RUN_TEST(test_autoAddressing_serialNumber_limits);
+    RUN_TEST(test_autoAddressing_snpd_positionOrder);
+
+    return UNITY_END();
+}
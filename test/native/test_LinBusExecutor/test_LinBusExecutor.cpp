@@ -0,0 +1,219 @@
+#include <unity.h>
+#include "LinBusExecutor.hpp"
+#include "LinNodeConfig.hpp"
+#include "mock_DebugStream.hpp"
+#include "mock_LinBus.h"
+#include "mock_millis.h"
+
+#include <array>
+#include <atomic>
+#include <future>
+#include <optional>
+#include <thread>
+#include <vector>
+
+mock_DebugStream debugStream;
+
+constexpr uint8_t NAD_node = 0x0A;
+constexpr uint16_t supplier_node = 0x1234;
+
+using Executor = LinBusExecutor<LinNodeConfig, 16>;
+using Priority = Executor::Priority;
+
+mock_LinBus* linBus;
+Executor* executor;
+
+void setUp()
+{
+    linBus = new mock_LinBus(1);
+    linBus->mock_verbose = false;
+    linBus->begin(19200, SERIAL_8N1);
+    linBus->addNode(NAD_node, supplier_node, 0x0001, 0x01, 0x0);
+    debugStream.mock_verbose = false;
+    executor = new Executor(*linBus, debugStream, 1);
+}
+
+void tearDown()
+{
+    delete executor;
+    linBus->end();
+    delete linBus;
+}
+
+static std::optional<uint16_t> readSupplier(LinNodeConfig &bus)
+{
+    uint8_t NAD = NAD_node;
+    uint16_t supplierId = 0x7FFF;
+    uint16_t functionId = 0x3FFF;
+    uint8_t variantId = 0;
+    if (!bus.readProductId(NAD, supplierId, functionId, variantId)) {
+        return std::nullopt;
+    }
+    return supplierId;
+}
+
+void test_busExecutor_priority()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    std::vector<int> order;
+    auto record = [&order](int id) {
+        return [&order, id](LinNodeConfig&) { order.push_back(id); };
+    };
+
+    // owner not started: all requests are queued
+    auto low = executor->submit(record(1), Priority::LOW);
+    auto normal = executor->submit(record(2), Priority::NORMAL);
+    auto high1 = executor->submit(record(3), Priority::HIGH);
+    auto high2 = executor->submit(record(4), Priority::HIGH);
+    auto read = executor->submit(readSupplier, Priority::NORMAL);
+    TEST_ASSERT_TRUE(order.empty());
+
+    // by priority, FIFO within a priority
+    TEST_ASSERT_EQUAL(5, executor->runPending());
+    const std::vector<int> expected = {3, 4, 2, 1};
+    TEST_ASSERT_TRUE(expected == order);
+
+    TEST_ASSERT_TRUE(high1.get().value());
+    TEST_ASSERT_TRUE(low.get().value());
+    auto supplier = read.get();
+    TEST_ASSERT_TRUE(supplier.has_value());
+    TEST_ASSERT_TRUE(supplier->has_value());
+    TEST_ASSERT_EQUAL_HEX16(supplier_node, **supplier);
+    TEST_ASSERT_EQUAL(5, executor->getExecuted());
+
+    // queue full: rejected, the future is ready at once
+    std::vector<std::future<std::optional<bool>>> futures;
+    for (size_t i = 0; i < 16; ++i) {
+        futures.push_back(executor->submit([](LinNodeConfig&) {}, Priority::LOW));
+    }
+    auto rejected = executor->submit([](LinNodeConfig&) {}, Priority::LOW);
+    TEST_ASSERT_FALSE(rejected.get().has_value());
+    TEST_ASSERT_EQUAL(1, executor->getRejected());
+    // other priorities are not affected
+    auto accepted = executor->submit([](LinNodeConfig&) {}, Priority::HIGH);
+    TEST_ASSERT_EQUAL(17, executor->runPending());
+    TEST_ASSERT_TRUE(accepted.get().value());
+}
+
+void test_busExecutor_deadline()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    int calls = 0;
+    std::vector<std::optional<bool>> results;
+    auto request = [&calls](LinNodeConfig&) { calls++; };
+    auto callback = [&results](std::optional<bool> result) { results.push_back(result); };
+
+    TEST_ASSERT_TRUE(executor->post(request, callback, Priority::NORMAL, 50));
+    TEST_ASSERT_TRUE(executor->post(request, callback, Priority::NORMAL, 5000));
+    TEST_ASSERT_TRUE(executor->post(request, callback, Priority::LOW));
+
+    mock_millis_value += 100;
+    TEST_ASSERT_EQUAL(3, executor->runPending());
+
+    // the expired request has not accessed the bus
+    TEST_ASSERT_EQUAL(2, calls);
+    TEST_ASSERT_EQUAL(3, results.size());
+    TEST_ASSERT_FALSE(results[0].has_value());
+    TEST_ASSERT_TRUE(results[1].value());
+    TEST_ASSERT_TRUE(results[2].value());
+    TEST_ASSERT_EQUAL(1, executor->getExpired());
+    TEST_ASSERT_EQUAL(2, executor->getExecuted());
+}
+
+void test_busExecutor_contention()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    constexpr int producerCount = 4;
+    constexpr int requestsPerProducer = 500;
+
+    std::atomic<std::thread::id> ownerId {};
+    std::atomic<int> foreignThreads {0};
+    std::atomic<int> callbacks {0};
+    // written by the owner task only
+    std::array<std::vector<int>, producerCount> sequence;
+    std::array<std::vector<std::shared_future<std::optional<std::optional<uint16_t>>>>, producerCount> futures;
+
+    executor->start();
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < producerCount; ++p)
+    {
+        producers.emplace_back([&, p]() {
+            for (int n = 0; n < requestsPerProducer; ++n)
+            {
+                auto request = [&, p, n](LinNodeConfig &bus) {
+                    std::thread::id expected {};
+                    if (!ownerId.compare_exchange_strong(expected, std::this_thread::get_id())
+                        && (expected != std::this_thread::get_id())) {
+                        foreignThreads++;
+                    }
+                    sequence[p].push_back(n);
+                    return readSupplier(bus);
+                };
+                if (n % 2) {
+                    // queue full: retry
+                    while (!executor->post(request, [&callbacks](std::optional<std::optional<uint16_t>> result) {
+                        if (result && *result && (supplier_node == **result)) {
+                            callbacks++;
+                        }
+                    })) {
+                        std::this_thread::yield();
+                    }
+                } else {
+                    // queue full: the future is ready and empty, retry
+                    while (true)
+                    {
+                        auto future = executor->submit(request).share();
+                        if ((future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) || future.get()) {
+                            futures[p].push_back(future);
+                            break;
+                        }
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        });
+    }
+    for (auto &producer : producers) {
+        producer.join();
+    }
+    executor->stop();
+
+    constexpr int total = producerCount * requestsPerProducer;
+    TEST_ASSERT_EQUAL(0, foreignThreads.load());
+    TEST_ASSERT_TRUE(ownerId.load() != std::this_thread::get_id());
+    TEST_ASSERT_EQUAL(total, executor->getExecuted());
+    TEST_ASSERT_EQUAL(0, executor->getExpired());
+    TEST_ASSERT_EQUAL(total / 2, callbacks.load());
+    TEST_ASSERT_EQUAL(total, linBus->getNodes()[0].requestCount);
+
+    for (int p = 0; p < producerCount; ++p)
+    {
+        // every request once, in order of submission per producer
+        TEST_ASSERT_EQUAL(requestsPerProducer, sequence[p].size());
+        for (int n = 0; n < requestsPerProducer; ++n) {
+            TEST_ASSERT_EQUAL(n, sequence[p][n]);
+        }
+        TEST_ASSERT_EQUAL(requestsPerProducer / 2, futures[p].size());
+        for (auto &future : futures[p]) {
+            auto result = future.get();
+            TEST_ASSERT_TRUE(result.has_value());
+            TEST_ASSERT_TRUE(result->has_value());
+            TEST_ASSERT_EQUAL_HEX16(supplier_node, **result);
+        }
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_busExecutor_priority);
+    RUN_TEST(test_busExecutor_deadline);
+    RUN_TEST(test_busExecutor_contention);
+
+    return UNITY_END();
+}
@@ -0,0 +1,143 @@
+#include <unity.h>
+#include "LinBusManager.hpp"
+#include "LinNodeConfig.hpp"
+#include "mock_DebugStream.hpp"
+#include "mock_LinBus.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+mock_DebugStream debugStream;
+
+constexpr size_t channelCount = 4;
+constexpr uint8_t NAD_node = 0x0A;
+
+std::array<std::unique_ptr<mock_LinBus>, channelCount> linBus;
+std::array<std::unique_ptr<mock_DebugStream>, channelCount> channelDebug;
+LinBusManager<LinNodeConfig>* busManager;
+
+void setUp()
+{
+    busManager = new LinBusManager<LinNodeConfig>();
+    for (size_t i = 0; i < channelCount; ++i)
+    {
+        linBus[i] = std::make_unique<mock_LinBus>(i);
+        linBus[i]->mock_verbose = false;
+        linBus[i]->begin(19200, SERIAL_8N1);
+        // same NAD on every channel, distinguished by supplier id
+        linBus[i]->addNode(NAD_node, 0x1000 + i, 0x0001, 0x01, 0x0);
+
+        // debug output of a channel is written by its worker only
+        channelDebug[i] = std::make_unique<mock_DebugStream>();
+        channelDebug[i]->mock_verbose = false;
+        TEST_ASSERT_EQUAL(i, busManager->addBus(*linBus[i], *channelDebug[i], 1));
+    }
+}
+
+void tearDown()
+{
+    delete busManager;
+
+    for (auto &bus : linBus) {
+        bus->end();
+        bus.reset();
+    }
+}
+
+void test_busManager_workers()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    constexpr int jobsPerChannel = 20;
+
+    // every list is written by the worker of its channel only
+    std::array<std::vector<uint16_t>, channelCount> suppliers;
+    std::array<std::vector<int>, channelCount> sequence;
+
+    busManager->start();
+    TEST_ASSERT_TRUE(busManager->isRunning());
+
+    for (int job = 0; job < jobsPerChannel; ++job)
+    {
+        for (size_t i = 0; i < channelCount; ++i)
+        {
+            busManager->submit(i, [&suppliers, &sequence, i, job](LinNodeConfig &bus) {
+                uint8_t NAD = NAD_node;
+                uint16_t supplierId = 0x7FFF;
+                uint16_t functionId = 0x3FFF;
+                uint8_t variantId = 0;
+                if (bus.readProductId(NAD, supplierId, functionId, variantId)) {
+                    suppliers[i].push_back(supplierId);
+                }
+                sequence[i].push_back(job);
+            });
+        }
+    }
+    TEST_ASSERT_FALSE(busManager->submit(channelCount, [](LinNodeConfig&) {}));
+
+    busManager->waitIdle();
+
+    for (size_t i = 0; i < channelCount; ++i)
+    {
+        // each job has used the bus of its channel
+        TEST_ASSERT_EQUAL(jobsPerChannel, suppliers[i].size());
+        for (uint16_t supplierId : suppliers[i]) {
+            TEST_ASSERT_EQUAL_HEX16(0x1000 + i, supplierId);
+        }
+        // in order of submission
+        for (int job = 0; job < jobsPerChannel; ++job) {
+            TEST_ASSERT_EQUAL(job, sequence[i][job]);
+        }
+        TEST_ASSERT_EQUAL(jobsPerChannel, busManager->getExecuted(i));
+        TEST_ASSERT_EQUAL(jobsPerChannel, linBus[i]->getNodes()[0].requestCount);
+    }
+
+    // queued jobs are finished by stop()
+    int late = 0;
+    busManager->submit(0, [&late](LinNodeConfig&) { late++; });
+    busManager->stop();
+    TEST_ASSERT_FALSE(busManager->isRunning());
+    TEST_ASSERT_EQUAL(1, late);
+}
+
+void test_busManager_eventLoop()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    std::vector<size_t> order;
+    for (size_t i = 0; i < channelCount; ++i)
+    {
+        for (int job = 0; job <= static_cast<int>(i); ++job) {
+            busManager->submit(i, [&order, i](LinNodeConfig &bus) {
+                uint8_t NAD = NAD_node;
+                bus.saveConfig(NAD);
+                order.push_back(i);
+            });
+        }
+    }
+
+    // one job per channel and round, channels with empty queues are skipped
+    TEST_ASSERT_EQUAL(4, busManager->runPending());
+    TEST_ASSERT_EQUAL(3, busManager->runPending());
+    const std::vector<size_t> expected = {0, 1, 2, 3, 1, 2, 3};
+    TEST_ASSERT_TRUE(expected == order);
+
+    busManager->waitIdle();
+    TEST_ASSERT_EQUAL(10, order.size());
+    TEST_ASSERT_EQUAL(0, busManager->runPending());
+
+    for (size_t i = 0; i < channelCount; ++i) {
+        TEST_ASSERT_EQUAL_HEX8(NAD_node, linBus[i]->getNodes()[0].savedNAD);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_busManager_workers);
+    RUN_TEST(test_busManager_eventLoop);
+
+    return UNITY_END();
+}
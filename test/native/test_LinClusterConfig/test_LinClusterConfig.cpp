@@ -0,0 +1,166 @@
+#include <unity.h>
+#include "LinClusterConfig.hpp"
+#include "mock_DebugStream.hpp"
+#include "mock_LinBus.h"
+
+mock_DebugStream debugStream;
+
+mock_LinBus* linBus;
+LinClusterConfig* linClusterConfig;
+
+using Action = LinClusterConfig::Action;
+
+void setUp()
+{
+    linBus = new mock_LinBus(0);
+    linBus->mock_verbose = false;
+    linBus->begin(19200, SERIAL_8N1);
+
+    // two identical products, distinguished by serial number
+    linBus->addNode(0x01, 0x1234, 0x0001, 0x01, 0x0000000A);
+    linBus->addNode(0x02, 0x1234, 0x0001, 0x01, 0x0000000B);
+    linBus->addNode(0x05, 0x4321, 0x0002, 0x01, 0x0000000C);
+    // not part of any plan
+    linBus->addNode(0x10, 0x4321, 0x0003, 0x01, 0x0000000D);
+
+    linClusterConfig = new LinClusterConfig(*linBus, debugStream, 2);
+}
+
+void tearDown()
+{
+    delete linClusterConfig;
+
+    linBus->end();
+    delete linBus;
+}
+
+// nodes 0x01 and 0x02 swap their NADs, node 0x05 moves to 0x06 and gets frame ids
+const std::vector<LinClusterConfig::NodePlan> plan = {
+    {0x1234, 0x0001, 0x0000000A, 0x02},
+    {0x1234, 0x0001, 0x0000000B, 0x01},
+    {0x4321, 0x0002, std::nullopt, 0x06, {0x80, 0xC1, 0xFF, 0xFF}}
+};
+
+void test_cluster_apply_swapWithoutCollision()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    LinNodeInventory inventory;
+    TEST_ASSERT_EQUAL(4, linClusterConfig->discover(inventory));
+
+    auto report = linClusterConfig->apply(inventory, plan);
+
+    TEST_ASSERT_TRUE(report.isConverged());
+    // 4 * ASSIGN_NAD + 1 * ASSIGN_FRAME_ID_RANGE + 3 * SAVE_CONFIG
+    TEST_ASSERT_EQUAL(8, report.getModifications());
+
+    // swap is resolved by a temporary NAD, a NAD is never used twice
+    const std::vector<LinClusterConfig::Change> expected = {
+        {Action::ASSIGN_NAD, 0x05, 0x06, true},
+        {Action::ASSIGN_NAD, 0x01, 0x7D, true},
+        {Action::ASSIGN_NAD, 0x02, 0x01, true},
+        {Action::ASSIGN_NAD, 0x7D, 0x02, true},
+        {Action::ASSIGN_FRAME_ID_RANGE, 0x06, 0x06, true},
+        {Action::SAVE_CONFIG, 0x02, 0x02, true},
+        {Action::SAVE_CONFIG, 0x01, 0x01, true},
+        {Action::SAVE_CONFIG, 0x06, 0x06, true}
+    };
+    TEST_ASSERT_EQUAL(expected.size(), report.changes.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        TEST_ASSERT_EQUAL(static_cast<int>(expected[i].action), static_cast<int>(report.changes[i].action));
+        TEST_ASSERT_EQUAL_HEX8(expected[i].NAD, report.changes[i].NAD);
+        TEST_ASSERT_EQUAL_HEX8(expected[i].newNAD, report.changes[i].newNAD);
+    }
+
+    // nodes
+    auto& nodes = linBus->getNodes();
+    TEST_ASSERT_EQUAL_HEX8(0x02, nodes[0].NAD);
+    TEST_ASSERT_EQUAL_HEX8(0x02, nodes[0].savedNAD);
+    TEST_ASSERT_EQUAL_HEX8(0x01, nodes[1].NAD);
+    TEST_ASSERT_EQUAL_HEX8(0x01, nodes[1].savedNAD);
+    TEST_ASSERT_EQUAL_HEX8(0x06, nodes[2].NAD);
+    TEST_ASSERT_EQUAL_HEX8(0x80, nodes[2].PIDs[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xC1, nodes[2].PIDs[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x10, nodes[3].NAD);
+    TEST_ASSERT_EQUAL(2, nodes[3].requestCount); // discovery only: product id + serial number
+
+    // inventory follows the cluster
+    TEST_ASSERT_EQUAL(4, inventory.size());
+    TEST_ASSERT_EQUAL_HEX32(0x0000000A, inventory.find(0x02)->serialNumber.value());
+    TEST_ASSERT_EQUAL_HEX32(0x0000000B, inventory.find(0x01)->serialNumber.value());
+    TEST_ASSERT_EQUAL_HEX8(0xC1, inventory.find(0x06)->PIDs[1]);
+    TEST_ASSERT_TRUE(inventory.find(0x05) == nullptr);
+    TEST_ASSERT_TRUE(inventory.find(0x7D) == nullptr);
+}
+
+void test_cluster_apply_convergedIsFree()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    LinNodeInventory inventory;
+    linClusterConfig->discover(inventory);
+    TEST_ASSERT_TRUE(linClusterConfig->apply(inventory, plan).isConverged());
+
+    // same plan again: nothing to do
+    int frameCount = linBus->mock_frameCount;
+    auto report = linClusterConfig->apply(inventory, plan);
+    TEST_ASSERT_TRUE(report.isConverged());
+    TEST_ASSERT_EQUAL(0, report.changes.size());
+    TEST_ASSERT_EQUAL(frameCount, linBus->mock_frameCount);
+
+    // restored inventory (e.g. after power cycle): verification pass only
+    LinNodeInventory restored;
+    TEST_ASSERT_TRUE(restored.deserialize(inventory.serialize()));
+    frameCount = linBus->mock_frameCount;
+    report = linClusterConfig->apply(restored, plan);
+    TEST_ASSERT_TRUE(report.isConverged());
+    TEST_ASSERT_EQUAL(0, report.getModifications());
+    TEST_ASSERT_EQUAL(plan.size(), report.changes.size());
+    for (const auto& change : report.changes) {
+        TEST_ASSERT_EQUAL(static_cast<int>(Action::VERIFY), static_cast<int>(change.action));
+    }
+    // single probe (request + response) per planned node
+    TEST_ASSERT_EQUAL(frameCount + 2 * plan.size(), linBus->mock_frameCount);
+}
+
+void test_cluster_apply_conflicts()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    LinNodeInventory inventory;
+    linClusterConfig->discover(inventory);
+    const int frameCount = linBus->mock_frameCount;
+
+    const std::vector<LinClusterConfig::NodePlan> conflicting = {
+        // NAD is used by a node outside of the plan
+        {0x4321, 0x0002, std::nullopt, 0x10},
+        // identical products without serial number
+        {0x1234, 0x0001, std::nullopt, 0x20},
+        // no such node
+        {0x9999, 0x0001, std::nullopt, 0x21}
+    };
+    auto report = linClusterConfig->apply(inventory, conflicting);
+
+    TEST_ASSERT_FALSE(report.isConverged());
+    TEST_ASSERT_EQUAL(0, report.getModifications());
+    TEST_ASSERT_EQUAL(3, report.changes.size());
+    for (const auto& change : report.changes) {
+        TEST_ASSERT_EQUAL(static_cast<int>(Action::MATCH), static_cast<int>(change.action));
+        TEST_ASSERT_FALSE(change.success);
+    }
+
+    // nothing was sent
+    TEST_ASSERT_EQUAL(frameCount, linBus->mock_frameCount);
+    TEST_ASSERT_EQUAL_HEX8(0x05, linBus->getNodes()[2].NAD);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_cluster_apply_swapWithoutCollision);
+    RUN_TEST(test_cluster_apply_convergedIsFree);
+    RUN_TEST(test_cluster_apply_conflicts);
+
+    return UNITY_END();
+}
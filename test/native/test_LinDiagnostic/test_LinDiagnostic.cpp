@@ -0,0 +1,200 @@
+#include <unity.h>
+#include "LinDiagnostic.hpp"
+#include "mock_HardwareSerial.h"
+#include "mock_LinBus.h"
+#include "mock_DebugStream.hpp"
+
+mock_DebugStream debugStream;
+
+mock_HardwareSerial* linDriver;
+LinDiagnostic* linDiagnostic;
+
+void setUp()
+{
+    linDriver = new mock_HardwareSerial(0);
+    linDriver->mock_loopback = true;
+    linDriver->begin(19200, SERIAL_8N1);
+
+    linDiagnostic = new LinDiagnostic(*linDriver, debugStream, 2);
+}
+
+void tearDown()
+{
+    delete linDiagnostic;
+
+    linDriver->end();
+    delete linDriver;
+}
+
+void test_diag_readDataByIdentifier_multiDID()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    constexpr uint8_t request_NAD = 0x0A;
+
+    std::vector<uint8_t> bus_transmitted = {
+    // Master Request: 0x22 F190 F187 F18C
+        0x00, 0x55, 0x3C, // Frame Head: Master Request
+        request_NAD,
+        0x10, 0x07, // First Frame, 7 Bytes
+        0x22, // SID: ReadDataByIdentifier
+        0xF1, 0x90, 0xF1, 0x87, // DID #1, DID #2 (first byte)
+        0xC0, // Frame Checksum
+
+        0x00, 0x55, 0x3C, // Frame Head: Master Request
+        request_NAD,
+        0x21, // Consecutive Frame, SN = 1
+        0xF1, 0x8C, // DID #3
+        0xFF, 0xFF, 0xFF, 0xFF, // fill bytes
+        0x56, // Frame Checksum
+
+    // Slave Response
+        0x00, 0x55, 0x7D, // Frame Head: Slave Response
+        0x00, 0x55, 0x7D, // Frame Head: Slave Response
+        0x00, 0x55, 0x7D  // Frame Head: Slave Response
+    };
+
+    linDriver->mock_Input({
+    // FF
+        request_NAD, 0x10, 0x10, // First Frame, 16 Bytes
+        0x62, 0xF1, 0x90, 0x11, 0x22, // RSID, DID #1, data
+        0xBD, // Frame Checksum
+    // CF 1
+        request_NAD, 0x21,
+        0x33, 0x44, 0xF1, 0x87, 0x01, 0x02, // data, DID #2, data
+        0xE0, // Frame Checksum
+    // CF 2
+        request_NAD, 0x22,
+        0x03, 0xF1, 0x8C, 0xAB, 0xCD, // data, DID #3, data
+        0xFF, // fill byte
+        0xD8 // Frame Checksum
+    });
+
+    uint8_t partNumber[4] {};
+    uint8_t hwVersion[3] {};
+    uint8_t swVersion[2] {};
+
+    uint8_t NAD = request_NAD;
+    auto result = linDiagnostic->readDataByIdentifier(NAD, {
+        {0xF190, partNumber, sizeof(partNumber)},
+        {0xF187, hwVersion, sizeof(hwVersion)},
+        {0xF18C, swVersion, sizeof(swVersion)}
+    });
+
+    TEST_ASSERT_TRUE(result);
+    TEST_ASSERT_EQUAL(LinDiagnostic::Status::OK, result.status);
+
+    const uint8_t expected_partNumber[] {0x11, 0x22, 0x33, 0x44};
+    const uint8_t expected_hwVersion[] {0x01, 0x02, 0x03};
+    const uint8_t expected_swVersion[] {0xAB, 0xCD};
+    TEST_ASSERT_EQUAL_MEMORY(expected_partNumber, partNumber, sizeof(partNumber));
+    TEST_ASSERT_EQUAL_MEMORY(expected_hwVersion, hwVersion, sizeof(hwVersion));
+    TEST_ASSERT_EQUAL_MEMORY(expected_swVersion, swVersion, sizeof(swVersion));
+
+    TEST_ASSERT_EQUAL(bus_transmitted.size(), linDriver->txBuffer.size());
+    TEST_ASSERT_EQUAL_MEMORY(bus_transmitted.data(), linDriver->txBuffer.data(), bus_transmitted.size());
+}
+
+void test_diag_readDataByIdentifier_NRC()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    constexpr uint8_t request_NAD = 0x0A;
+
+    linDriver->mock_Input({
+        request_NAD, 0x03, // Single Frame, 3 Bytes
+        0x7F, 0x22, 0x31, // Negative Response: Request out of range
+        0xFF, 0xFF, 0xFF, // fill bytes
+        0x20 // Frame Checksum
+    });
+
+    uint8_t buffer[4] {};
+    uint8_t NAD = request_NAD;
+    auto result = linDiagnostic->readDataByIdentifier(NAD, 0xF190, buffer, sizeof(buffer));
+
+    TEST_ASSERT_FALSE(result);
+    TEST_ASSERT_EQUAL(LinDiagnostic::Status::NEGATIVE_RESPONSE, result.status);
+    TEST_ASSERT_EQUAL(0x31, result.NRC);
+}
+
+void test_diag_writeDataByIdentifier_responsePending()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    constexpr uint8_t request_NAD = 0x0A;
+
+    std::vector<uint8_t> bus_transmitted = {
+    // Master Request: 0x2E 0123 55 AA
+        0x00, 0x55, 0x3C, // Frame Head: Master Request
+        request_NAD,
+        0x05, // Single Frame, 5 Bytes
+        0x2E, 0x01, 0x23, 0x55, 0xAA, // SID, DID, data
+        0xFF, // fill byte
+        0x9E, // Frame Checksum
+
+    // Slave Response
+        0x00, 0x55, 0x7D, // Frame Head: Slave Response (pending)
+        0x00, 0x55, 0x7D  // Frame Head: Slave Response (final)
+    };
+
+    linDriver->mock_Input({
+    // response pending
+        request_NAD, 0x03, // Single Frame, 3 Bytes
+        0x7F, 0x2E, 0x78, // Negative Response: Response pending
+        0xFF, 0xFF, 0xFF, // fill bytes
+        0xCC, // Frame Checksum
+    // final response
+        request_NAD, 0x03, // Single Frame, 3 Bytes
+        0x6E, 0x01, 0x23, // RSID, DID
+        0xFF, 0xFF, 0xFF, // fill bytes
+        0x60 // Frame Checksum
+    });
+
+    uint8_t NAD = request_NAD;
+    auto result = linDiagnostic->writeDataByIdentifier(NAD, 0x0123, {0x55, 0xAA});
+
+    TEST_ASSERT_TRUE(result);
+
+    TEST_ASSERT_EQUAL(bus_transmitted.size(), linDriver->txBuffer.size());
+    TEST_ASSERT_EQUAL_MEMORY(bus_transmitted.data(), linDriver->txBuffer.data(), bus_transmitted.size());
+}
+
+void test_diag_writeDataByIdentifier_responsePending_late()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    // final response after many empty SlaveResponse slots (far beyond the learned timing, within P2*)
+    mock_LinBus bus(1);
+    bus.mock_verbose = false;
+    bus.begin(19200, SERIAL_8N1);
+    mock_LinNode &node = bus.addNode(0x0A, 0x1234, 0x5678, 0x01, 0);
+    node.onDiagnostic = [](mock_LinNode&, const std::vector<uint8_t>& request) {
+        return std::optional<std::vector<uint8_t>>({static_cast<uint8_t>(request[0] + 0x40), request[1], request[2]});
+    };
+    node.responsePending = 2;
+    node.pendingDelay = 20;
+    LinDiagnostic diagnostic(bus, debugStream);
+
+    uint8_t NAD = 0x0A;
+    auto result = diagnostic.writeDataByIdentifier(NAD, 0x0123, {0x55, 0xAA});
+
+    TEST_ASSERT_TRUE(result);
+    TEST_ASSERT_EQUAL(1, node.requestCount);
+    // waiting for the final response is no timeout of the node
+    TEST_ASSERT_EQUAL(1, diagnostic.timingProfile.getEstimate(NAD).samples);
+    TEST_ASSERT_EQUAL(0, diagnostic.timingProfile.getEstimate(NAD).timeouts);
+
+    bus.end();
+}
+
+int main()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_diag_readDataByIdentifier_multiDID);
+    RUN_TEST(test_diag_readDataByIdentifier_NRC);
+    RUN_TEST(test_diag_writeDataByIdentifier_responsePending);
+    RUN_TEST(test_diag_writeDataByIdentifier_responsePending_late);
+
+    return UNITY_END();
+}
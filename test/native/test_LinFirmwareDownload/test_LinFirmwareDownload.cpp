@@ -0,0 +1,173 @@
+#include <unity.h>
+#include "LinFirmwareDownload.hpp"
+#include "mock_HardwareSerial.h"
+#include "mock_DebugStream.hpp"
+
+#include <algorithm>
+
+mock_DebugStream debugStream;
+
+mock_HardwareSerial* linDriver;
+LinFirmwareDownload* linDownload;
+
+constexpr uint8_t NAD_node = 0x0A;
+
+const std::vector<uint8_t> response_RequestDownload {
+    NAD_node, 0x04, // Single Frame, 4 Bytes
+    0x74, 0x20, 0x00, 0x0A, // RSID, lengthFormatIdentifier, maxNumberOfBlockLength = 10
+    0xFF, 0xFF, // fill bytes
+    0x53 // Frame Checksum
+};
+const std::vector<uint8_t> response_TransferData_1 {
+    NAD_node, 0x02, // Single Frame, 2 Bytes
+    0x76, 0x01, // RSID, blockSequenceCounter
+    0xFF, 0xFF, 0xFF, 0xFF, // fill bytes
+    0x7C // Frame Checksum
+};
+const std::vector<uint8_t> response_TransferData_2 {
+    NAD_node, 0x02, // Single Frame, 2 Bytes
+    0x76, 0x02, // RSID, blockSequenceCounter
+    0xFF, 0xFF, 0xFF, 0xFF, // fill bytes
+    0x7B // Frame Checksum
+};
+const std::vector<uint8_t> response_RequestTransferExit {
+    NAD_node, 0x01, // Single Frame, 1 Byte
+    0x77, // RSID
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, // fill bytes
+    0x7D // Frame Checksum
+};
+
+const uint8_t image[] {
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, // block 1
+    0x20, 0x21 // block 2
+};
+
+void setUp()
+{
+    linDriver = new mock_HardwareSerial(0);
+    linDriver->mock_loopback = true;
+    linDriver->begin(19200, SERIAL_8N1);
+
+    linDownload = new LinFirmwareDownload(*linDriver, debugStream, 2);
+}
+
+void tearDown()
+{
+    delete linDownload;
+
+    linDriver->end();
+    delete linDriver;
+}
+
+void test_download_ok()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    linDriver->mock_Input(response_RequestDownload);
+    linDriver->mock_Input(response_TransferData_1);
+    linDriver->mock_Input(response_TransferData_2);
+    linDriver->mock_Input(response_RequestTransferExit);
+
+    uint8_t NAD = NAD_node;
+    auto result = linDownload->download(NAD, 0x00008000, image, sizeof(image));
+
+    TEST_ASSERT_TRUE(result);
+
+    auto& progress = linDownload->getProgress();
+    TEST_ASSERT_EQUAL(sizeof(image), progress.bytesAcknowledged);
+    TEST_ASSERT_EQUAL(2, progress.blockSequenceCounter);
+
+    std::vector<uint8_t> transferData_1 {
+        0x00, 0x55, 0x3C, // Frame Head: Master Request
+        NAD_node,
+        0x10, 0x0A, // First Frame, 10 Bytes
+        0x36, 0x01, // SID: TransferData, blockSequenceCounter
+        0x10, 0x11, 0x12, // data
+        0x71, // Frame Checksum
+        0x00, 0x55, 0x3C, // Frame Head: Master Request
+        NAD_node,
+        0x21, // Consecutive Frame, SN = 1
+        0x13, 0x14, 0x15, 0x16, 0x17, // data
+        0xFF, // fill byte
+        0x6B // Frame Checksum
+    };
+    auto& tx = linDriver->txBuffer;
+    auto pos = std::search(tx.begin(), tx.end(), transferData_1.begin(), transferData_1.end());
+    TEST_ASSERT_TRUE(pos != tx.end());
+
+    auto throughput = linDownload->getThroughput();
+    TEST_ASSERT_GREATER_THAN(0, throughput.effective);
+    TEST_ASSERT_EQUAL(19200 * 6 / 124, throughput.theoretical);
+}
+
+void test_download_resume()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    linDownload->retries_max = 1;
+
+    // block 2 gets lost
+    linDriver->mock_Input(response_RequestDownload);
+    linDriver->mock_Input(response_TransferData_1);
+
+    uint8_t NAD = NAD_node;
+    auto result = linDownload->download(NAD, 0x00008000, image, sizeof(image));
+
+    TEST_ASSERT_FALSE(result);
+    TEST_ASSERT_EQUAL(LinFirmwareDownload::Status::NO_RESPONSE, result.status);
+    TEST_ASSERT_EQUAL(8, linDownload->getProgress().bytesAcknowledged);
+    TEST_ASSERT_EQUAL(1, linDownload->getProgress().blockSequenceCounter);
+
+    // continue with block 2
+    linDriver->mock_Input(response_TransferData_2);
+    linDriver->mock_Input(response_RequestTransferExit);
+    linDriver->txBuffer.clear();
+
+    result = linDownload->resume(NAD, image);
+
+    TEST_ASSERT_TRUE(result);
+    TEST_ASSERT_EQUAL(sizeof(image), linDownload->getProgress().bytesAcknowledged);
+
+    std::vector<uint8_t> transferData_2 {
+        0x00, 0x55, 0x3C, // Frame Head: Master Request
+        NAD_node,
+        0x04, // Single Frame, 4 Bytes
+        0x36, 0x02, // SID: TransferData, blockSequenceCounter
+        0x20, 0x21, // data
+        0xFF, 0xFF, // fill bytes
+        0x78 // Frame Checksum
+    };
+    TEST_ASSERT_EQUAL_MEMORY(transferData_2.data(), linDriver->txBuffer.data(), transferData_2.size());
+
+    // nothing left to resume
+    result = linDownload->resume(NAD, image);
+    TEST_ASSERT_FALSE(result);
+    TEST_ASSERT_EQUAL(LinFirmwareDownload::Status::NOT_IN_PROGRESS, result.status);
+}
+
+void test_download_noRetries()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    // no repetition: every block is still sent once, a lost block suspends the download
+    linDownload->retries_max = 0;
+    linDriver->mock_Input(response_RequestDownload);
+
+    uint8_t NAD = NAD_node;
+    auto result = linDownload->download(NAD, 0x00008000, image, sizeof(image));
+
+    TEST_ASSERT_FALSE(result);
+    TEST_ASSERT_EQUAL(LinFirmwareDownload::Status::NO_RESPONSE, result.status);
+    TEST_ASSERT_EQUAL(0, linDownload->getProgress().bytesAcknowledged);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_download_ok);
+    RUN_TEST(test_download_resume);
+    RUN_TEST(test_download_noRetries);
+
+    return UNITY_END();
+}
@@ -1,7 +1,9 @@
 #include <unity.h>
 #include "LinFrameTransfer.hpp"
 #include "mock_HardwareSerial.h"
+#include "mock_LinBus.h"
 #include "mock_DebugStream.hpp"
+#include "mock_millis.h"
 
 mock_DebugStream debugStream;
 
@@ -126,6 +128,60 @@ void test_lin_writeFrame_Write_Failed()
     TEST_ASSERT_EQUAL_MEMORY(bus_transmitted.data(), linDriver->txBuffer.data(), bus_transmitted.size());
 }
 
+void test_lin_writeFrame_Collision_Abort()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    uint8_t FrameID = 0x10;
+    std::vector<uint8_t> request = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+
+    std::vector<uint8_t> bus_received = {
+        0x3C, // stray byte of a previous frame
+        0x00, // break
+        0x55, // sync
+        0x50, // PID
+        0x01, // Data 1
+        0x12, // Data 2 --> collision
+        0x03  // Data 3
+        // rest of the frame is still on the way
+    };
+
+    linDriver->mock_loopback = false;
+    linDriver->mock_Input(bus_received);
+
+    const uint32_t start = mock_millis_value;
+    bool result = linFrameTransfer->writeFrame(FrameID, request);
+
+    TEST_ASSERT_FALSE(result); // Fail
+    // aborted at the first mismatch, not by the timeout
+    TEST_ASSERT_TRUE(mock_millis_value - start < 50);
+    // received rest of the frame is discarded
+    TEST_ASSERT_EQUAL(0, linDriver->available());
+}
+
+void test_lin_writeFrame_StaleBytes()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    std::vector<uint8_t> bus_received = {
+        0x00, // stale byte (e.g. late byte of a node)
+        0x12, // noise --> no sync, our break follows
+        0x00, // break
+        0x55, // sync
+        0x50, // PID
+        0x01, // Data 1
+        0xAE  // checksum
+    };
+
+    linDriver->mock_loopback = false;
+    linDriver->mock_Input(bus_received);
+
+    bool result = linFrameTransfer->writeFrame(0x10, {0x01});
+
+    TEST_ASSERT_TRUE(result);
+    TEST_ASSERT_EQUAL(0, linDriver->available());
+}
+
 void test_lin_writeFrame_Empty()
 {
     std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
@@ -352,12 +408,239 @@ void test_lin_readFrame_BusTimeout()
     TEST_ASSERT_EQUAL_MEMORY(bus_transmitted.data(), linDriver->txBuffer.data(), bus_transmitted.size());
 }
 
+void test_lin_readFrames_Arena()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    using FrameStatus = LinFrameTransfer::FrameStatus;
+
+    mock_LinBus bus(1);
+    bus.mock_verbose = false;
+    bus.begin(19200, SERIAL_8N1);
+    bus.published[0x10] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+    bus.published[0x11] = {0x11, 0x12};
+    bus.published[0x13] = {0x31, 0x32, 0x33, 0x34};
+    LinFrameTransfer frameTransfer(bus, debugStream, 1);
+
+    const std::array<LinFrameTransfer::FrameRequest, 5> requests {{
+        {0x10, 8},
+        {0x11, 2},
+        {0x12, 8}, // not published: no response
+        {0x13, 4},
+        {0x10, 8}  // data of the arena exhausted
+    }};
+    LinFrameTransfer::ResultArena arena(requests.size(), 18);
+
+    size_t succeeded = frameTransfer.readFrames(requests, arena);
+
+    TEST_ASSERT_EQUAL(3, succeeded);
+    TEST_ASSERT_EQUAL(5, arena.size());
+    TEST_ASSERT_EQUAL(4, bus.mock_frameCount); // no header for the overflow
+
+    const FrameStatus status[] = {FrameStatus::Ok, FrameStatus::Ok, FrameStatus::NoResponse, FrameStatus::Ok, FrameStatus::Overflow};
+    const uint8_t length[] = {8, 2, 0, 4, 0};
+    for (size_t i = 0; i < arena.size(); ++i)
+    {
+        TEST_ASSERT_EQUAL(requests[i].frameID, arena[i].frameID);
+        TEST_ASSERT_EQUAL(status[i], arena[i].status);
+        TEST_ASSERT_EQUAL(length[i], arena[i].length);
+    }
+
+    // contiguous data
+    const uint8_t data[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x11, 0x12, 0x31, 0x32, 0x33, 0x34};
+    TEST_ASSERT_EQUAL_MEMORY(data, arena.getData(arena[0]), sizeof(data));
+    TEST_ASSERT_EQUAL(10, arena[3].offset);
+
+    bus.end();
+}
+
+void test_lin_readbackPolicy()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    using ReadbackPolicy = LinFrameTransfer::ReadbackPolicy;
+    std::vector<uint8_t> request = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+
+    linFrameTransfer->setReadbackPolicy(ReadbackPolicy::Skip);
+    linFrameTransfer->setReadbackPolicy(0x3C, ReadbackPolicy::Discard);
+    TEST_ASSERT_EQUAL(ReadbackPolicy::Skip, linFrameTransfer->getReadbackPolicy(0x10));
+    TEST_ASSERT_EQUAL(ReadbackPolicy::Discard, linFrameTransfer->getReadbackPolicy(0x3C));
+
+    // Skip: readback stays in the buffer until the next frame
+    TEST_ASSERT_TRUE(linFrameTransfer->writeFrame(0x10, request));
+    TEST_ASSERT_EQUAL(12, linDriver->available());
+
+    // Discard: readback of the skipped frame is purged first, own readback is removed
+    TEST_ASSERT_TRUE(linFrameTransfer->writeFrame(0x3C, request));
+    TEST_ASSERT_EQUAL(0, linDriver->available());
+    TEST_ASSERT_EQUAL(1, linFrameTransfer->getReadbackStats(ReadbackPolicy::Skip).frames);
+    TEST_ASSERT_EQUAL(0, linFrameTransfer->getReadbackStats(ReadbackPolicy::Skip).errors);
+    TEST_ASSERT_EQUAL(1, linFrameTransfer->getReadbackStats(ReadbackPolicy::Discard).frames);
+    TEST_ASSERT_EQUAL(0, linFrameTransfer->getReadbackStats(ReadbackPolicy::Discard).errors);
+
+    // no echo (e.g. transceiver in sleep): caught by the purge before the next frame
+    linDriver->mock_loopback = false;
+    TEST_ASSERT_TRUE(linFrameTransfer->writeFrame(0x3C, request));
+    TEST_ASSERT_EQUAL(0, linFrameTransfer->getReadbackStats(ReadbackPolicy::Discard).errors);
+    TEST_ASSERT_TRUE(linFrameTransfer->writeFrame(0x10, request));
+    TEST_ASSERT_EQUAL(1, linFrameTransfer->getReadbackStats(ReadbackPolicy::Discard).errors);
+    TEST_ASSERT_TRUE(linFrameTransfer->writeFrame(0x10, request));
+    TEST_ASSERT_EQUAL(1, linFrameTransfer->getReadbackStats(ReadbackPolicy::Skip).errors);
+
+    // Verify: per call
+    TEST_ASSERT_FALSE(linFrameTransfer->writeFrame(0x10, request, ReadbackPolicy::Verify));
+    TEST_ASSERT_EQUAL(1, linFrameTransfer->getReadbackStats(ReadbackPolicy::Verify).frames);
+    TEST_ASSERT_EQUAL(1, linFrameTransfer->getReadbackStats(ReadbackPolicy::Verify).errors);
+
+    linFrameTransfer->resetReadbackStats();
+    TEST_ASSERT_EQUAL(0, linFrameTransfer->getReadbackStats(ReadbackPolicy::Skip).frames);
+}
+
+void test_lin_readbackPolicy_DelayedEcho()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    using ReadbackPolicy = LinFrameTransfer::ReadbackPolicy;
+    linDriver->mock_loopback = false;
+
+    // echo is delivered after flush() by the RX FIFO timeout of the UART: partly, then the rest
+    linDriver->mock_Input({0x00, 0x55});
+    TEST_ASSERT_TRUE(linFrameTransfer->writeFrame(0x3C, {0x01}, ReadbackPolicy::Discard));
+    linDriver->mock_Input({0x3C, 0x01, 0xFE});
+    TEST_ASSERT_EQUAL(0, linFrameTransfer->getReadbackStats(ReadbackPolicy::Discard).errors);
+
+    // the rest is purged before the next frame, the verified readback is not disturbed
+    linDriver->mock_loopback = true;
+    TEST_ASSERT_TRUE(linFrameTransfer->writeFrame(0x10, {0x01}, ReadbackPolicy::Verify));
+    TEST_ASSERT_EQUAL(0, linFrameTransfer->getReadbackStats(ReadbackPolicy::Discard).errors);
+    TEST_ASSERT_EQUAL(0, linFrameTransfer->getReadbackStats(ReadbackPolicy::Verify).errors);
+}
+
+void test_lin_break_HalfBaud_Cost()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    linDriver->mock_updateBaudRate_us = 300; // reconfiguration of the UART
+
+    bool result = linFrameTransfer->writeFrame(0x10, {});
+
+    TEST_ASSERT_TRUE(result);
+
+    // default strategy: half baud rate, the UART is reconfigured twice
+    LinBreakStrategy &strategy = linFrameTransfer->getBreakStrategy();
+    TEST_ASSERT_EQUAL_STRING("half-baud", strategy.getName());
+    TEST_ASSERT_EQUAL(1, strategy.getCost().count);
+    TEST_ASSERT_EQUAL(600, strategy.getCost().last_us);
+    TEST_ASSERT_TRUE(strategy.meetsSpec(linFrameTransfer->baud));
+}
+
+void test_lin_break_Select()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    linDriver->mock_updateBaudRate_us = 300;
+
+    LinHalfBaudBreak halfBaud;
+    LinNativeBreak native([](const uint32_t) {
+        linDriver->mock_Break();
+        return true;
+    });
+    LinNativeBreak unsupported(nullptr);
+    // break is too short: 10 Tbit
+    LinGpioBreak gpioShort([](const bool dominant) {
+        if (dominant) {
+            linDriver->mock_Break();
+        }
+    }, 10);
+
+    LinBreakStrategy* selected = linFrameTransfer->selectBreakStrategy({&halfBaud, &unsupported, &gpioShort, &native});
+
+    TEST_ASSERT_EQUAL_PTR(&native, selected);
+    TEST_ASSERT_EQUAL_PTR(&native, &linFrameTransfer->getBreakStrategy());
+    TEST_ASSERT_EQUAL(600, halfBaud.getMeanCost());
+    TEST_ASSERT_FALSE(gpioShort.meetsSpec(linFrameTransfer->baud));
+    TEST_ASSERT_EQUAL(0, unsupported.getCost().count);
+    TEST_ASSERT_EQUAL(0, linDriver->available()); // readback of the calibration discarded
+
+    // frames by the native break
+    linDriver->txBuffer.clear();
+    std::vector<uint8_t> bus_transmitted = {
+        0x00, // break
+        0x55, // sync
+        0x50  // PID = FID + 0x40
+    };
+
+    bool result = linFrameTransfer->writeFrame(0x10, {});
+
+    TEST_ASSERT_TRUE(result);
+    TEST_ASSERT_EQUAL(4 + 1, native.getCost().count);
+    TEST_ASSERT_EQUAL(0, native.getCost().last_us);
+
+    TEST_ASSERT_EQUAL(bus_transmitted.size(), linDriver->txBuffer.size());
+    TEST_ASSERT_EQUAL_MEMORY(bus_transmitted.data(), linDriver->txBuffer.data(), bus_transmitted.size());
+}
+
+void test_lin_frameStats()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    linDriver->mock_updateBaudRate_us = 300; // duration of the break: 2 reconfigurations of the UART
+
+    // success, latency from the start of the break
+    TEST_ASSERT_TRUE(linFrameTransfer->writeFrame(0x10, {0x01, 0x02}));
+
+    // checksum error
+    linDriver->mock_Input({0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08});
+    linDriver->mock_Input(0x00);
+    TEST_ASSERT_FALSE(linFrameTransfer->readFrame(0x04, 8).has_value());
+
+    // no response
+    TEST_ASSERT_FALSE(linFrameTransfer->readFrame(0x04, 8).has_value());
+
+    // readback mismatch (collision) and PID error
+    linDriver->mock_loopback = false;
+    linDriver->mock_Input({0x00, 0x55, 0x50, 0x01, 0x12});
+    TEST_ASSERT_FALSE(linFrameTransfer->writeFrame(0x10, {0x01, 0x02}));
+    linDriver->mock_Input({0x00, 0x55, 0x50});
+    TEST_ASSERT_FALSE(linFrameTransfer->readFrame(0x11, 2).has_value());
+
+    // unverified
+    TEST_ASSERT_TRUE(linFrameTransfer->writeFrame(0x12, {0x01}, LinFrameTransfer::ReadbackPolicy::Skip));
+
+    LinFrameStats::Snapshot write = linFrameTransfer->frameStats.snapshot(0x10);
+    TEST_ASSERT_EQUAL(2, write.attempts);
+    TEST_ASSERT_EQUAL(1, write.successes);
+    TEST_ASSERT_EQUAL(1, write.readbackMismatches);
+    TEST_ASSERT_EQUAL(600, write.latencyMin_us);
+    TEST_ASSERT_EQUAL(600, write.latencyMean_us);
+    TEST_ASSERT_EQUAL(600, write.latencyMax_us);
+
+    LinFrameStats::Table table;
+    linFrameTransfer->frameStats.snapshot(table);
+    TEST_ASSERT_EQUAL(2, table[0x04].attempts);
+    TEST_ASSERT_EQUAL(0, table[0x04].successes);
+    TEST_ASSERT_EQUAL(1, table[0x04].checksumErrors);
+    TEST_ASSERT_EQUAL(1, table[0x04].timeouts);
+    TEST_ASSERT_EQUAL(0, table[0x04].latencyMax_us);
+    TEST_ASSERT_EQUAL(1, table[0x11].attempts);
+    TEST_ASSERT_EQUAL(1, table[0x11].headErrors);
+    TEST_ASSERT_EQUAL(1, table[0x12].attempts);
+    TEST_ASSERT_EQUAL(0, table[0x12].successes);
+    TEST_ASSERT_EQUAL(0, table[0x3F].attempts);
+
+    linFrameTransfer->frameStats.reset();
+    TEST_ASSERT_EQUAL(0, linFrameTransfer->frameStats.snapshot(0x10).attempts);
+    TEST_ASSERT_EQUAL(0, linFrameTransfer->frameStats.snapshot(0x10).latencyMin_us);
+}
+
 int main()
 {
     UNITY_BEGIN();
 
     RUN_TEST(test_lin_writeFrame_Ok);
     RUN_TEST(test_lin_writeFrame_Write_Failed);
+    RUN_TEST(test_lin_writeFrame_Collision_Abort);
+    RUN_TEST(test_lin_writeFrame_StaleBytes);
     RUN_TEST(test_lin_writeFrame_Empty);
     RUN_TEST(test_lin_writeFrame_MaxData);
     RUN_TEST(test_lin_writeFrame_RepeatTransmission);
@@ -367,6 +650,15 @@ int main()
     RUN_TEST(test_lin_readFrame_FrameShort);
     RUN_TEST(test_lin_readFrame_BusTimeout);
 
+    RUN_TEST(test_lin_readFrames_Arena);
+
+    RUN_TEST(test_lin_readbackPolicy);
+    RUN_TEST(test_lin_readbackPolicy_DelayedEcho);
+
+    RUN_TEST(test_lin_break_HalfBaud_Cost);
+    RUN_TEST(test_lin_break_Select);
+    RUN_TEST(test_lin_frameStats);
+
 
     return UNITY_END();
 }
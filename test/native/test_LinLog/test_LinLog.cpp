@@ -0,0 +1,188 @@
+#include <unity.h>
+#include "LinLog.hpp"
+#include "LinFrameTransfer.hpp"
+#include "mock_HardwareSerial.h"
+#include "mock_DebugStream.hpp"
+#include "mock_micros.h"
+
+#include <string>
+
+// collects the formatted output
+class mock_StringStream : public mock_DebugStream {
+public:
+    std::string text;
+
+    size_t write(uint8_t c) override {
+        text.push_back(static_cast<char>(c));
+        return 1;
+    }
+};
+
+mock_StringStream debugStream;
+
+mock_HardwareSerial* linDriver;
+LinFrameTransfer* linFrameTransfer;
+
+void setUp()
+{
+    linDriver = new mock_HardwareSerial(0);
+    linDriver->mock_loopback = true;
+    linDriver->mock_verbose = false;
+    linDriver->begin(19200, SERIAL_8N1);
+
+    debugStream.text.clear();
+    linFrameTransfer = new LinFrameTransfer(*linDriver, debugStream, 2);
+}
+
+void tearDown()
+{
+    delete linFrameTransfer;
+
+    linDriver->end();
+    delete linDriver;
+}
+
+void test_log_Level()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    LinLog log;
+    TEST_ASSERT_TRUE(LinLogLevel::Error == log.getLevel());
+
+    const uint8_t data[] = {0x01, 0x02};
+    log.log(LinLogLevel::Verbose, LinLogEvent::FrameReaderReset);
+    log.log(LinLogLevel::Error, LinLogEvent::ChecksumMismatch, uint8_t{0x50}, uint8_t{0x00}, uint8_t{0xAC}, LinLog::Bytes{data, sizeof(data)});
+
+    // binary record: event and arguments
+    LinLog::Record record;
+    TEST_ASSERT_TRUE(log.pop(record));
+    TEST_ASSERT_TRUE(LinLogEvent::ChecksumMismatch == record.event);
+    TEST_ASSERT_EQUAL(6, record.length);
+    const uint8_t args[] = {0x50, 0x00, 0xAC, 2, 0x01, 0x02};
+    TEST_ASSERT_EQUAL_MEMORY(args, record.args.data(), sizeof(args));
+    TEST_ASSERT_FALSE(log.pop(record));
+
+    mock_StringStream stream;
+    LinLog::print(record, stream);
+    TEST_ASSERT_EQUAL_STRING(" --- FID 10h        = 55|50|1.2.\b|0 Checksum mismatch, expected AC\n", stream.text.c_str());
+
+    // changed at runtime
+    log.setLevel(LinLogLevel::Verbose);
+    log.log(LinLogLevel::Verbose, LinLogEvent::BreakStrategyCost, uint8_t{1}, uint8_t{1}, uint32_t{70000});
+    log.setLevel(LinLogLevel::None);
+    log.log(LinLogLevel::Error, LinLogEvent::FrameTimeout, uint8_t{0x50});
+
+    stream.text.clear();
+    TEST_ASSERT_EQUAL(1, log.drain(stream));
+    TEST_ASSERT_EQUAL_STRING("LIN break candidate 1: mean cost [us] 70000\n", stream.text.c_str());
+}
+
+void test_log_Overflow()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    LinLog log;
+    for (size_t i = 0; i < LinLog::CAPACITY + 8; ++i) {
+        log.log(LinLogLevel::Error, LinLogEvent::PduFrameSize, static_cast<uint8_t>(i));
+    }
+    TEST_ASSERT_EQUAL(8, log.getDropped());
+
+    mock_StringStream stream;
+    TEST_ASSERT_EQUAL(2, log.drain(stream, 2));
+    TEST_ASSERT_EQUAL_STRING("Invalid frame size for PDU: 0\nInvalid frame size for PDU: 1\nlog: 8 records dropped\n", stream.text.c_str());
+    TEST_ASSERT_EQUAL(0, log.getDropped());
+
+    // space again
+    log.log(LinLogLevel::Error, LinLogEvent::PduFrameSize, uint8_t{0xFF});
+    TEST_ASSERT_EQUAL(0, log.getDropped());
+    TEST_ASSERT_EQUAL(LinLog::CAPACITY - 1, log.drain(stream));
+}
+
+void test_log_Deferred()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    // response with invalid checksum
+    linDriver->mock_Input({0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08});
+    linDriver->mock_Input(0x00);
+
+    TEST_ASSERT_FALSE(linFrameTransfer->readFrame(0x04, 8).has_value());
+
+    // nothing formatted within the frame
+    TEST_ASSERT_EQUAL(0, debugStream.text.size());
+
+    TEST_ASSERT_EQUAL(2, linFrameTransfer->drainLog());
+    TEST_ASSERT_EQUAL_STRING(
+        " --- FID 4h        = 55|C4|1.2.3.4.5.6.7.8.\b|0 Checksum mismatch, expected 17\n"
+        "timeout: no valid frame received, PID C4\n",
+        debugStream.text.c_str());
+}
+
+void test_log_Repeated()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    LinLog log;
+    for (int i = 0; i < 100; ++i) {
+        log.logRepeated(LinLogLevel::Error, LinLogEvent::FrameTimeout, 0x3D, uint8_t{0x7D});
+        log.logRepeated(LinLogLevel::Error, LinLogEvent::PduFrameMissing, 0x0A, uint8_t{0x0A});
+    }
+
+    // first of each is recorded only
+    mock_StringStream stream;
+    TEST_ASSERT_EQUAL(2, log.drain(stream));
+    TEST_ASSERT_EQUAL_STRING("timeout: no valid frame received, PID 7D\nFailed to read initial PDU, NAD A\n", stream.text.c_str());
+
+    // window not elapsed
+    delayMicroseconds(LinLog::REPEAT_WINDOW_us / 2);
+    log.flushRepeated(micros());
+    TEST_ASSERT_EQUAL(0, log.drain(stream));
+
+    delayMicroseconds(LinLog::REPEAT_WINDOW_us / 2);
+    log.flushRepeated(micros());
+    stream.text.clear();
+    TEST_ASSERT_EQUAL(2, log.drain(stream));
+    TEST_ASSERT_EQUAL_STRING(
+        "99 frame timeouts on 0x3D in the last 1000 ms\n"
+        "99 missing PDU frames on 0xA in the last 1000 ms\n",
+        stream.text.c_str());
+
+    // storm is over: slots are released after a window without repetition
+    delayMicroseconds(LinLog::REPEAT_WINDOW_us);
+    log.flushRepeated(micros());
+    TEST_ASSERT_EQUAL(0, log.drain(stream));
+    log.logRepeated(LinLogLevel::Error, LinLogEvent::FrameTimeout, 0x3D, uint8_t{0x7D});
+    TEST_ASSERT_EQUAL(1, log.drain(stream));
+}
+
+void test_log_Repeated_Frames()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    // node does not respond
+    for (int i = 0; i < 5; ++i) {
+        TEST_ASSERT_FALSE(linFrameTransfer->readFrame(0x3D, 8).has_value());
+    }
+    TEST_ASSERT_EQUAL(1, linFrameTransfer->drainLog());
+
+    // summary is recorded before the next frame after the window, the storm continues in a new window
+    delayMicroseconds(LinLog::REPEAT_WINDOW_us);
+    TEST_ASSERT_FALSE(linFrameTransfer->readFrame(0x3D, 8).has_value());
+
+    debugStream.text.clear();
+    TEST_ASSERT_EQUAL(1, linFrameTransfer->drainLog());
+    TEST_ASSERT_EQUAL_STRING("4 frame timeouts on 0x3D in the last 1000 ms\n", debugStream.text.c_str());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_log_Level);
+    RUN_TEST(test_log_Overflow);
+    RUN_TEST(test_log_Deferred);
+    RUN_TEST(test_log_Repeated);
+    RUN_TEST(test_log_Repeated_Frames);
+
+    return UNITY_END();
+}
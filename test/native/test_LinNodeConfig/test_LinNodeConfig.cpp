@@ -2,6 +2,8 @@
 #include "LinNodeConfig.hpp"
 #include "mock_HardwareSerial.h"
 #include "mock_DebugStream.hpp"
+#include "mock_LinBus.h"
+#include "mock_millis.h"
 
 mock_DebugStream debugStream;
 
@@ -106,9 +108,10 @@ void test_lin_getID() {
     uint16_t supplierId = request_SupplierId;
     uint16_t functionId = request_FunctionId;
     uint8_t variant = 0;
-    bool result = linNodeConfig->readProductId(NAD, supplierId, functionId, variant);
+    auto result = linNodeConfig->readProductId(NAD, supplierId, functionId, variant);
 
     TEST_ASSERT_TRUE(result);
+    TEST_ASSERT_EQUAL(response_NAD, result.NAD);
 
     TEST_ASSERT_EQUAL(response_NAD, NAD);
     TEST_ASSERT_EQUAL(response_supplierId, supplierId);
@@ -134,10 +137,10 @@ void test_lin_serialNumber()
         request_NAD, // NAD Wildcard
         0x06, // PID: Single Frame, 6 Byte
         0xB2, // SID: Read by identifier
-        0x00, // Identifier: Serial number
+        0x01, // Identifier: Serial number
         lowerByte(request_SupplierId), upperByte(request_SupplierId), // Supplier ID LSB, MSB
         lowerByte(request_FunctionId), upperByte(request_FunctionId), // Function ID LSB, MSB
-        0x09, // Frame: Checksum
+        0x08, // Frame: Checksum
 
         0x00, 0x55, 0x7D // Frame Head: Slave Response
     };
@@ -158,12 +161,14 @@ void test_lin_serialNumber()
     uint8_t NAD = request_NAD;
     uint16_t supplierId = request_SupplierId;
     uint16_t functionId = request_FunctionId;
-    auto result = linNodeConfig->readSerialNumber(NAD, supplierId, functionId);
+    uint32_t serialNumber = 0;
+    auto result = linNodeConfig->readSerialNumber(NAD, supplierId, functionId, serialNumber);
 
     TEST_ASSERT_EQUAL(response_NAD, NAD);  // <-- answer will follow on old NAD
 
     TEST_ASSERT_TRUE(result);
-    TEST_ASSERT_EQUAL_UINT32(response_SN, result.value());
+    TEST_ASSERT_EQUAL_UINT32(response_SN, serialNumber);
+    TEST_ASSERT_EQUAL(4, result.length);
 
     TEST_ASSERT_EQUAL(bus_transmitted.size(), linDriver->txBuffer.size());
     TEST_ASSERT_EQUAL_MEMORY(bus_transmitted.data(), linDriver->txBuffer.data(), bus_transmitted.size());
@@ -204,7 +209,7 @@ void test_lin_assignNAD_ok()
     linDriver->mock_Input(response);
 
     uint8_t NAD = request_NAD;
-    bool result = linNodeConfig->assignNAD(NAD, request_SupplierId, request_FunctionId, request_NAD_new);
+    auto result = linNodeConfig->assignNAD(NAD, request_SupplierId, request_FunctionId, request_NAD_new);
 
     TEST_ASSERT_TRUE(result);
 
@@ -253,7 +258,7 @@ void test_lin_conditionalChangeNAD_ok()
     linDriver->mock_Input(response);
 
     uint8_t NAD = request_NAD;
-    bool result = linNodeConfig->conditionalChangeNAD(NAD, request_id, request_byte, request_invert, request_mask, request_NAD_new);
+    auto result = linNodeConfig->conditionalChangeNAD(NAD, request_id, request_byte, request_invert, request_mask, request_NAD_new);
 
     TEST_ASSERT_TRUE(result);
 
@@ -293,7 +298,7 @@ void test_lin_saveConfig_ok()
     linDriver->mock_Input(response);
 
     uint8_t NAD = request_NAD;
-    bool result = linNodeConfig->saveConfig(NAD);
+    auto result = linNodeConfig->saveConfig(NAD);
 
     TEST_ASSERT_TRUE(result);
 
@@ -342,7 +347,7 @@ void test_lin_AssignFrameIdRange_ok()
     linDriver->mock_Input(response);
 
     uint8_t NAD = request_NAD;
-    bool result = linNodeConfig->assignFrameIdRange(NAD, request_start, request_PID0, request_PID1, request_PID2, request_PID3);
+    auto result = linNodeConfig->assignFrameIdRange(NAD, request_start, request_PID0, request_PID1, request_PID2, request_PID3);
 
     TEST_ASSERT_TRUE(result);
 
@@ -352,6 +357,192 @@ void test_lin_AssignFrameIdRange_ok()
     TEST_ASSERT_EQUAL_MEMORY(bus_transmitted.data(), linDriver->txBuffer.data(), bus_transmitted.size());
 }
 
+void test_lin_readById_cached()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    mock_LinBus bus(1);
+    bus.mock_verbose = false;
+    bus.begin(19200, SERIAL_8N1);
+    mock_LinNode& node = bus.addNode(0x0A, 0x1234, 0x5678, 0x01, 0x76543210);
+    node.userIdentifiers[32] = {0x11, 0x22, 0x33, 0x44, 0x55};
+
+    LinNodeConfig nodeConfig(bus, debugStream);
+    using ReadMode = LinNodeConfig::ReadMode;
+
+    // first read: bus
+    uint8_t NAD = 0x0A;
+    uint16_t supplierId = 0x7FFF;
+    uint16_t functionId = 0x3FFF;
+    uint8_t variantId = 0;
+    TEST_ASSERT_TRUE(nodeConfig.readProductId(NAD, supplierId, functionId, variantId, ReadMode::CACHED));
+    TEST_ASSERT_EQUAL_HEX16(0x1234, supplierId);
+    uint32_t serialNumber = 0;
+    TEST_ASSERT_TRUE(nodeConfig.readSerialNumber(NAD, 0x7FFF, 0x3FFF, serialNumber, ReadMode::CACHED));
+    TEST_ASSERT_TRUE(nodeConfig.readById(NAD, 0x7FFF, 0x3FFF, 32, ReadMode::CACHED));
+    TEST_ASSERT_EQUAL(3, node.requestCount);
+
+    // identity checks: no bus time
+    const int frameCount = bus.mock_frameCount;
+    for (int i = 0; i < 10; ++i) {
+        supplierId = 0x7FFF;
+        functionId = 0x3FFF;
+        TEST_ASSERT_TRUE(nodeConfig.readProductId(NAD, supplierId, functionId, variantId, ReadMode::CACHED));
+        TEST_ASSERT_EQUAL_HEX16(0x5678, functionId);
+        serialNumber = 0;
+        auto cached = nodeConfig.readSerialNumber(NAD, 0x7FFF, 0x3FFF, serialNumber, ReadMode::CACHED);
+        TEST_ASSERT_TRUE(cached);
+        TEST_ASSERT_EQUAL(0, cached.elapsed);
+        TEST_ASSERT_EQUAL_HEX32(0x76543210, serialNumber);
+        auto user = nodeConfig.readById(NAD, 0x7FFF, 0x3FFF, 32, ReadMode::CACHED);
+        TEST_ASSERT_EQUAL(5, user.length);
+        TEST_ASSERT_EQUAL_HEX8(0x55, user.data[4]);
+    }
+    TEST_ASSERT_EQUAL(frameCount, bus.mock_frameCount);
+
+    // other filter, or fresh read (default): bus
+    TEST_ASSERT_TRUE(nodeConfig.readSerialNumber(NAD, 0x1234, 0x5678, serialNumber, ReadMode::CACHED));
+    TEST_ASSERT_TRUE(nodeConfig.readSerialNumber(NAD, 0x7FFF, 0x3FFF, serialNumber));
+    TEST_ASSERT_EQUAL(5, node.requestCount);
+
+    // reconfiguration: cache of old and new NAD is invalid
+    node.serialNumber = 0x01020304;
+    TEST_ASSERT_TRUE(nodeConfig.assignNAD(NAD, 0x7FFF, 0x3FFF, 0x0B));
+    NAD = 0x0A;
+    TEST_ASSERT_FALSE(nodeConfig.readSerialNumber(NAD, 0x7FFF, 0x3FFF, serialNumber, ReadMode::CACHED));
+    NAD = 0x0B;
+    TEST_ASSERT_TRUE(nodeConfig.readSerialNumber(NAD, 0x7FFF, 0x3FFF, serialNumber, ReadMode::CACHED));
+    TEST_ASSERT_EQUAL_HEX32(0x01020304, serialNumber);
+
+    // save configuration: cache is invalid
+    TEST_ASSERT_TRUE(nodeConfig.saveConfig(NAD));
+    int requestCount = node.requestCount;
+    TEST_ASSERT_TRUE(nodeConfig.readSerialNumber(NAD, 0x7FFF, 0x3FFF, serialNumber, ReadMode::CACHED));
+    TEST_ASSERT_EQUAL(requestCount + 1, node.requestCount);
+
+    // identifiers with dynamic content are never cached
+    nodeConfig.readById(NAD, 0x7FFF, 0x3FFF, 2, ReadMode::CACHED);
+    nodeConfig.readById(NAD, 0x7FFF, 0x3FFF, 2, ReadMode::CACHED);
+    TEST_ASSERT_EQUAL(requestCount + 3, node.requestCount);
+
+    bus.end();
+}
+
+void test_lin_negativeResponse()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    mock_LinBus bus(1);
+    bus.mock_verbose = false;
+    bus.begin(19200, SERIAL_8N1);
+    bus.addNode(0x0A, 0x1234, 0x5678, 0x01, 0x76543210);
+
+    LinNodeConfig nodeConfig(bus, debugStream);
+    using Status = LinNodeConfig::Status;
+
+    // reserved identifier: NRC SUBFUNCTION_NOT_SUPPORTED
+    uint8_t NAD = 0x0A;
+    auto result = nodeConfig.readById(NAD, 0x7FFF, 0x3FFF, 2);
+    TEST_ASSERT_FALSE(result);
+    TEST_ASSERT_EQUAL(static_cast<int>(Status::NEGATIVE_RESPONSE), static_cast<int>(result.status));
+    TEST_ASSERT_EQUAL_HEX8(LinNegativeResponse::SUBFUNCTION_NOT_SUPPORTED, result.NRC);
+    TEST_ASSERT_EQUAL_STRING("NRC_SUBFUNCTION_NOT_SUPPORTED", result.getNrcString());
+    TEST_ASSERT_EQUAL_HEX8(0x0A, result.NAD);
+    TEST_ASSERT_GREATER_THAN(0, result.elapsed);
+
+    // unknown NAD: no response
+    NAD = 0x0B;
+    result = nodeConfig.saveConfig(NAD);
+    TEST_ASSERT_EQUAL(static_cast<int>(Status::NO_RESPONSE), static_cast<int>(result.status));
+    TEST_ASSERT_EQUAL(0, result.length);
+
+    // shared table, evaluated at compile time
+    static_assert(LinNegativeResponse::toString(0x78)[4] == 'R', "NRC table");
+    TEST_ASSERT_EQUAL_STRING("Unknown NegativeResponseCode", LinNegativeResponse::toString(0x01));
+
+    bus.end();
+}
+
+void test_lin_dataDump()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    mock_LinBus bus(1);
+    bus.mock_verbose = false;
+    bus.begin(19200, SERIAL_8N1);
+    mock_LinNode& node = bus.addNode(0x0A, 0x1234, 0x5678, 0x01, 0x76543210);
+
+    LinNodeConfig nodeConfig(bus, debugStream);
+
+    // mock node stores D1..D5 and returns them
+    uint8_t NAD = 0x0A;
+    auto result = nodeConfig.dataDump(NAD, {0x01, 0x02, 0x03, 0x04, 0x05});
+    TEST_ASSERT_TRUE(result);
+    TEST_ASSERT_EQUAL(5, result.length);
+    const std::array<uint8_t, 5> expected {0x01, 0x02, 0x03, 0x04, 0x05};
+    TEST_ASSERT_EQUAL_MEMORY(expected.data(), result.data.data(), expected.size());
+    TEST_ASSERT_EQUAL_MEMORY(expected.data(), node.dataDump.data(), expected.size());
+
+    bus.end();
+}
+
+void test_lin_batch_commissioning()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    constexpr uint8_t nodeCount = 16;
+
+    mock_LinBus bus(1);
+    bus.mock_verbose = false;
+    bus.begin(19200, SERIAL_8N1);
+    for (uint8_t i = 0; i < nodeCount; ++i) {
+        bus.addNode(0x01 + i, 0x1234, 0x5678, 0x01, 0x1000 + i);
+    }
+    // node 0x05 is missing
+    bus.getNodes()[4].silent = true;
+
+    LinNodeConfig nodeConfig(bus, debugStream);
+
+    // commissioning service by service: frame ids and save of every node
+    uint32_t elapsedSingle = 0;
+    for (uint8_t i = 0; i < nodeCount; ++i)
+    {
+        uint8_t NAD = 0x01 + i;
+        elapsedSingle += nodeConfig.assignFrameIdRange(NAD, 0, 2 * i, 2 * i + 1, 0xFF, 0xFF).elapsed;
+        NAD = 0x01 + i;
+        elapsedSingle += nodeConfig.saveConfig(NAD).elapsed;
+    }
+    const int framesSingle = bus.mock_frameCount;
+
+    // same services as a single batch
+    LinNodeConfig::Batch batch;
+    batch.reserve(2 * nodeCount);
+    for (uint8_t i = 0; i < nodeCount; ++i) {
+        batch.assignFrameIdRange(0x01 + i, 0, 2 * i, 2 * i + 1, 0xFF, 0xFF)
+             .saveConfig(0x01 + i);
+    }
+
+    bus.mock_frameCount = 0;
+    const auto start = millis();
+    TEST_ASSERT_EQUAL(2 * nodeCount - 2, nodeConfig.execute(batch));
+    const uint32_t elapsedBatch = millis() - start;
+
+    // partial failure is reported per item
+    TEST_ASSERT_EQUAL(2 * nodeCount, batch.size());
+    TEST_ASSERT_EQUAL(2, batch.getFailures());
+    TEST_ASSERT_EQUAL(static_cast<int>(LinNodeConfig::Status::NO_RESPONSE), static_cast<int>(batch[8].result.status));
+    TEST_ASSERT_EQUAL(static_cast<int>(LinNodeConfig::Status::NO_RESPONSE), static_cast<int>(batch[9].result.status));
+    TEST_ASSERT_TRUE(batch[10].result);
+    TEST_ASSERT_EQUAL_HEX8(0x06, batch[10].result.NAD);
+
+    // same bus traffic, but without readback verification of every request
+    TEST_ASSERT_EQUAL(framesSingle, bus.mock_frameCount);
+    TEST_ASSERT_LESS_THAN(elapsedSingle, elapsedBatch);
+    std::cout << "commissioning of " << int(nodeCount) << " nodes: " << elapsedSingle << " ms single, " << elapsedBatch << " ms batch" << std::endl;
+
+    bus.end();
+}
+
 int main() {
     UNITY_BEGIN();
     
@@ -363,6 +554,10 @@ int main() {
     RUN_TEST(test_lin_conditionalChangeNAD_ok);
     RUN_TEST(test_lin_saveConfig_ok);
     RUN_TEST(test_lin_AssignFrameIdRange_ok);
+    RUN_TEST(test_lin_readById_cached);
+    RUN_TEST(test_lin_negativeResponse);
+    RUN_TEST(test_lin_dataDump);
+    RUN_TEST(test_lin_batch_commissioning);
    
     return UNITY_END();
 }
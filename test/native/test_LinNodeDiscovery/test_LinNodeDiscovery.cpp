@@ -0,0 +1,262 @@
+#include <unity.h>
+#include "LinNodeDiscovery.hpp"
+#include "LinNodeConfig.hpp"
+#include "mock_DebugStream.hpp"
+#include "mock_LinBus.h"
+#include "mock_millis.h"
+
+#include <cstdio>
+
+mock_DebugStream debugStream;
+
+mock_LinBus* linBus;
+LinNodeDiscovery* linNodeDiscovery;
+
+void setUp()
+{
+    linBus = new mock_LinBus(0);
+    linBus->mock_verbose = false;
+    linBus->begin(19200, SERIAL_8N1);
+
+    linBus->addNode(0x02, 0x1234, 0x0001, 0x01, 0x76543210);
+    linBus->addNode(0x0A, 0x1234, 0x0002, 0x02, 0x00000001);
+    linBus->addNode(0x7D, 0x4321, 0x0003, 0x03, 0xCAFEBABE);
+    linBus->addNode(0x40, 0x4321, 0x0004, 0x04, 0x00000000).silent = true;
+
+    linNodeDiscovery = new LinNodeDiscovery(*linBus, debugStream, 2);
+}
+
+void tearDown()
+{
+    delete linNodeDiscovery;
+
+    linBus->end();
+    delete linBus;
+}
+
+void test_discovery_fullSweep()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    LinNodeInventory inventory;
+    size_t found = linNodeDiscovery->discover(inventory);
+
+    TEST_ASSERT_EQUAL(3, found);
+    TEST_ASSERT_EQUAL(3, inventory.size());
+
+    const LinNodeInventory::Node* node = inventory.find(0x02);
+    TEST_ASSERT_TRUE(node != nullptr);
+    TEST_ASSERT_EQUAL_HEX16(0x1234, node->supplierId);
+    TEST_ASSERT_EQUAL_HEX16(0x0001, node->functionId);
+    TEST_ASSERT_EQUAL_HEX8(0x01, node->variantId);
+    TEST_ASSERT_TRUE(node->serialNumber.has_value());
+    TEST_ASSERT_EQUAL_HEX32(0x76543210, node->serialNumber.value());
+    TEST_ASSERT_GREATER_THAN(0, node->latency);
+
+    node = inventory.find(0x7D);
+    TEST_ASSERT_TRUE(node != nullptr);
+    TEST_ASSERT_EQUAL_HEX16(0x4321, node->supplierId);
+    TEST_ASSERT_EQUAL_HEX32(0xCAFEBABE, node->serialNumber.value());
+
+    // silent node is not part of the inventory
+    TEST_ASSERT_TRUE(inventory.find(0x40) == nullptr);
+
+    // sorted by NAD
+    TEST_ASSERT_EQUAL_HEX8(0x02, inventory.begin()->NAD);
+    TEST_ASSERT_EQUAL_HEX8(0x7D, (inventory.end() - 1)->NAD);
+
+    // empty NAD: request + two SlaveResponse slots (at once and at the end of the response window)
+    // node: (request + response) for product id and serial number
+    constexpr int emptyNADs = LinNodeDiscovery::NAD_last - 3;
+    TEST_ASSERT_EQUAL(3 * emptyNADs + 4 * 3, linBus->mock_frameCount);
+}
+
+void test_discovery_fasterThanSequentialReadProductId()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    // cluster of fast nodes only: the response window may be shortened below P2_min
+    LinNodeInventory inventory;
+    linNodeDiscovery->responseWindow = LinTimingProfile::timeout_min;
+    auto start = millis();
+    linNodeDiscovery->discover(inventory);
+    auto elapsed_discovery = millis() - start;
+    TEST_ASSERT_EQUAL(3, inventory.size());
+
+    // legacy: readProductId for every NAD, each silent NAD waits for the full timeout
+    LinNodeConfig linNodeConfig(*linBus, debugStream, 2);
+    start = millis();
+    for (uint8_t NAD = LinNodeDiscovery::NAD_first; NAD <= LinNodeDiscovery::NAD_last; ++NAD) {
+        uint8_t nad = NAD;
+        uint16_t supplierId = 0x7FFF;
+        uint16_t functionId = 0x3FFF;
+        uint8_t variantId = 0;
+        linNodeConfig.readProductId(nad, supplierId, functionId, variantId);
+    }
+    auto elapsed_sequential = millis() - start;
+
+    std::cout << "discovery: " << elapsed_discovery << "ms, sequential: " << elapsed_sequential << "ms" << std::endl;
+    TEST_ASSERT_LESS_THAN(elapsed_sequential / 2, elapsed_discovery);
+
+    // settings of the node are restored after the sweep
+    TEST_ASSERT_EQUAL(50, linNodeDiscovery->timingProfile.timeout_default);
+    TEST_ASSERT_EQUAL(0, linNodeDiscovery->timingProfile.pollInterval_default);
+}
+
+void test_discovery_lateNode()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    LinNodeInventory inventory;
+    TEST_ASSERT_EQUAL(3, linNodeDiscovery->discover(inventory));
+
+    // node answers within P2_min, but not in the first SlaveResponse slots: still present
+    linBus->getNodes()[1].responseTime = 30;
+    TEST_ASSERT_TRUE(linNodeDiscovery->probe(inventory, 0x0A));
+    TEST_ASSERT_TRUE(inventory.find(0x0A) != nullptr);
+    TEST_ASSERT_EQUAL(3, inventory.size());
+}
+
+void test_discovery_probe_updatesInventory()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    LinNodeInventory inventory;
+    TEST_ASSERT_EQUAL(3, linNodeDiscovery->discover(inventory));
+
+    // node 0x0A gets a new NAD and vanishes from its old address
+    linBus->getNodes()[1].NAD = 0x0B;
+
+    TEST_ASSERT_FALSE(linNodeDiscovery->probe(inventory, 0x0A));
+    TEST_ASSERT_TRUE(inventory.find(0x0A) == nullptr);
+
+    TEST_ASSERT_TRUE(linNodeDiscovery->probe(inventory, 0x0B));
+    TEST_ASSERT_TRUE(inventory.find(0x0B) != nullptr);
+    TEST_ASSERT_EQUAL_HEX16(0x0002, inventory.find(0x0B)->functionId);
+    TEST_ASSERT_EQUAL(3, inventory.size());
+
+    // partial sweep does only touch its own range
+    linBus->getNodes()[0].silent = true;
+    TEST_ASSERT_EQUAL(1, linNodeDiscovery->discover(inventory, 0x01, 0x10));
+    TEST_ASSERT_TRUE(inventory.find(0x02) == nullptr);
+    TEST_ASSERT_TRUE(inventory.find(0x7D) != nullptr);
+}
+
+void test_inventory_serialize()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    LinNodeInventory inventory;
+    LinNodeInventory::Node node {0x0A, 0x1234, 0x5678, 0x02, 0x76543210, 12};
+    node.PIDs = {0x80, 0xC1, 0xFF, 0xFF};
+    node.validated = true;
+    inventory.update(node);
+    inventory.update({0x03, 0x4321, 0x0001, 0x01, std::nullopt, 3});
+
+    std::vector<uint8_t> blob = inventory.serialize();
+    // header + 2 nodes + CRC
+    TEST_ASSERT_EQUAL(4 + 2 * 17 + 2, blob.size());
+    TEST_ASSERT_EQUAL('L', blob[0]);
+    TEST_ASSERT_EQUAL('N', blob[1]);
+    TEST_ASSERT_EQUAL(LinNodeInventory::blobVersion, blob[2]);
+    TEST_ASSERT_EQUAL(2, blob[3]);
+
+    LinNodeInventory restored;
+    TEST_ASSERT_TRUE(restored.deserialize(blob));
+    TEST_ASSERT_EQUAL(2, restored.size());
+
+    const LinNodeInventory::Node* r = restored.find(0x0A);
+    TEST_ASSERT_TRUE(r != nullptr);
+    TEST_ASSERT_EQUAL_HEX16(0x1234, r->supplierId);
+    TEST_ASSERT_EQUAL_HEX16(0x5678, r->functionId);
+    TEST_ASSERT_EQUAL_HEX8(0x02, r->variantId);
+    TEST_ASSERT_EQUAL_HEX32(0x76543210, r->serialNumber.value());
+    TEST_ASSERT_EQUAL(12, r->latency);
+    TEST_ASSERT_EQUAL_HEX8(0xC1, r->PIDs[1]);
+    TEST_ASSERT_FALSE(r->validated); // has to be confirmed by the bus
+    TEST_ASSERT_FALSE(restored.find(0x03)->serialNumber.has_value());
+
+    // corrupted blob is rejected, inventory is unchanged
+    std::vector<uint8_t> corrupted = blob;
+    corrupted[10] ^= 0x01;
+    TEST_ASSERT_FALSE(restored.deserialize(corrupted));
+    TEST_ASSERT_EQUAL(2, restored.size());
+
+    // unknown version is rejected
+    std::vector<uint8_t> future = blob;
+    future[2] = LinNodeInventory::blobVersion + 1;
+    TEST_ASSERT_FALSE(restored.deserialize(future));
+
+    // truncated blob is rejected
+    TEST_ASSERT_FALSE(restored.deserialize({blob.begin(), blob.end() - 1}));
+}
+
+void test_inventory_warmStart()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    const char* path = "test_LinNodeDiscovery_inventory.bin";
+    LinInventoryFile storage(path);
+
+    // cold start: discovery of the whole cluster
+    {
+        LinNodeInventory inventory;
+        TEST_ASSERT_EQUAL(3, linNodeDiscovery->discover(inventory));
+
+        LinNodeInventory::Node node = *inventory.find(0x0A);
+        node.PIDs = {0x80, 0xC1, 0x42, 0xFF};
+        inventory.update(node);
+
+        TEST_ASSERT_TRUE(inventory.store(storage));
+    }
+
+    // warm start: inventory is available without any bus traffic
+    const int frameCount = linBus->mock_frameCount;
+    LinNodeInventory inventory;
+    TEST_ASSERT_TRUE(inventory.load(storage));
+    TEST_ASSERT_EQUAL(3, inventory.size());
+    TEST_ASSERT_EQUAL(frameCount, linBus->mock_frameCount);
+    TEST_ASSERT_EQUAL_HEX8(0x42, inventory.find(0x0A)->PIDs[2]);
+
+    // first use: single probe (request + response)
+    const LinNodeInventory::Node* node = linNodeDiscovery->validate(inventory, 0x0A);
+    TEST_ASSERT_TRUE(node != nullptr);
+    TEST_ASSERT_TRUE(node->validated);
+    TEST_ASSERT_EQUAL_HEX8(0x42, node->PIDs[2]);
+    TEST_ASSERT_EQUAL(frameCount + 2, linBus->mock_frameCount);
+
+    // validated once: no further bus traffic
+    TEST_ASSERT_TRUE(linNodeDiscovery->validate(inventory, 0x0A) != nullptr);
+    TEST_ASSERT_EQUAL(frameCount + 2, linBus->mock_frameCount);
+
+    // node was replaced by an identical product with another serial number
+    linBus->getNodes()[0].serialNumber = 0x11111111;
+    TEST_ASSERT_TRUE(linNodeDiscovery->validate(inventory, 0x02) == nullptr);
+    TEST_ASSERT_TRUE(inventory.find(0x02) == nullptr);
+
+    // rediscovery of that NAD keeps nothing of the old node
+    TEST_ASSERT_TRUE(linNodeDiscovery->probe(inventory, 0x02));
+    TEST_ASSERT_EQUAL_HEX32(0x11111111, inventory.find(0x02)->serialNumber.value());
+
+    std::remove(path);
+
+    // missing storage: cold start required
+    LinNodeInventory empty;
+    TEST_ASSERT_FALSE(empty.load(storage));
+    TEST_ASSERT_TRUE(empty.empty());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_discovery_fullSweep);
+    RUN_TEST(test_discovery_fasterThanSequentialReadProductId);
+    RUN_TEST(test_discovery_lateNode);
+    RUN_TEST(test_discovery_probe_updatesInventory);
+
+    RUN_TEST(test_inventory_serialize);
+    RUN_TEST(test_inventory_warmStart);
+
+    return UNITY_END();
+}
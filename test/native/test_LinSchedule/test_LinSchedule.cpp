@@ -0,0 +1,107 @@
+#include <unity.h>
+#include "LinSchedule.hpp"
+#include "mock_DebugStream.hpp"
+#include "mock_LinBus.h"
+#include "mock_micros.h"
+
+#include <optional>
+#include <vector>
+
+mock_DebugStream debugStream;
+
+mock_LinBus* linBus;
+LinFrameTransfer* linFrameTransfer;
+
+void setUp()
+{
+    linBus = new mock_LinBus(1);
+    linBus->mock_verbose = false;
+    linBus->begin(19200, SERIAL_8N1);
+    linBus->published[0x10] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+    linBus->published[0x11] = {0x11, 0x12};
+    linBus->published[0x12] = {0x21, 0x22, 0x23, 0x24};
+    debugStream.mock_verbose = false;
+    linFrameTransfer = new LinFrameTransfer(*linBus, debugStream, 1);
+}
+
+void tearDown()
+{
+    delete linFrameTransfer;
+    linBus->end();
+    delete linBus;
+}
+
+void test_schedule_Pipelined()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    LinSchedule schedule(*linFrameTransfer);
+    schedule.add(0x10, 8);
+    schedule.add(0x11, 2);
+    schedule.add(0x12, 4);
+    schedule.add(0x13, 8); // not published: no response
+
+    struct Handled {
+        uint8_t frameID;
+        bool valid;
+        int headersSent;
+    };
+    std::vector<Handled> handled;
+
+    size_t succeeded = schedule.run([&handled](const uint8_t frameID, const std::optional<std::vector<uint8_t>>& data) {
+        handled.push_back({frameID, data.has_value(), linBus->mock_frameCount});
+        if ((0x12 == frameID) && data) {
+            TEST_ASSERT_EQUAL(0x24, data.value()[3]);
+        }
+    }, 2);
+
+    TEST_ASSERT_EQUAL(6, succeeded);
+    TEST_ASSERT_EQUAL(8, schedule.getFrames());
+    TEST_ASSERT_EQUAL(2, schedule.getFailures());
+    TEST_ASSERT_EQUAL(8, handled.size());
+
+    const uint8_t order[] = {0x10, 0x11, 0x12, 0x13};
+    for (size_t i = 0; i < handled.size(); ++i)
+    {
+        TEST_ASSERT_EQUAL(order[i % 4], handled[i].frameID);
+        TEST_ASSERT_EQUAL(0x13 != handled[i].frameID, handled[i].valid);
+        // the header of the next frame was sent before the result was handled
+        TEST_ASSERT_EQUAL(std::min<int>(i + 2, 8), handled[i].headersSent);
+    }
+}
+
+void test_schedule_SlotBoundary()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    LinSchedule schedule(*linFrameTransfer);
+    schedule.add(0x10, 8, 10000);
+    schedule.add(0x11, 2, 5000);
+
+    std::vector<uint32_t> headerTimes;
+    const uint32_t start = mock_micros_value;
+    const uint8_t order[] = {0x10, 0x11};
+    schedule.run([&headerTimes, &order, start](const uint8_t frameID, const std::optional<std::vector<uint8_t>>& data) {
+        TEST_ASSERT_EQUAL(order[headerTimes.size() % 2], frameID);
+        TEST_ASSERT_TRUE(data.has_value());
+        headerTimes.push_back(mock_micros_value - start);
+    }, 2);
+
+    // handler of a frame runs in the slot of the following frame: 0, 10000, 15000, 25000
+    const uint32_t expected[] = {10000, 15000, 25000, 25000};
+    TEST_ASSERT_EQUAL(4, headerTimes.size());
+    for (size_t i = 0; i < headerTimes.size(); ++i)
+    {
+        TEST_ASSERT_EQUAL(expected[i], headerTimes[i]);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_schedule_Pipelined);
+    RUN_TEST(test_schedule_SlotBoundary);
+
+    return UNITY_END();
+}
@@ -0,0 +1,122 @@
+#include <unity.h>
+#include "LinTrace.hpp"
+#include "LinFrameTransfer.hpp"
+#include "mock_DebugStream.hpp"
+#include "mock_LinBus.h"
+#include "mock_micros.h"
+
+#include <string>
+
+mock_DebugStream debugStream;
+
+mock_LinBus* linBus;
+LinFrameTransfer* linFrameTransfer;
+
+// collects the output of dump()
+class mock_StringStream : public mock_DebugStream {
+public:
+    std::string text;
+
+    size_t write(uint8_t c) override {
+        text.push_back(static_cast<char>(c));
+        return 1;
+    }
+};
+
+void setUp()
+{
+    linBus = new mock_LinBus(1);
+    linBus->mock_verbose = false;
+    linBus->begin(19200, SERIAL_8N1);
+    linBus->published[0x10] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+    debugStream.mock_verbose = false;
+    linFrameTransfer = new LinFrameTransfer(*linBus, debugStream, 1);
+}
+
+void tearDown()
+{
+    delete linFrameTransfer;
+    linBus->end();
+    delete linBus;
+}
+
+void test_trace_Histogram()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    LinTrace trace;
+    trace.begin(LinTrace::Track::Frame);
+    delayMicroseconds(1);
+    trace.stage(LinTraceStage::Break);      // 1us
+    delayMicroseconds(100);
+    trace.stage(LinTraceStage::Header);     // 100us
+    trace.begin(LinTrace::Track::Frame);
+    delayMicroseconds(300);
+    trace.stage(LinTraceStage::Header);     // 300us
+
+    const LinTraceHistogram &header = trace.getHistogram(LinTraceStage::Header);
+    TEST_ASSERT_EQUAL(2, header.getCount());
+    TEST_ASSERT_EQUAL(100, header.getMin());
+    TEST_ASSERT_EQUAL(300, header.getMax());
+    TEST_ASSERT_EQUAL(200, header.getMean());
+    TEST_ASSERT_EQUAL(1, header.getBuckets()[6]);   // [64, 128)
+    TEST_ASSERT_EQUAL(1, header.getBuckets()[8]);   // [256, 512)
+    TEST_ASSERT_EQUAL(1, trace.getHistogram(LinTraceStage::Break).getBuckets()[0]);
+    TEST_ASSERT_EQUAL(0, trace.getHistogram(LinTraceStage::Complete).getCount());
+
+    // far above the last bucket
+    LinTraceHistogram histogram;
+    histogram.record(UINT32_MAX);
+    TEST_ASSERT_EQUAL(1, histogram.getBuckets()[LinTraceHistogram::bucketCount - 1]);
+
+    mock_StringStream stream;
+    trace.dump(stream);
+    TEST_ASSERT_EQUAL_STRING(
+        "break n=1 min=1 mean=1 max=1 | 0:1\n"
+        "header n=2 min=100 mean=200 max=300 | 64:1 256:1\n",
+        stream.text.c_str());
+
+    trace.reset();
+    TEST_ASSERT_EQUAL(0, trace.getHistogram(LinTraceStage::Header).getCount());
+}
+
+void test_trace_readFrame()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    linBus->mock_updateBaudRate_us = 100; // reconfiguration of the UART, twice per break
+
+#ifdef LIN_TRACE
+    linFrameTransfer->trace.reset();
+#endif
+
+    auto result = linFrameTransfer->readFrame(0x10, 8);
+    TEST_ASSERT_TRUE(result.has_value());
+
+#ifdef LIN_TRACE
+    TEST_ASSERT_EQUAL(200, linFrameTransfer->trace.getHistogram(LinTraceStage::Break).getMean());
+    for (auto stage : {LinTraceStage::Break, LinTraceStage::Header, LinTraceStage::Flush, LinTraceStage::EchoDone,
+                       LinTraceStage::FirstResponseByte, LinTraceStage::Checksum, LinTraceStage::Complete}) {
+        TEST_ASSERT_EQUAL(1, linFrameTransfer->trace.getHistogram(stage).getCount());
+    }
+    TEST_ASSERT_EQUAL(0, linFrameTransfer->trace.getHistogram(LinTraceStage::PduRequest).getCount());
+
+    // each bus has its own trace
+    LinFrameTransfer otherBus(*linBus, debugStream, 1);
+    TEST_ASSERT_EQUAL(0, otherBus.trace.getHistogram(LinTraceStage::Break).getCount());
+
+    mock_StringStream stream;
+    linFrameTransfer->trace.dump(stream);
+    TEST_ASSERT_EQUAL(0, stream.text.find("break n=1 min=200 mean=200 max=200 | 128:1\n"));
+#endif
+}
+
+int main()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_trace_Histogram);
+    RUN_TEST(test_trace_readFrame);
+
+    return UNITY_END();
+}
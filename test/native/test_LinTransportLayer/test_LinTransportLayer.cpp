@@ -2,6 +2,7 @@
 #include "LinTransportLayer.hpp"
 #include "mock_HardwareSerial.h"
 #include "mock_DebugStream.hpp"
+#include "mock_LinBus.h"
 
 mock_DebugStream debugStream;
 
@@ -389,6 +390,159 @@ void test_write_DTL_MasterRequest_MultiFrame_MultiFrame()
     TEST_ASSERT_EQUAL_MEMORY(expectation.data(), linDriver->txBuffer.data(), expectation.size());
 }
 
+void test_write_DTL_MaxLength()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    // more than 255 consecutive frames in both directions (sequence counters wrap around)
+    mock_LinBus bus(1);
+    bus.mock_verbose = false;
+    bus.begin(19200, SERIAL_8N1);
+    bus.addNode(0x0A, 0x1234, 0x5678, 0x01, 0).onDiagnostic = [](mock_LinNode&, const std::vector<uint8_t>& request) {
+        std::vector<uint8_t> response(request);
+        response[0] += 0x40; // RSID
+        return std::optional<std::vector<uint8_t>>(response);
+    };
+    LinTransportLayer transportLayer(bus, debugStream);
+
+    std::vector<uint8_t> payload(4095);
+    for (size_t i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<uint8_t>(i * 7);
+    }
+    payload[0] = 0x22;
+
+    uint8_t NAD = 0x0A;
+    auto result = transportLayer.writePDU(NAD, payload);
+
+    TEST_ASSERT_TRUE(result.has_value());
+    TEST_ASSERT_EQUAL(payload.size(), result.value().size());
+    TEST_ASSERT_EQUAL(0x62, result.value()[0]);
+    TEST_ASSERT_EQUAL_MEMORY(payload.data() + 1, result.value().data() + 1, payload.size() - 1);
+
+    bus.end();
+}
+
+void test_write_DTL_Functional_MultiNode()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    // nodes respond one after the other (one node per SlaveResponse header)
+    mock_LinBus bus(1);
+    bus.mock_verbose = false;
+    bus.arbitration = mock_LinBus::Arbitration::ORDERED;
+    bus.begin(19200, SERIAL_8N1);
+
+    auto readDID = [](mock_LinNode& node, const std::vector<uint8_t>& request) {
+        // part number: SF for short, FF + CF for long serial numbers
+        std::vector<uint8_t> response {0x62, request[1], request[2]};
+        for (uint32_t i = 0; i < node.serialNumber; ++i) {
+            response.push_back(static_cast<uint8_t>(node.NAD + i));
+        }
+        return std::optional<std::vector<uint8_t>>(response);
+    };
+    bus.addNode(0x0A, 0x1234, 0x5678, 0x01, 2).onDiagnostic = readDID;
+    bus.addNode(0x0B, 0x1234, 0x5678, 0x01, 10).onDiagnostic = readDID;
+    bus.addNode(0x0C, 0x1234, 0x5678, 0x01, 3).onDiagnostic = readDID;
+    bus.addNode(0x0D, 0x1234, 0x5678, 0x01, 3).silent = true;
+
+    LinTransportLayer transportLayer(bus, debugStream);
+
+    auto responses = transportLayer.writePDUFunctional({0x22, 0xF1, 0x90});
+
+    TEST_ASSERT_EQUAL(3, responses.size());
+    TEST_ASSERT_EQUAL(5, responses[0x0A].size());
+    TEST_ASSERT_EQUAL(13, responses[0x0B].size());
+    TEST_ASSERT_EQUAL(6, responses[0x0C].size());
+    TEST_ASSERT_EQUAL(0x62, responses[0x0B][0]);
+    TEST_ASSERT_EQUAL(0x0B + 9, responses[0x0B][12]);
+    TEST_ASSERT_TRUE(responses.find(0x0D) == responses.end());
+
+    // all nodes got the very same request
+    for (auto& node : bus.getNodes()) {
+        TEST_ASSERT_EQUAL(1, node.requestCount);
+    }
+
+    // single request + 1 SF + (FF + 2 CF) + 1 SF + final empty poll
+    TEST_ASSERT_EQUAL(1 + 5 + 1, bus.mock_frameCount);
+
+    // responding nodes are learned by timing profile
+    TEST_ASSERT_EQUAL(1, transportLayer.timingProfile.getEstimate(0x0B).samples);
+
+    // multi frame requests can not be sent functional
+    TEST_ASSERT_EQUAL(0, transportLayer.writePDUFunctional({0x22, 0xF1, 0x90, 0xF1, 0x91, 0xF1, 0x92}).size());
+
+    bus.end();
+}
+
+void test_timingProfile_learnsLatency()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    LinTimingProfile profile;
+    constexpr uint8_t NAD_fast = 0x0A;
+    constexpr uint8_t NAD_slow = 0x0B;
+
+    // unknown nodes use the legacy timeout, without any hold off
+    TEST_ASSERT_EQUAL(profile.timeout_default, profile.getTimeout(NAD_fast));
+    TEST_ASSERT_EQUAL(0, profile.getPollInterval(NAD_fast));
+
+    for (int i = 0; i < 50; ++i) {
+        profile.recordLatency(NAD_fast, 2 + (i % 3)); // 2..4 ms
+        profile.recordLatency(NAD_slow, 180 + (i % 5) * 10); // 180..220 ms
+    }
+
+    // fast node: finish quickly
+    TEST_ASSERT_LESS_THAN(profile.timeout_default, profile.getTimeout(NAD_fast));
+    TEST_ASSERT_GREATER_OR_EQUAL(LinTimingProfile::timeout_min, profile.getTimeout(NAD_fast));
+    TEST_ASSERT_LESS_OR_EQUAL(2, profile.getPollInterval(NAD_fast));
+
+    // slow node: wide timeout, but not beyond spec
+    TEST_ASSERT_GREATER_THAN(220, profile.getTimeout(NAD_slow));
+    TEST_ASSERT_LESS_OR_EQUAL(LinTimingProfile::N_As, profile.getTimeout(NAD_slow));
+    // ... and not polled wastefully
+    TEST_ASSERT_EQUAL(LinTimingProfile::P2_min, profile.getPollInterval(NAD_slow));
+
+    // median is ordered below the 90th percentile
+    auto& estimate = profile.getEstimate(NAD_slow);
+    TEST_ASSERT_LESS_OR_EQUAL(estimate.p90, estimate.p50);
+    TEST_ASSERT_EQUAL(50, estimate.samples);
+
+    // missed responses widen the window
+    auto timeout = profile.getTimeout(NAD_fast);
+    profile.recordTimeout(NAD_fast);
+    TEST_ASSERT_GREATER_THAN(timeout, profile.getTimeout(NAD_fast));
+
+    profile.reset(NAD_fast);
+    TEST_ASSERT_EQUAL(profile.timeout_default, profile.getTimeout(NAD_fast));
+}
+
+void test_write_DTL_recordsLatency()
+{
+    std::cout << "\n\n\nRunning test: " << __FUNCTION__ << std::endl;
+
+    constexpr uint8_t NAD_value = 0x0A;
+    uint8_t NAD = NAD_value;
+    std::vector<uint8_t> payload = {
+        0x22, // SID
+        0x06, 0x2E // real payload
+    };
+
+    linDriver->mock_Input({
+        NAD_value, // NAD
+        0x06, // Single Frame, 6 Bytes
+        0x62, 0x06, 0x2E, 0x80, 0x00, 0x00, // payload
+        0xD8 // Frame Checksum
+    });
+
+    TEST_ASSERT_EQUAL(0, linTransportLayer->timingProfile.getEstimate(NAD_value).samples);
+
+    auto result = linTransportLayer->writePDU(NAD, payload);
+
+    TEST_ASSERT_TRUE(result.has_value());
+    TEST_ASSERT_EQUAL(1, linTransportLayer->timingProfile.getEstimate(NAD_value).samples);
+    TEST_ASSERT_EQUAL(0, linTransportLayer->timingProfile.getEstimate(NAD_value).timeouts);
+}
+
 int main() {
     UNITY_BEGIN();
     
@@ -397,6 +551,11 @@ int main() {
     RUN_TEST(test_write_DTL_MasterRequest_SF_MultiFrame);
     RUN_TEST(test_write_DTL_MasterRequest_MultiFrame_SF);
     RUN_TEST(test_write_DTL_MasterRequest_MultiFrame_MultiFrame);
+    RUN_TEST(test_write_DTL_MaxLength);
+    RUN_TEST(test_write_DTL_Functional_MultiNode);
+
+    RUN_TEST(test_timingProfile_learnsLatency);
+    RUN_TEST(test_write_DTL_recordsLatency);
    
     return UNITY_END();
 }
\ No newline at end of file